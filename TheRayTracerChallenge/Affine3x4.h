@@ -0,0 +1,201 @@
+#pragma once
+
+#include "Tuple.h"
+#include "Matrix.h"
+#include "Constants.h"
+#include <iostream>
+
+//Define RAYTRACER_AFFINE_SSE2 to transform tuples with SSE2 intrinsics (Only with double precision)
+//(Off by default: MeasureAffineTransforms showed no gain over the compiler's scalar code for doubles)
+#if defined(RAYTRACER_AFFINE_SSE2) && defined(RAYTRACER_USE_FLOAT)
+#undef RAYTRACER_AFFINE_SSE2
+#endif
+
+#if defined(RAYTRACER_AFFINE_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace RayTracer {
+	//Affine transform (Rotation, scale, shear and translation) stored as the upper 3 rows of a 4x4 matrix
+	//The last row is always (0, 0, 0, 1), so it is neither stored nor multiplied
+	class Affine3x4 {
+	public:
+		//Aligned, so every half of a row can be loaded into a SIMD register directly
+		alignas(16) Real rows[3][4];
+
+		//Identity
+		Affine3x4();
+		//The last row of the matrix is ignored
+		explicit Affine3x4(Matrix4x4 matrix);
+		~Affine3x4() = default;
+
+		Matrix4x4 ToMatrix() const;
+
+		//Transform a point (w = 1.0) or a vector (w = 0.0), w stays the same
+		Tuple operator*(const Tuple& tuple) const;
+		//Multiply with the transpose of the 3x3 part (Transforms normals back to world space when used on the inverse)
+		Vector TransformNormal(const Vector& normal) const;
+
+		Affine3x4 operator*(const Affine3x4& other) const;
+
+		//Closed form inverse: inverse of the 3x3 part (adjugate / determinant) and the negated, transformed translation
+		Affine3x4 Inversion() const;
+		//Transpose of the 3x3 part without translation (operator* on the result is the same as TransformNormal)
+		Affine3x4 TransposedLinearPart() const;
+
+		bool operator==(const Affine3x4& other) const;
+	};
+
+
+	inline Affine3x4::Affine3x4() {
+		for (size_t row = 0; row < 3; row++) {
+			for (size_t column = 0; column < 4; column++) {
+				rows[row][column] = (row == column) ? 1.0 : 0.0;
+			}
+		}
+	}
+
+	inline Affine3x4::Affine3x4(Matrix4x4 matrix) {
+		for (size_t row = 0; row < 3; row++) {
+			for (size_t column = 0; column < 4; column++) {
+				rows[row][column] = matrix.elements[row][column];
+			}
+		}
+	}
+
+	inline Matrix4x4 Affine3x4::ToMatrix() const {
+		Matrix4x4 matrix;
+
+		for (size_t row = 0; row < 3; row++) {
+			for (size_t column = 0; column < 4; column++) {
+				matrix.elements[row][column] = rows[row][column];
+			}
+		}
+		matrix.elements[3][3] = 1.0;
+
+		return matrix;
+	}
+
+	inline Tuple Affine3x4::operator*(const Tuple& tuple) const {
+		Tuple result;
+
+#if defined(RAYTRACER_AFFINE_SSE2)
+		//Registers are filled from the components (Loading the whole tuple at once stalls when it was just written)
+		__m128d xy = _mm_set_pd(tuple.y, tuple.x);
+		__m128d zw = _mm_set_pd(tuple.w, tuple.z);
+
+		__m128d sumX = _mm_add_pd(_mm_mul_pd(_mm_load_pd(rows[0]), xy), _mm_mul_pd(_mm_load_pd(rows[0] + 2), zw));
+		__m128d sumY = _mm_add_pd(_mm_mul_pd(_mm_load_pd(rows[1]), xy), _mm_mul_pd(_mm_load_pd(rows[1] + 2), zw));
+		__m128d sumZ = _mm_add_pd(_mm_mul_pd(_mm_load_pd(rows[2]), xy), _mm_mul_pd(_mm_load_pd(rows[2] + 2), zw));
+
+		result.x = _mm_cvtsd_f64(_mm_add_sd(sumX, _mm_unpackhi_pd(sumX, sumX)));
+		result.y = _mm_cvtsd_f64(_mm_add_sd(sumY, _mm_unpackhi_pd(sumY, sumY)));
+		result.z = _mm_cvtsd_f64(_mm_add_sd(sumZ, _mm_unpackhi_pd(sumZ, sumZ)));
+		result.w = tuple.w;
+#else
+		result.x = rows[0][0] * tuple.x + rows[0][1] * tuple.y + rows[0][2] * tuple.z + rows[0][3] * tuple.w;
+		result.y = rows[1][0] * tuple.x + rows[1][1] * tuple.y + rows[1][2] * tuple.z + rows[1][3] * tuple.w;
+		result.z = rows[2][0] * tuple.x + rows[2][1] * tuple.y + rows[2][2] * tuple.z + rows[2][3] * tuple.w;
+		result.w = tuple.w;
+#endif
+
+		return result;
+	}
+
+	inline Vector Affine3x4::TransformNormal(const Vector& normal) const {
+		Vector result;
+
+		result.x = rows[0][0] * normal.x + rows[1][0] * normal.y + rows[2][0] * normal.z;
+		result.y = rows[0][1] * normal.x + rows[1][1] * normal.y + rows[2][1] * normal.z;
+		result.z = rows[0][2] * normal.x + rows[1][2] * normal.y + rows[2][2] * normal.z;
+		result.w = 0.0;
+
+		return result;
+	}
+
+	inline Affine3x4 Affine3x4::operator*(const Affine3x4& other) const {
+		Affine3x4 result;
+
+		for (size_t row = 0; row < 3; row++) {
+			for (size_t column = 0; column < 4; column++) {
+				result.rows[row][column] =
+					rows[row][0] * other.rows[0][column]
+					+ rows[row][1] * other.rows[1][column]
+					+ rows[row][2] * other.rows[2][column];
+			}
+
+			//Translation of this transform (The implicit last row of the other one is (0, 0, 0, 1))
+			result.rows[row][3] += rows[row][3];
+		}
+
+		return result;
+	}
+
+	inline Affine3x4 Affine3x4::Inversion() const {
+		const Real(&m)[3][4] = rows;
+
+		//Cofactors of the 3x3 part
+		Real c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+		Real c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+		Real c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+
+		Real determinant = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+
+		Affine3x4 inversion;
+
+		//Same behaviour as Matrix4x4::Inversion
+		if (Constants::DoubleEqual(determinant, 0.0)) {
+			std::cerr << "Matrix not invertible\n";
+
+			for (auto& row : inversion.rows) {
+				for (auto& element : row) element = 0.0;
+			}
+			return inversion;
+		}
+
+		Real inverseDeterminant = 1.0 / determinant;
+
+		//Transposed cofactors (adjugate) divided by the determinant
+		inversion.rows[0][0] = c00 * inverseDeterminant;
+		inversion.rows[1][0] = c01 * inverseDeterminant;
+		inversion.rows[2][0] = c02 * inverseDeterminant;
+
+		inversion.rows[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inverseDeterminant;
+		inversion.rows[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inverseDeterminant;
+		inversion.rows[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inverseDeterminant;
+
+		inversion.rows[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inverseDeterminant;
+		inversion.rows[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inverseDeterminant;
+		inversion.rows[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inverseDeterminant;
+
+		//The translation is undone after the inverse 3x3 part was applied
+		for (size_t row = 0; row < 3; row++) {
+			inversion.rows[row][3] = -(inversion.rows[row][0] * m[0][3] + inversion.rows[row][1] * m[1][3] + inversion.rows[row][2] * m[2][3]);
+		}
+
+		return inversion;
+	}
+
+	inline Affine3x4 Affine3x4::TransposedLinearPart() const {
+		Affine3x4 result;
+
+		for (size_t row = 0; row < 3; row++) {
+			for (size_t column = 0; column < 3; column++) {
+				result.rows[row][column] = rows[column][row];
+			}
+			result.rows[row][3] = 0.0;
+		}
+
+		return result;
+	}
+
+	inline bool Affine3x4::operator==(const Affine3x4& other) const {
+		for (size_t row = 0; row < 3; row++) {
+			for (size_t column = 0; column < 4; column++) {
+				if (!Constants::DoubleEqual(rows[row][column], other.rows[row][column])) return false;
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Constants.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace RayTracer {
+	//Settings used to build a bounding volume hierarchy (BVH) with the surface area heuristic (SAH)
+	struct BVHBuildSettings {
+		//Number of candidate split positions per axis (+1)
+		size_t binCount = 12;
+		//Nodes with at most this many primitives may become leaves
+		size_t maximumLeafSize = 4;
+		//Nodes at this depth always become leaves (Keeps the traversal stack of compiled hierarchies bounded)
+		size_t maximumDepth = 64;
+
+		//Relative costs of visiting a node and of intersecting a primitive
+		Real traversalCost = 1.0;
+		Real intersectionCost = 1.0;
+
+		//Number of primitives that are intersected at once (e.g. TriangleBlocks::Width), testing a partial block costs as much as a full one
+		size_t primitiveBlockSize = 1;
+
+		//Number of intersection tests needed for primitiveCount primitives
+		Real GetIntersectionCount(size_t primitiveCount) const {
+			size_t blockSize = std::max<size_t>(primitiveBlockSize, 1);
+			return static_cast<Real>((primitiveCount + blockSize - 1) / blockSize);
+		}
+	};
+}
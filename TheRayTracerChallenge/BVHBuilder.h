@@ -0,0 +1,356 @@
+#pragma once
+
+#include "BoundingBox.h"
+#include "BVHBuildSettings.h"
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cmath>
+#include <limits>
+
+namespace RayTracer {
+	//Describes the shape and quality of a bounding volume hierarchy
+	struct BVHStatistics {
+		//Number of levels (A single leaf has depth 1)
+		size_t depth = 0;
+		size_t interiorNodeCount = 0;
+		size_t leafCount = 0;
+		size_t primitiveCount = 0;
+
+		//leafSizeHistogram[n] = Number of leaves that contain n primitives
+		std::vector<size_t> leafSizeHistogram;
+
+		//Expected cost of intersecting a random ray that hits the root's bounding box (lower is better)
+		Real sahCost = 0.0;
+
+		//relativeArea: Surface area of the node divided by the surface area of the root
+		void AddInteriorNode(Real relativeArea, size_t nodeDepth, const BVHBuildSettings& settings);
+		void AddLeaf(size_t leafPrimitiveCount, Real relativeArea, size_t nodeDepth, const BVHBuildSettings& settings);
+
+		std::string ToString() const;
+
+		//Area of a node relative to the root (Handles empty and unbounded boxes)
+		static Real RelativeArea(const BoundingBox& node, const BoundingBox& root);
+	};
+
+	//Builds a binary hierarchy over a set of bounding boxes using the binned surface area heuristic
+	//Every primitive is assigned to exactly one side of a split (based on the center of its bounding box),
+	//so primitives that straddle a split position don't have to stay in the parent node
+	class BVHBuilder {
+	public:
+		struct Node {
+			BoundingBox bounds;
+
+			//Interior nodes: indices of the child nodes
+			size_t leftChild = 0, rightChild = 0;
+
+			//Leaves: primitives are GetPrimitiveOrder()[firstPrimitive ... firstPrimitive + primitiveCount - 1]
+			size_t firstPrimitive = 0, primitiveCount = 0;
+
+			bool IsLeaf() const { return primitiveCount != 0; }
+		};
+
+		BVHBuilder(BVHBuildSettings buildSettings = BVHBuildSettings());
+		~BVHBuilder() = default;
+
+		//Build the hierarchy (One bounding box per primitive)
+		void Build(const std::vector<BoundingBox>& primitiveBounds);
+
+		//Nodes of the hierarchy, the root is the first node (Empty if there were no primitives)
+		const std::vector<Node>& GetNodes() const { return nodes; }
+
+		//Indices of the primitives, sorted so every leaf references a contiguous range
+		const std::vector<size_t>& GetPrimitiveOrder() const { return primitiveOrder; }
+
+		BVHStatistics GetStatistics() const;
+
+		const BVHBuildSettings& GetSettings() const { return settings; }
+
+	private:
+		BVHBuildSettings settings;
+
+		std::vector<Node> nodes;
+		std::vector<size_t> primitiveOrder;
+
+		//Data used while building
+		std::vector<BoundingBox> bounds;
+		std::vector<Point> centers;
+
+		struct Bin {
+			BoundingBox bounds;
+			size_t count = 0;
+		};
+
+		//Build the subtree for the primitives in primitiveOrder[begin, end), returns the node's index
+		size_t BuildNode(size_t begin, size_t end, size_t depth);
+
+		size_t CreateLeaf(const BoundingBox& nodeBounds, size_t begin, size_t end);
+
+		static Real GetAxis(const Point& p, size_t axis);
+		size_t FindBin(Real center, Real minimum, Real extent) const;
+
+		void CollectStatistics(BVHStatistics& statistics, size_t nodeIndex, size_t depth) const;
+	};
+
+
+	inline void BVHStatistics::AddInteriorNode(Real relativeArea, size_t nodeDepth, const BVHBuildSettings& settings) {
+		interiorNodeCount++;
+		depth = std::max(depth, nodeDepth);
+		sahCost += settings.traversalCost * relativeArea;
+	}
+
+	inline void BVHStatistics::AddLeaf(size_t leafPrimitiveCount, Real relativeArea, size_t nodeDepth, const BVHBuildSettings& settings) {
+		leafCount++;
+		primitiveCount += leafPrimitiveCount;
+		depth = std::max(depth, nodeDepth);
+		sahCost += settings.intersectionCost * settings.GetIntersectionCount(leafPrimitiveCount) * relativeArea;
+
+		if (leafSizeHistogram.size() <= leafPrimitiveCount) {
+			leafSizeHistogram.resize(leafPrimitiveCount + 1, 0);
+		}
+		leafSizeHistogram[leafPrimitiveCount]++;
+	}
+
+	inline std::string BVHStatistics::ToString() const {
+		std::string str;
+
+		str += "Depth: " + std::to_string(depth) + "\n";
+		str += "Interior nodes: " + std::to_string(interiorNodeCount) + "\n";
+		str += "Leaves: " + std::to_string(leafCount) + "\n";
+		str += "Primitives: " + std::to_string(primitiveCount) + "\n";
+		str += "SAH cost: " + std::to_string(sahCost) + "\n";
+		str += "Leaf sizes:\n";
+
+		for (size_t size = 0; size < leafSizeHistogram.size(); size++) {
+			if (leafSizeHistogram[size] != 0) {
+				str += "  " + std::to_string(size) + ": " + std::to_string(leafSizeHistogram[size]) + "\n";
+			}
+		}
+
+		return str;
+	}
+
+	inline Real BVHStatistics::RelativeArea(const BoundingBox& node, const BoundingBox& root) {
+		Real nodeArea = node.SurfaceArea();
+		Real rootArea = root.SurfaceArea();
+
+		//Unbounded boxes (e.g. planes) are treated as if they were as large as the root
+		if (!std::isfinite(nodeArea) || !std::isfinite(rootArea) || rootArea <= 0.0) {
+			return 1.0;
+		}
+
+		return nodeArea / rootArea;
+	}
+
+
+	inline BVHBuilder::BVHBuilder(BVHBuildSettings buildSettings) : settings{ buildSettings } {
+		//At least one split position and one primitive per leaf are needed
+		settings.binCount = std::max<size_t>(settings.binCount, 2);
+		settings.maximumLeafSize = std::max<size_t>(settings.maximumLeafSize, 1);
+		settings.maximumDepth = std::max<size_t>(settings.maximumDepth, 1);
+	}
+
+	inline void BVHBuilder::Build(const std::vector<BoundingBox>& primitiveBounds) {
+		nodes.clear();
+		primitiveOrder.clear();
+
+		bounds = primitiveBounds;
+		centers.clear();
+		centers.reserve(bounds.size());
+
+		for (auto& box : bounds) {
+			Point center = box.GetCenter();
+
+			//Unbounded primitives have no meaningful center
+			if (!std::isfinite(center.x)) center.x = 0.0;
+			if (!std::isfinite(center.y)) center.y = 0.0;
+			if (!std::isfinite(center.z)) center.z = 0.0;
+
+			centers.push_back(center);
+		}
+
+		primitiveOrder.reserve(bounds.size());
+		for (size_t index = 0; index < bounds.size(); index++) {
+			primitiveOrder.push_back(index);
+		}
+
+		if (!bounds.empty()) {
+			//A binary tree with n leaves has 2n - 1 nodes
+			nodes.reserve(2 * bounds.size());
+			BuildNode(0, bounds.size(), 1);
+		}
+
+		//The temporary data is no longer needed
+		bounds = std::vector<BoundingBox>();
+		centers = std::vector<Point>();
+	}
+
+	inline Real BVHBuilder::GetAxis(const Point& p, size_t axis) {
+		switch (axis) {
+		case 0: return p.x;
+		case 1: return p.y;
+		default: return p.z;
+		}
+	}
+
+	inline size_t BVHBuilder::FindBin(Real center, Real minimum, Real extent) const {
+		size_t bin = static_cast<size_t>(static_cast<Real>(settings.binCount) * ((center - minimum) / extent));
+
+		//Centers on the maximum of the box would end up in a bin that doesn't exist
+		return std::min(bin, settings.binCount - 1);
+	}
+
+	inline size_t BVHBuilder::CreateLeaf(const BoundingBox& nodeBounds, size_t begin, size_t end) {
+		Node leaf;
+		leaf.bounds = nodeBounds;
+		leaf.firstPrimitive = begin;
+		leaf.primitiveCount = end - begin;
+
+		nodes.push_back(leaf);
+		return nodes.size() - 1;
+	}
+
+	inline size_t BVHBuilder::BuildNode(size_t begin, size_t end, size_t depth) {
+		size_t count = end - begin;
+
+		//Bounds of all primitives and of their centers
+		BoundingBox nodeBounds, centerBounds;
+		for (size_t index = begin; index < end; index++) {
+			nodeBounds.Add(bounds[primitiveOrder[index]]);
+			centerBounds.Add(centers[primitiveOrder[index]]);
+		}
+
+		if (count == 1 || depth >= settings.maximumDepth) {
+			return CreateLeaf(nodeBounds, begin, end);
+		}
+
+		//Find the best split over all axes
+		size_t binCount = settings.binCount;
+		Real bestCost = std::numeric_limits<Real>::infinity();
+		size_t bestAxis = 0, bestSplit = 0;
+
+		std::vector<Bin> bins(binCount);
+		std::vector<Real> rightAreas(binCount);
+		std::vector<size_t> rightCounts(binCount);
+
+		for (size_t axis = 0; axis < 3; axis++) {
+			Real minimum = GetAxis(centerBounds.GetMin(), axis);
+			Real extent = GetAxis(centerBounds.GetMax(), axis) - minimum;
+
+			//All centers lie on the same plane
+			if (extent <= 0.0) continue;
+
+			//Sort the primitives into bins
+			std::fill(bins.begin(), bins.end(), Bin());
+			for (size_t index = begin; index < end; index++) {
+				size_t primitive = primitiveOrder[index];
+				Bin& bin = bins[FindBin(GetAxis(centers[primitive], axis), minimum, extent)];
+				bin.count++;
+				bin.bounds.Add(bounds[primitive]);
+			}
+
+			//Sweep from the right to find the area and count for every split position
+			BoundingBox rightBounds;
+			size_t rightCount = 0;
+			for (size_t split = binCount - 1; split > 0; split--) {
+				rightBounds.Add(bins[split].bounds);
+				rightCount += bins[split].count;
+				rightAreas[split] = rightBounds.SurfaceArea();
+				rightCounts[split] = rightCount;
+			}
+
+			//Sweep from the left and evaluate the cost of splitting in front of each bin
+			BoundingBox leftBounds;
+			size_t leftCount = 0;
+			for (size_t split = 1; split < binCount; split++) {
+				leftBounds.Add(bins[split - 1].bounds);
+				leftCount += bins[split - 1].count;
+
+				if (leftCount == 0 || rightCounts[split] == 0) continue;
+
+				//Cost relative to the node's area (Dividing by it doesn't change which split is best)
+				Real cost = settings.GetIntersectionCount(leftCount) * leftBounds.SurfaceArea()
+					+ settings.GetIntersectionCount(rightCounts[split]) * rightAreas[split];
+
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+
+		Real nodeArea = nodeBounds.SurfaceArea();
+		bool splitFound = bestSplit != 0;
+		bool costIsFinite = std::isfinite(bestCost) && std::isfinite(nodeArea) && nodeArea > 0.0;
+
+		if (splitFound && costIsFinite) {
+			Real splitCost = settings.traversalCost + settings.intersectionCost * bestCost / nodeArea;
+			Real leafCost = settings.intersectionCost * settings.GetIntersectionCount(count);
+
+			//Splitting doesn't pay off
+			if (count <= settings.maximumLeafSize && leafCost <= splitCost) {
+				return CreateLeaf(nodeBounds, begin, end);
+			}
+		}
+		else if (count <= settings.maximumLeafSize) {
+			return CreateLeaf(nodeBounds, begin, end);
+		}
+
+		size_t middle;
+
+		if (splitFound) {
+			//Move the primitives left of the split position to the front
+			Real minimum = GetAxis(centerBounds.GetMin(), bestAxis);
+			Real extent = GetAxis(centerBounds.GetMax(), bestAxis) - minimum;
+
+			auto first = primitiveOrder.begin() + begin;
+			auto last = primitiveOrder.begin() + end;
+			middle = begin + (std::partition(first, last, [&](size_t primitive) {
+				return FindBin(GetAxis(centers[primitive], bestAxis), minimum, extent) < bestSplit;
+			}) - first);
+		}
+		else {
+			//Every center is at the same position: Split into two halves, so large leaves are avoided
+			middle = begin + count / 2;
+		}
+
+		//Reserve the node before building the children, so the root stays at index 0
+		nodes.push_back(Node());
+		size_t nodeIndex = nodes.size() - 1;
+
+		//The left child always directly follows its parent (Depth first order)
+		size_t leftChild = BuildNode(begin, middle, depth + 1);
+		size_t rightChild = BuildNode(middle, end, depth + 1);
+
+		nodes[nodeIndex].bounds = nodeBounds;
+		nodes[nodeIndex].leftChild = leftChild;
+		nodes[nodeIndex].rightChild = rightChild;
+
+		return nodeIndex;
+	}
+
+	inline BVHStatistics BVHBuilder::GetStatistics() const {
+		BVHStatistics statistics;
+
+		if (!nodes.empty()) {
+			CollectStatistics(statistics, 0, 1);
+		}
+
+		return statistics;
+	}
+
+	inline void BVHBuilder::CollectStatistics(BVHStatistics& statistics, size_t nodeIndex, size_t depth) const {
+		const Node& node = nodes[nodeIndex];
+		Real relativeArea = BVHStatistics::RelativeArea(node.bounds, nodes[0].bounds);
+
+		if (node.IsLeaf()) {
+			statistics.AddLeaf(node.primitiveCount, relativeArea, depth, settings);
+		}
+		else {
+			statistics.AddInteriorNode(relativeArea, depth, settings);
+			CollectStatistics(statistics, node.leftChild, depth + 1);
+			CollectStatistics(statistics, node.rightChild, depth + 1);
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Tuple.h"
+#include "Vector3.h"
 #include <limits>
 #include "Ray.h"
 
@@ -10,45 +11,60 @@ namespace RayTracer {
 	public:
 		BoundingBox();
 		BoundingBox(Point minPoint, Point maxPoint);
+		BoundingBox(const Point3& minPoint, const Point3& maxPoint) : min{ minPoint }, max{ maxPoint } {}
 		~BoundingBox() = default;
 
-		Point GetMax() const { return max; }
-		Point GetMin() const { return min; }
+		Point GetMax() const { return max.ToTuple(); }
+		Point GetMin() const { return min.ToTuple(); }
+		//Corners without conversion to tuples
+		const Point3& GetMaximum() const { return max; }
+		const Point3& GetMinimum() const { return min; }
 
-		void SetMax(Point newMax) { max = newMax; }
-		void SetMin(Point newMin) { min = newMin; }
+		void SetMax(Point newMax) { max = Point3(newMax); }
+		void SetMin(Point newMin) { min = Point3(newMin); }
 
-		void Add(Point point);
+		void Add(Point point) { Add(Point3(point)); }
+		void Add(const Point3& point);
 		void Add(const BoundingBox box);
 
-		bool Contains(const Point p);
+		bool Contains(const Point p) { return Contains(Point3(p)); }
+		bool Contains(const Point3& p);
 		bool Contains(const BoundingBox box);
 
-		BoundingBox ApplyTransform(Transform transform);
+		BoundingBox ApplyTransform(const Transform& transform);
 
 		bool CheckIntersection(Ray ray);
+		//Only hits with minimumT <= t <= maximumT are considered
+		bool CheckIntersection(Ray ray, Real minimumT, Real maximumT);
 
 		std::pair<BoundingBox, BoundingBox> SplitBox();
 
+		//Surface area of the box (0.0 for empty boxes)
+		Real SurfaceArea() const;
+		Point GetCenter() const;
+		//Does the box contain at least one point?
+		bool IsEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
 	private:
-		Point min, max;
+		//Points without w, so boxes in large hierarchies take less memory
+		Point3 min, max;
 
 
-		std::pair<double, double> CheckAxis(double origin, double direction, double min, double max);
+		std::pair<Real, Real> CheckAxis(Real origin, Real direction, Real min, Real max);
 	};
 
 	inline BoundingBox::BoundingBox() {
-		constexpr double infinity = std::numeric_limits<double>::infinity();
-		min = Point::CreatePoint(infinity, infinity, infinity);
-		max = Point::CreatePoint(-infinity, -infinity, -infinity);
+		constexpr Real infinity = std::numeric_limits<Real>::infinity();
+		min = Point3(infinity, infinity, infinity);
+		max = Point3(-infinity, -infinity, -infinity);
 	}
 
 	inline BoundingBox::BoundingBox(Point minPoint, Point maxPoint) {
-		max = maxPoint;
-		min = minPoint;
+		max = Point3(maxPoint);
+		min = Point3(minPoint);
 	}
 
-	inline void BoundingBox::Add(Point point) {
+	inline void BoundingBox::Add(const Point3& point) {
 		if (min.x > point.x) min.x = point.x;
 		if (min.y > point.y) min.y = point.y;
 		if (min.z > point.z) min.z = point.z;
@@ -59,11 +75,14 @@ namespace RayTracer {
 	}
 
 	inline void BoundingBox::Add(const BoundingBox box) {
-		Add(box.GetMin());
-		Add(box.GetMax());
+		//Empty boxes would otherwise extend the box to infinity
+		if (box.IsEmpty()) return;
+
+		Add(box.min);
+		Add(box.max);
 	}
 
-	inline bool BoundingBox::Contains(const Point p) {
+	inline bool BoundingBox::Contains(const Point3& p) {
 		return
 			min.x <= p.x && max.x >= p.x &&
 			min.y <= p.y && max.y >= p.y &&
@@ -73,21 +92,27 @@ namespace RayTracer {
 
 	inline bool BoundingBox::Contains(const BoundingBox box) {
 		return
-			Contains(box.GetMin())
-			&& Contains(box.GetMax());
+			Contains(box.min)
+			&& Contains(box.max);
 	}
 
-	inline BoundingBox BoundingBox::ApplyTransform(Transform transform) {
+	inline BoundingBox BoundingBox::ApplyTransform(const Transform& transform) {
+		//Infinite corners would turn into NaN (inf * 0.0) -> treat the transformed box as unbounded
+		if (!IsEmpty() && !std::isfinite(SurfaceArea())) {
+			constexpr auto infinity = std::numeric_limits<Real>::infinity();
+			return BoundingBox(Point::CreatePoint(-infinity, -infinity, -infinity), Point::CreatePoint(infinity, infinity, infinity));
+		}
+
 		//All 8 corners of the bounding box
 		std::array<Point, 8> corners = {
-			min,
+			min.ToTuple(),
 			Point::CreatePoint(min.x, min.y, max.z),
 			Point::CreatePoint(min.x, max.y, min.z),
 			Point::CreatePoint(min.x, max.y, max.z),
 			Point::CreatePoint(max.x, min.y, min.z),
 			Point::CreatePoint(max.x, min.y, max.z),
 			Point::CreatePoint(max.x, max.y, min.z),
-			max
+			max.ToTuple()
 		};
 
 		BoundingBox result;
@@ -103,13 +128,24 @@ namespace RayTracer {
 		return result;
 	}
 
+	inline bool BoundingBox::CheckIntersection(Ray ray, Real minimumT, Real maximumT) {
+		auto xValues = CheckAxis(ray.origin.x, ray.direction.x, min.x, max.x);
+		auto yValues = CheckAxis(ray.origin.y, ray.direction.y, min.y, max.y);
+		auto zValues = CheckAxis(ray.origin.z, ray.direction.z, min.z, max.z);
+
+		minimumT = fmax(minimumT, fmax(xValues.first, fmax(yValues.first, zValues.first)));
+		maximumT = fmin(maximumT, fmin(xValues.second, fmin(yValues.second, zValues.second)));
+
+		return minimumT <= maximumT;
+	}
+
 	inline bool BoundingBox::CheckIntersection(Ray ray) {
 		auto xValues = CheckAxis(ray.origin.x, ray.direction.x, min.x, max.x);
 		auto yValues = CheckAxis(ray.origin.y, ray.direction.y, min.y, max.y);
 		auto zValues = CheckAxis(ray.origin.z, ray.direction.z, min.z, max.z);
 
-		double minimumT = fmax(xValues.first, fmax(yValues.first, zValues.first));
-		double maximumT = fmin(xValues.second, fmin(yValues.second, zValues.second));
+		Real minimumT = fmax(xValues.first, fmax(yValues.first, zValues.first));
+		Real maximumT = fmin(xValues.second, fmin(yValues.second, zValues.second));
 
 		if (minimumT > maximumT) {
 			//There was no intersection with the bounding boy
@@ -122,27 +158,50 @@ namespace RayTracer {
 
 
 
-	inline std::pair<double, double> BoundingBox::CheckAxis(double origin, double direction, double min, double max) {
+	inline std::pair<Real, Real> BoundingBox::CheckAxis(Real origin, Real direction, Real min, Real max) {
 		//Division by 0.0 will result in +/- infinity, which is handled correctly by the comparisons
-		double tMin = (min - origin) / direction;
-		double tMax = (max - origin) / direction;
+		Real tMin = (min - origin) / direction;
+		Real tMax = (max - origin) / direction;
 
 		//Always return the smaller t value as pair.first 
 		if (tMin > tMax) {
-			return std::pair<double, double>(tMax, tMin);
+			return std::pair<Real, Real>(tMax, tMin);
 		}
-		return std::pair<double, double>(tMin, tMax);
+		return std::pair<Real, Real>(tMin, tMax);
+	}
+
+	inline Real BoundingBox::SurfaceArea() const {
+		if (IsEmpty()) return 0.0;
+
+		Real dx = max.x - min.x;
+		Real dy = max.y - min.y;
+		Real dz = max.z - min.z;
+
+		//Unbounded in at least one direction (Avoids inf * 0.0 for flat, infinite boxes)
+		if (std::isinf(dx) || std::isinf(dy) || std::isinf(dz)) {
+			return std::numeric_limits<Real>::infinity();
+		}
+
+		return 2.0 * (dx * dy + dx * dz + dy * dz);
+	}
+
+	inline Point BoundingBox::GetCenter() const {
+		return Point::CreatePoint(
+			(min.x + max.x) / 2.0,
+			(min.y + max.y) / 2.0,
+			(min.z + max.z) / 2.0
+		);
 	}
 
 	inline std::pair<BoundingBox, BoundingBox> BoundingBox::SplitBox() {
 		//Lengths of the cube's sides
-		double dx = max.x - min.x;
-		double dy = max.y - min.y;
-		double dz = max.z - min.z;
+		Real dx = max.x - min.x;
+		Real dy = max.y - min.y;
+		Real dz = max.z - min.z;
 
 
-		Point middleMax = max;
-		Point middleMin = min;
+		Point3 middleMax = max;
+		Point3 middleMin = min;
 
 
 		//Split the cube's longest side in half (Determine the shared points)
@@ -11,20 +11,41 @@ namespace RayTracer {
 		~CSGShape() = default;
 
 		void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) override;
+		void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer, RenderContext& context) override;
+		bool FindObjectSpaceAnyHit(Ray ray, Real maximumT, RenderContext& context) override;
+		bool FindObjectSpaceClosestHit(Ray ray, Intersection& closestHit, RenderContext& context) override;
 
 		Vector FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) override;
 
 		void PartitionChildren(size_t maximumShapeCount) override {}
 
+		void BuildAccelerationStructure(const BVHBuildSettings& settings = BVHBuildSettings()) override {
+			if (left) left->BuildAccelerationStructure(settings);
+			if (right) right->BuildAccelerationStructure(settings);
+		}
+
+		void UpdateWorldTransform() override {
+			Shape::UpdateWorldTransform();
+			if (left) left->UpdateWorldTransform();
+			if (right) right->UpdateWorldTransform();
+		}
+		void InvalidateWorldTransform() override {
+			Shape::InvalidateWorldTransform();
+			if (left) left->InvalidateWorldTransform();
+			if (right) right->InvalidateWorldTransform();
+		}
+
 		BoundingBox GetObjectSpaceBounds() override;
 
 		void SetLeft(std::shared_ptr<Shape> leftShape) {
 			left = leftShape; left->SetParent(GetPointer());
 			RecalculateBoundingBox();
+			InvalidateAccelerationStructure();
 		}
 		void SetRight(std::shared_ptr<Shape> rightShape) {
 			right = rightShape; right->SetParent(GetPointer());
 			RecalculateBoundingBox();
+			InvalidateAccelerationStructure();
 		}
 
 		const std::shared_ptr<Shape> GetLeft() { return left; }
@@ -37,7 +58,7 @@ namespace RayTracer {
 
 		void FilterIntersections(IntersectionBuffer& in, IntersectionBuffer& out);
 
-		bool ContainsShape(std::shared_ptr<Shape> shape) override {
+		bool ContainsShape(const Shape* shape) override {
 			if (left->ContainsShape(shape) || right->ContainsShape(shape)) return true;
 			return false;
 		}
@@ -45,7 +66,6 @@ namespace RayTracer {
 		std::shared_ptr<Shape> left, right;
 		Operation operation;
 		BoundingBox bounds;
-		IntersectionBuffer reusedIntersectionBuffer;
 
 		void RecalculateBoundingBox() {
 			bounds = BoundingBox();
@@ -122,19 +142,41 @@ namespace RayTracer {
 	}
 
 	inline void CSGShape::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) {
-		reusedIntersectionBuffer.Reset();
+		RenderContext context;
+		FindObjectSpaceIntersections(ray, buffer, context);
+	}
 
+	inline void CSGShape::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer, RenderContext& context) {
 		//Ray misses all subshapes
 		if (!bounds.CheckIntersection(ray)) return;
 
+		//Temporary buffer owned by the context (the same shape can be intersected by multiple threads at once)
+		IntersectionBuffer& childIntersections = context.AcquireBuffer();
+
 		//Find all intersections
-		right->FindIntersections(ray, reusedIntersectionBuffer);
-		left->FindIntersections(ray, reusedIntersectionBuffer);
+		right->FindIntersections(ray, childIntersections, context);
+		left->FindIntersections(ray, childIntersections, context);
 
-		reusedIntersectionBuffer.Sort();
+		childIntersections.Sort();
+
+		FilterIntersections(childIntersections, buffer);
+
+		context.ReleaseBuffer();
+
+	}
+
+	inline bool CSGShape::FindObjectSpaceAnyHit(Ray ray, Real maximumT, RenderContext& context) {
+		//Bounds are not hit in front of maximumT
+		if (!bounds.CheckIntersection(ray, 0.0, maximumT)) return false;
+
+		//Which hits are kept depends on all hits of both children -> the filtered list is needed
+		return Shape::FindObjectSpaceAnyHit(ray, maximumT, context);
+	}
 
-		FilterIntersections(reusedIntersectionBuffer, buffer);
+	inline bool CSGShape::FindObjectSpaceClosestHit(Ray ray, Intersection& closestHit, RenderContext& context) {
+		if (!bounds.CheckIntersection(ray, 0.0, closestHit.t)) return false;
 
+		return Shape::FindObjectSpaceClosestHit(ray, closestHit, context);
 	}
 
 	inline Vector CSGShape::FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) {
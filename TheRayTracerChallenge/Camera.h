@@ -6,40 +6,105 @@
 #include "Constants.h"
 #include <cmath>
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "Canvas.h"
 #include "World.h"
+#include "RayPacket.h"
+#include "CameraRayGenerator.h"
+#include "ThreadPool.h"
+#include "CancellationToken.h"
+#include "RenderProgress.h"
+#include "MortonOrder.h"
 
 namespace RayTracer {
 
+	//Adaptive supersampling: every pixel starts with two batches of initialSamples jittered samples. While the estimated error of its mean
+	//color is above the threshold, more batches are added until maximumSamples is reached
+	//maximumSamples <= 1 turns antialiasing off (One ray through the center of every pixel)
+	struct AntialiasingSettings {
+		//Traced together as one packet (At most RayPacket::Size)
+		size_t initialSamples = 4;
+		size_t maximumSamples = 1;
+		//Largest accepted standard error of the mean in any color channel (Colors are clamped to [0, 1] first, like in the saved image)
+		Real threshold = 0.01;
+
+		bool IsEnabled() const { return maximumSamples > 1; }
+	};
+
+	//Pixels traced in one pass of a progressive render: every xStep-th pixel (starting at xOffset) of every yStep-th row (starting at yOffset)
+	//Each traced pixel also fills the fillWidth x fillHeight block to its right and below, until later passes trace those pixels
+	struct ProgressivePass {
+		size_t xOffset, yOffset;
+		size_t xStep, yStep;
+		size_t fillWidth, fillHeight;
+	};
+
 	//Camera used to render a frame
 	class Camera {
 	private:
 		size_t xSize, ySize;
-		double fieldOfView;
+		Real fieldOfView;
 		Transform transform;
 
-		double halfHeight, halfWidth, pixelSize;
+		Real halfHeight, halfWidth, pixelSize;
+
+		//Edge length of the tiles used for multithreaded rendering (in pixels)
+		size_t tileSize;
+
+		//Trace primary rays in packets of RayPacket::Width x RayPacket::Width pixels (Same image as single rays)
+		bool usePacketTracing;
+
+		//Render tiles and the packets / pixels inside of them in Z-order instead of row by row
+		bool useMortonOrder;
+
+		AntialiasingSettings antialiasing;
+		//Of the last rendered frame
+		Real averageSamplesPerPixel;
+
+		//Receives the progress of every render (Empty -> no reporter thread is started)
+		RenderProgressCallback progressCallback;
+		std::chrono::milliseconds progressInterval;
 
 	public:
 
 		Camera() {
 			halfHeight = halfWidth = pixelSize = 0.0f;
+			tileSize = 16;
+			usePacketTracing = true;
+			useMortonOrder = true;
+			averageSamplesPerPixel = 0.0;
+			progressInterval = std::chrono::milliseconds(500);
 			xSize = ySize = 100;
 			fieldOfView = Constants::PI / 2.0f;
 			CalculatePixelSize();
 		}
 
-		Camera(size_t initialXSize, size_t initialYSize, double initialFieldOfView, Transform initialTransform) {
+		Camera(size_t initialXSize, size_t initialYSize, Real initialFieldOfView, Transform initialTransform) {
 			halfHeight = halfWidth = pixelSize = 0.0f;
+			tileSize = 16;
+			usePacketTracing = true;
+			useMortonOrder = true;
+			averageSamplesPerPixel = 0.0;
+			progressInterval = std::chrono::milliseconds(500);
 			xSize = initialXSize;
 			ySize = initialYSize;
 			fieldOfView = initialFieldOfView;
-			transform = initialTransform;
+			SetTransform(initialTransform);
 			CalculatePixelSize();
 		}
 
-		Camera(size_t initialXSize, size_t initialYSize, double initialFieldOfView) {
+		Camera(size_t initialXSize, size_t initialYSize, Real initialFieldOfView) {
 			halfHeight = halfWidth = pixelSize = 0.0f;
+			tileSize = 16;
+			usePacketTracing = true;
+			useMortonOrder = true;
+			averageSamplesPerPixel = 0.0;
+			progressInterval = std::chrono::milliseconds(500);
 			xSize = initialXSize;
 			ySize = initialYSize;
 			fieldOfView = initialFieldOfView;
@@ -51,46 +116,231 @@ namespace RayTracer {
 
 		size_t GetYSize() { return ySize; }
 
-		double GetFieldOfView() { return fieldOfView; }
+		Real GetFieldOfView() { return fieldOfView; }
 
 		Transform GetTransform() { return transform; }
-		void SetTransform(Transform newTransform) { transform = newTransform; }
+		void SetTransform(Transform newTransform) {
+			transform = newTransform;
+			//Cache the inverse before any rendering threads read it
+			transform.Inversion();
+		}
 
-		double GetPixelSize() { return pixelSize; }
+		Real GetPixelSize() { return pixelSize; }
 
+		size_t GetTileSize() { return tileSize; }
+		void SetTileSize(size_t newTileSize) { tileSize = (newTileSize == 0) ? 1 : newTileSize; }
 
-		Ray CreateRayForPixel(size_t xPixel, size_t yPixel) {
-			//Offset from edge of canvas to the pixel's center
-			double xOffset = (static_cast<double>(xPixel) + 0.5) * pixelSize;
-			double yOffset = (static_cast<double>(yPixel) + 0.5) * pixelSize;
+		bool GetUsePacketTracing() { return usePacketTracing; }
+		void SetUsePacketTracing(bool usePackets) { usePacketTracing = usePackets; }
+
+		bool GetUseMortonOrder() { return useMortonOrder; }
+		void SetUseMortonOrder(bool useMorton) { useMortonOrder = useMorton; }
+
+		AntialiasingSettings GetAntialiasing() { return antialiasing; }
+		void SetAntialiasing(AntialiasingSettings settings) { antialiasing = settings; }
+
+		//Samples per pixel of the last frame (1.0 without antialiasing)
+		Real GetAverageSamplesPerPixel() { return averageSamplesPerPixel; }
+
+		//The callback is called from a separate thread every interval while a frame is rendered and once more when it is done
+		//Pass ProgressReporter::PrintToConsole to print the progress, or an empty callback to turn reporting off (Default)
+		void SetProgressCallback(RenderProgressCallback callback, std::chrono::milliseconds interval = std::chrono::milliseconds(500)) {
+			progressCallback = std::move(callback);
+			progressInterval = interval;
+		}
 
-			//Untransformed coordinates of the pixel
-			double worldX = halfWidth - xOffset;
-			double worldY = halfHeight - yOffset;
+		//Receives the image after every finished pass of a progressive render (passIndex + 1 == passCount for the final image)
+		using PassCallback = std::function<void(const Canvas& image, size_t passIndex, size_t passCount)>;
+
+		//Passes of a progressive render, interleaved like Adam7 (PNG): a grid of every 8th pixel first, then every pass halves the gaps in one direction
+		//Every pixel is traced in exactly one pass
+		static const std::array<ProgressivePass, 7>& GetProgressivePasses() {
+			static const std::array<ProgressivePass, 7> passes = { {
+				{ 0, 0, 8, 8, 8, 8 },
+				{ 4, 0, 8, 8, 4, 8 },
+				{ 0, 4, 4, 8, 4, 4 },
+				{ 2, 0, 4, 4, 2, 4 },
+				{ 0, 2, 2, 4, 2, 2 },
+				{ 1, 0, 2, 2, 1, 2 },
+				{ 0, 1, 1, 2, 1, 1 }
+			} };
+
+			return passes;
+		}
 
-			//Transform the the point (-> view transform)
-			//(Untransformed canvas is at z =-1) 
-			Point pixel = transform.Inversion() * Point::CreatePoint(worldX, worldY, -1.0f);
-			Point origin = transform.Inversion() * Point::CreatePoint(0.0f, 0.0f, 0.0f);
-			Vector direction = (pixel - origin).Normalize();
 
-			return Ray(origin, direction);
+		//Precompute everything the primary rays of a frame share (Needs to be created again after the camera was changed)
+		CameraRayGenerator CreateRayGenerator() {
+			return CameraRayGenerator(transform.GetInverseAffine(), halfWidth, halfHeight, pixelSize, xSize, ySize);
+		}
+
+		//Single rays (Rendering uses one generator for the whole frame instead)
+		Ray CreateRayForPixel(size_t xPixel, size_t yPixel) {
+			return CreateRayGenerator().CreateRay(xPixel, yPixel);
+		}
+
+		//Rays of the pixels in a RayPacket::Width x RayPacket::Width block starting at (xStart, yStart), lane = x + y * RayPacket::Width
+		//Pixels at or after xEnd / yEnd (or outside of the image) are left empty. The rays are the same as the ones of CreateRayForPixel
+		void CreateRayPacket(size_t xStart, size_t yStart, size_t xEnd, size_t yEnd, RayPacket& packet) {
+			CreateRayGenerator().CreatePacket(xStart, yStart, xEnd, yEnd, packet);
 		}
 
 		//Render a frame using the current settings
-		Canvas RenderFrame(World & world) {
+		//Once the token is cancelled no more tiles are started, the returned image is black where they would have been
+		Canvas RenderFrame(World & world, const CancellationToken* cancellation = nullptr) {
 			Canvas image(xSize, ySize);
+			RenderContext context;
+
+			world.PrepareFrame();
+			CameraRayGenerator rayGenerator = CreateRayGenerator();
+
+			//Same tiles and order as a multithreaded render, or columns in strips that are as wide as a packet
+			size_t xTiles = (xSize + tileSize - 1) / tileSize;
+			std::vector<size_t> tileOrder;
+			if (useMortonOrder) tileOrder = CreateTileOrder();
+
+			size_t stripWidth = usePacketTracing ? RayPacket::Width : 1;
+			size_t taskCount = useMortonOrder ? tileOrder.size() : (xSize + stripWidth - 1) / stripWidth;
 
-			for (size_t x = 0; x < xSize; x++) {
-				for (size_t y = 0; y < ySize; y++) {
-					Ray currentRay = CreateRayForPixel(x, y);
-					Color pixelColor = world.FindRayColor(currentRay);
-					image.WritePixel(pixelColor, x, y);
+			RenderProgress progress(taskCount);
+			std::unique_ptr<ProgressReporter> reporter = StartProgressReporter(progress);
+
+			for (size_t index = 0; index < taskCount; index++) {
+				if (cancellation != nullptr && cancellation->IsCancelled()) break;
+
+				unsigned long long raysCast = context.GetStatistics().raysCast;
+
+				if (useMortonOrder) {
+					RenderTile(world, image, context, rayGenerator, tileOrder[index] % xTiles, tileOrder[index] / xTiles);
 				}
+				else {
+					RenderBlock(world, image, context, rayGenerator, index * stripWidth, 0, std::min((index + 1) * stripWidth, xSize), ySize);
+				}
+
+				progress.AddTile(context.GetStatistics().raysCast - raysCast);
+			}
+
+			if (reporter) reporter->Stop();
+
+			world.AddStatistics(context.GetStatistics());
+			averageSamplesPerPixel = static_cast<Real>(context.GetStatistics().pixelSamples) / static_cast<Real>(xSize * ySize);
+
+			return image;
+		}
+
+		//Render a frame on multiple threads (threadCount = 0 -> one thread per hardware thread)
+		//The image is split into tiles, every pixel is written by exactly one thread
+		//Cancelling the token works like for RenderFrame, the threads finish the tiles they are working on
+		Canvas RenderFrameMultithreaded(World& world, size_t threadCount = 0, const CancellationToken* cancellation = nullptr) {
+			Canvas image(xSize, ySize);
+
+			size_t xTiles = (xSize + tileSize - 1) / tileSize;
+
+			ThreadPool threadPool(threadCount);
+
+			//Acceleration structures are built before any thread starts tracing
+			world.PrepareFrame();
+			const CameraRayGenerator rayGenerator = CreateRayGenerator();
+
+			//Every thread traces rays with its own context
+			std::vector<RenderContext> contexts(threadPool.GetThreadCount());
+			for (size_t index = 0; index < contexts.size(); index++) {
+				contexts[index].SetSeed(index + 1);
+			}
+
+			//Every thread starts with a contiguous part of the order, which is a compact region of the image in Z-order
+			std::vector<size_t> tileOrder = CreateTileOrder();
+
+			//Threads only touch the shared counters once per tile
+			RenderProgress progress(tileOrder.size());
+			std::unique_ptr<ProgressReporter> reporter = StartProgressReporter(progress);
+
+			threadPool.ParallelFor(tileOrder.size(), [&](size_t index, size_t threadIndex) {
+				if (cancellation != nullptr && cancellation->IsCancelled()) return;
+
+				RenderContext& context = contexts[threadIndex];
+				unsigned long long raysCast = context.GetStatistics().raysCast;
+
+				RenderTile(world, image, context, rayGenerator, tileOrder[index] % xTiles, tileOrder[index] / xTiles);
+
+				progress.AddTile(context.GetStatistics().raysCast - raysCast);
+			});
+
+			if (reporter) reporter->Stop();
+
+			unsigned long long pixelSamples = 0;
+
+			for (auto& context : contexts) {
+				world.AddStatistics(context.GetStatistics());
+				pixelSamples += context.GetStatistics().pixelSamples;
+			}
+
+			averageSamplesPerPixel = static_cast<Real>(pixelSamples) / static_cast<Real>(xSize * ySize);
+
+			return image;
+		}
+
+		//Render a frame in passes of increasing resolution, so a coarse preview is available after a fraction of the work (threadCount = 0 -> one thread per hardware thread)
+		//onPass is called on the calling thread between the passes. The image after the last pass is the same as the one of RenderFrame
+		//Once the token is cancelled the threads stop after their current row and the image so far is returned (The current pass is not reported)
+		Canvas RenderFrameProgressive(World& world, const PassCallback& onPass, const CancellationToken* cancellation = nullptr, size_t threadCount = 0) {
+			Canvas image(xSize, ySize);
+
+			ThreadPool threadPool(threadCount);
+
+			world.PrepareFrame();
+			const CameraRayGenerator rayGenerator = CreateRayGenerator();
+
+			std::vector<RenderContext> contexts(threadPool.GetThreadCount());
+			for (size_t index = 0; index < contexts.size(); index++) {
+				contexts[index].SetSeed(index + 1);
+			}
+
+			//Per thread, so the samples per pixel of a cancelled frame only count the pixels that were traced
+			std::vector<unsigned long long> tracedPixels(contexts.size(), 0);
+
+			const auto& passes = GetProgressivePasses();
+
+			auto countRows = [&](const ProgressivePass& pass) { return (pass.yOffset < ySize) ? (ySize - pass.yOffset + pass.yStep - 1) / pass.yStep : 0; };
+
+			//The rows of all passes are reported as tiles
+			size_t totalRows = 0;
+			for (const ProgressivePass& pass : passes) totalRows += countRows(pass);
+
+			RenderProgress progress(totalRows);
+			std::unique_ptr<ProgressReporter> reporter = StartProgressReporter(progress);
+
+			for (size_t passIndex = 0; passIndex < passes.size(); passIndex++) {
+				const ProgressivePass& pass = passes[passIndex];
+
+				threadPool.ParallelFor(countRows(pass), [&](size_t rowIndex, size_t threadIndex) {
+					if (cancellation != nullptr && cancellation->IsCancelled()) return;
+
+					RenderContext& context = contexts[threadIndex];
+					unsigned long long raysCast = context.GetStatistics().raysCast;
+
+					tracedPixels[threadIndex] += RenderPassRow(world, image, context, rayGenerator, pass, pass.yOffset + rowIndex * pass.yStep);
+
+					progress.AddTile(context.GetStatistics().raysCast - raysCast);
+				});
+
+				if (cancellation != nullptr && cancellation->IsCancelled()) break;
+
+				if (onPass) onPass(image, passIndex, passes.size());
+			}
+
+			if (reporter) reporter->Stop();
 
-				std::cout << std::to_string(static_cast<double>(x) / static_cast<double>(xSize) * 100.0f) + "%\n";
+			unsigned long long pixelSamples = 0, pixels = 0;
+
+			for (size_t index = 0; index < contexts.size(); index++) {
+				world.AddStatistics(contexts[index].GetStatistics());
+				pixelSamples += contexts[index].GetStatistics().pixelSamples;
+				pixels += tracedPixels[index];
 			}
 
+			averageSamplesPerPixel = (pixels == 0) ? 0.0 : static_cast<Real>(pixelSamples) / static_cast<Real>(pixels);
+
 			return image;
 		}
 
@@ -115,10 +365,221 @@ namespace RayTracer {
 
 	private:
 
+		//Reporter thread for the progress of a frame (nullptr if no callback was set)
+		std::unique_ptr<ProgressReporter> StartProgressReporter(const RenderProgress& progress) {
+			if (!progressCallback) return nullptr;
+
+			return std::make_unique<ProgressReporter>(progress, progressCallback, progressInterval);
+		}
+
+		//Indices (x + y * xTiles) of all tiles in the order they are rendered
+		std::vector<size_t> CreateTileOrder() {
+			size_t xTiles = (xSize + tileSize - 1) / tileSize;
+			size_t yTiles = (ySize + tileSize - 1) / tileSize;
+
+			std::vector<size_t> tileOrder;
+			tileOrder.reserve(xTiles * yTiles);
+
+			if (useMortonOrder) {
+				MortonOrder::ForEachCell(xTiles, yTiles, [&](size_t xTile, size_t yTile) { tileOrder.push_back(xTile + yTile * xTiles); });
+			}
+			else {
+				for (size_t index = 0; index < xTiles * yTiles; index++) tileOrder.push_back(index);
+			}
+
+			return tileOrder;
+		}
+
+		//Visit the cells of a width x height grid in the camera's order
+		template<typename Visitor>
+		void ForEachCell(size_t width, size_t height, Visitor&& visit) {
+			if (useMortonOrder) {
+				MortonOrder::ForEachCell(width, height, visit);
+				return;
+			}
+
+			for (size_t y = 0; y < height; y++) {
+				for (size_t x = 0; x < width; x++) {
+					visit(x, y);
+				}
+			}
+		}
+
+		//Render all pixels of a single tile
+		void RenderTile(World& world, Canvas& image, RenderContext& context, const CameraRayGenerator& rayGenerator, size_t xTile, size_t yTile) {
+			size_t xStart = xTile * tileSize;
+			size_t yStart = yTile * tileSize;
+			size_t xEnd = std::min(xStart + tileSize, xSize);
+			size_t yEnd = std::min(yStart + tileSize, ySize);
+
+			RenderBlock(world, image, context, rayGenerator, xStart, yStart, xEnd, yEnd);
+		}
+
+		//Render the pixels in [xStart, xEnd) x [yStart, yEnd)
+		void RenderBlock(World& world, Canvas& image, RenderContext& context, const CameraRayGenerator& rayGenerator, size_t xStart, size_t yStart, size_t xEnd, size_t yEnd) {
+			if (antialiasing.IsEnabled()) {
+				ForEachCell(xEnd - xStart, yEnd - yStart, [&](size_t x, size_t y) {
+					image.WritePixel(RenderAntialiasedPixel(world, context, rayGenerator, xStart + x, yStart + y), xStart + x, yStart + y);
+				});
+				return;
+			}
+
+			context.GetStatistics().pixelSamples += (xEnd - xStart) * (yEnd - yStart);
+
+			if (!usePacketTracing) {
+				ForEachCell(xEnd - xStart, yEnd - yStart, [&](size_t x, size_t y) {
+					Ray currentRay = rayGenerator.CreateRay(xStart + x, yStart + y);
+					image.WritePixel(world.FindRayColor(currentRay, context), xStart + x, yStart + y);
+				});
+				return;
+			}
+
+			RayPacket packet;
+			Color colors[RayPacket::Size];
+
+			size_t xPackets = (xEnd - xStart + RayPacket::Width - 1) / RayPacket::Width;
+			size_t yPackets = (yEnd - yStart + RayPacket::Width - 1) / RayPacket::Width;
+
+			ForEachCell(xPackets, yPackets, [&](size_t xPacket, size_t yPacket) {
+				size_t x = xStart + xPacket * RayPacket::Width;
+				size_t y = yStart + yPacket * RayPacket::Width;
+
+				rayGenerator.CreatePacket(x, y, xEnd, yEnd, packet);
+				world.FindRayColors(packet, colors, context);
+
+				//Lanes are in row-major order, so the pixels are written in runs along the canvas' rows
+				for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+					if (!RayPacket::IsActive(packet.activeLanes, lane)) continue;
+
+					image.WritePixel(colors[lane], x + lane % RayPacket::Width, y + lane / RayPacket::Width);
+				}
+			});
+		}
+
+		//Trace the pixels of a pass in row y and fill their blocks, returns the number of traced pixels
+		size_t RenderPassRow(World& world, Canvas& image, RenderContext& context, const CameraRayGenerator& rayGenerator, const ProgressivePass& pass, size_t y) {
+			if (pass.xOffset >= xSize) return 0;
+
+			size_t pixelCount = (xSize - pass.xOffset + pass.xStep - 1) / pass.xStep;
+			size_t fillHeight = std::min(pass.fillHeight, ySize - y);
+
+			auto fillBlock = [&](const Color& color, size_t x) {
+				size_t fillWidth = std::min(pass.fillWidth, xSize - x);
+
+				for (size_t yFill = y; yFill < y + fillHeight; yFill++) {
+					for (size_t xFill = x; xFill < x + fillWidth; xFill++) {
+						image.WritePixel(color, xFill, yFill);
+					}
+				}
+			};
+
+			if (antialiasing.IsEnabled()) {
+				for (size_t x = pass.xOffset; x < xSize; x += pass.xStep) {
+					fillBlock(RenderAntialiasedPixel(world, context, rayGenerator, x, y), x);
+				}
+				return pixelCount;
+			}
+
+			context.GetStatistics().pixelSamples += pixelCount;
+
+			if (!usePacketTracing) {
+				for (size_t x = pass.xOffset; x < xSize; x += pass.xStep) {
+					fillBlock(world.FindRayColor(rayGenerator.CreateRay(x, y), context), x);
+				}
+				return pixelCount;
+			}
+
+			//The pixels of a pass are spread out, so a packet holds a run of a row instead of a square block (Still the same colors as single rays)
+			RayPacket packet;
+			Color colors[RayPacket::Size];
+
+			for (size_t first = 0; first < pixelCount; first += RayPacket::Size) {
+				size_t count = std::min(RayPacket::Size, pixelCount - first);
+
+				packet.Clear();
+				for (size_t lane = 0; lane < count; lane++) {
+					packet.SetRay(lane, rayGenerator.CreateRay(pass.xOffset + (first + lane) * pass.xStep, y));
+				}
+
+				world.FindRayColors(packet, colors, context);
+
+				for (size_t lane = 0; lane < count; lane++) {
+					fillBlock(colors[lane], pass.xOffset + (first + lane) * pass.xStep);
+				}
+			}
+
+			return pixelCount;
+		}
+
+		//Mean color of the adaptive samples of a pixel
+		Color RenderAntialiasedPixel(World& world, RenderContext& context, const CameraRayGenerator& rayGenerator, size_t x, size_t y) {
+			size_t batchSize = std::min(std::max(antialiasing.initialSamples, static_cast<size_t>(1)), RayPacket::Size);
+			size_t maximumSamples = std::max(antialiasing.maximumSamples, batchSize);
+			Real maximumVariance = antialiasing.threshold * antialiasing.threshold;
+
+			RayPacket packet;
+			Color colors[RayPacket::Size];
+
+			Color sum(0.0, 0.0, 0.0);
+			//Sums of the clamped channels and their squares
+			Real channelSums[3] = {}, channelSquares[3] = {};
+			size_t samples = 0;
+
+			while (samples < maximumSamples) {
+				size_t count = std::min(batchSize, maximumSamples - samples);
+
+				packet.Clear();
+				for (size_t lane = 0; lane < count; lane++) {
+					Real xOffset, yOffset;
+					CameraRayGenerator::GetSampleOffset(samples + lane, xOffset, yOffset);
+					packet.SetRay(lane, rayGenerator.CreateRay(x, y, xOffset, yOffset));
+				}
+
+				//The samples of a pixel are as coherent as rays get
+				if (usePacketTracing) {
+					world.FindRayColors(packet, colors, context);
+				}
+				else {
+					for (size_t lane = 0; lane < count; lane++) {
+						colors[lane] = world.FindRayColor(packet.rays[lane], context);
+					}
+				}
+
+				for (size_t lane = 0; lane < count; lane++) {
+					sum = sum + colors[lane];
+
+					Real channels[3] = { colors[lane].r, colors[lane].g, colors[lane].b };
+					for (size_t channel = 0; channel < 3; channel++) {
+						Real value = std::min(std::max(channels[channel], static_cast<Real>(0.0)), static_cast<Real>(1.0));
+						channelSums[channel] += value;
+						channelSquares[channel] += value * value;
+					}
+				}
+
+				samples += count;
+
+				//The first batch alone never ends a pixel: all of its samples can land on the same side of an edge and look converged
+				if (samples <= batchSize) continue;
+
+				//Variance of the mean: sample variance / samples
+				bool converged = true;
+				Real n = static_cast<Real>(samples);
+				for (size_t channel = 0; channel < 3; channel++) {
+					Real variance = (channelSquares[channel] - channelSums[channel] * channelSums[channel] / n) / (n - 1.0);
+					if (variance / n > maximumVariance) converged = false;
+				}
+
+				if (converged) break;
+			}
+
+			context.GetStatistics().pixelSamples += samples;
+			return sum * (1.0 / static_cast<Real>(samples));
+		}
+
 		//Calculate the size of a pixel on the image plane in 'world' units
 		void CalculatePixelSize() {
-			double halfView = tan(fieldOfView / 2.0);
-			double aspectRatio = static_cast<double>(xSize) / static_cast<double>(ySize);
+			Real halfView = tan(fieldOfView / 2.0);
+			Real aspectRatio = static_cast<Real>(xSize) / static_cast<Real>(ySize);
 
 			if (aspectRatio >= 1.0) {
 				halfWidth = halfView;
@@ -129,7 +590,7 @@ namespace RayTracer {
 				halfHeight = halfView;
 			}
 
-			pixelSize = (halfWidth * 2.0) / static_cast<double>(xSize);
+			pixelSize = (halfWidth * 2.0) / static_cast<Real>(xSize);
 		}
 	};
 
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Constants.h"
+#include "Tuple.h"
+#include "Vector3.h"
+#include "Affine3x4.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+
+namespace RayTracer {
+	//Creates the primary rays of a camera for one frame
+	//The view transform is only applied once: positions on the canvas are the top left corner plus multiples of the step from one pixel to the next
+	class CameraRayGenerator {
+	public:
+		CameraRayGenerator() = default;
+		//inverseView: inverse of the camera's view transform, halfWidth / halfHeight: half the size of the canvas at z = -1
+		CameraRayGenerator(const Affine3x4& inverseView, Real halfWidth, Real halfHeight, Real pixelSize, size_t xSize, size_t ySize);
+
+		//Ray through the center of a pixel
+		Ray CreateRay(size_t xPixel, size_t yPixel) const { return CreateRay(xPixel, yPixel, 0.5, 0.5); }
+		//Ray through a point inside of a pixel (Offsets in pixels from its top left corner, 0.5 / 0.5 is the center), used to jitter samples
+		Ray CreateRay(size_t xPixel, size_t yPixel, Real xOffset, Real yOffset) const;
+
+		//Rays through the centers of a RayPacket::Width x RayPacket::Width block of pixels starting at (xStart, yStart)
+		//Pixels at or after xEnd / yEnd (or outside of the image) are left empty. Each lane gets the same ray as CreateRay
+		void CreatePacket(size_t xStart, size_t yStart, size_t xEnd, size_t yEnd, RayPacket& packet) const;
+
+		//Offsets of the antialiasing samples of a pixel (R2 sequence: Any number of consecutive samples covers the pixel evenly)
+		static void GetSampleOffset(size_t sample, Real& xOffset, Real& yOffset);
+
+		const Point3& GetOrigin() const { return origin; }
+		const Vec3& GetXStep() const { return xStep; }
+		const Vec3& GetYStep() const { return yStep; }
+
+	private:
+		Point3 origin;
+		//Top left corner of the canvas and the distance between two pixels in both directions (In world space)
+		Point3 corner;
+		Vec3 xStep, yStep;
+
+		size_t xSize = 0, ySize = 0;
+
+		Vec3 FindDirection(Real x, Real y) const;
+	};
+
+
+	inline CameraRayGenerator::CameraRayGenerator(const Affine3x4& inverseView, Real halfWidth, Real halfHeight, Real pixelSize, size_t xSize, size_t ySize)
+		: xSize{ xSize }, ySize{ ySize } {
+		//The canvas is at z = -1, x grows to the left and y grows upwards before the view transform
+		origin = Point3(inverseView * Point::CreatePoint(0.0, 0.0, 0.0));
+		corner = Point3(inverseView * Point::CreatePoint(halfWidth, halfHeight, -1.0));
+		xStep = Vec3(inverseView * Vector::CreateVector(-pixelSize, 0.0, 0.0));
+		yStep = Vec3(inverseView * Vector::CreateVector(0.0, -pixelSize, 0.0));
+	}
+
+	inline Ray CameraRayGenerator::CreateRay(size_t xPixel, size_t yPixel, Real xOffset, Real yOffset) const {
+		Vec3 direction = FindDirection(static_cast<Real>(xPixel) + xOffset, static_cast<Real>(yPixel) + yOffset);
+		return Ray(origin.ToTuple(), direction.ToTuple());
+	}
+
+	inline void CameraRayGenerator::CreatePacket(size_t xStart, size_t yStart, size_t xEnd, size_t yEnd, RayPacket& packet) const {
+		xEnd = std::min(xEnd, xSize);
+		yEnd = std::min(yEnd, ySize);
+		packet.Clear();
+
+		for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+			size_t x = xStart + lane % RayPacket::Width;
+			size_t y = yStart + lane / RayPacket::Width;
+
+			if (x >= xEnd || y >= yEnd) continue;
+
+			packet.SetRay(lane, CreateRay(x, y));
+		}
+	}
+
+	inline void CameraRayGenerator::GetSampleOffset(size_t sample, Real& xOffset, Real& yOffset) {
+		//Inverse of the plastic number and its square
+		constexpr double a1 = 0.7548776662466927;
+		constexpr double a2 = 0.5698402909980532;
+
+		double x = 0.5 + a1 * static_cast<double>(sample);
+		double y = 0.5 + a2 * static_cast<double>(sample);
+
+		xOffset = static_cast<Real>(x - std::floor(x));
+		yOffset = static_cast<Real>(y - std::floor(y));
+	}
+
+	inline Vec3 CameraRayGenerator::FindDirection(Real x, Real y) const {
+		Point3 pixel = corner + xStep * x + yStep * y;
+		return (pixel - origin).Normalize();
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atomic>
+
+namespace RayTracer {
+	//Lets one thread ask a running render to stop (e.g. a preview that is outdated because the scene changed)
+	//Render threads check it before every tile (Column strip in RenderFrame without Z-order, row of a pass in RenderFrameProgressive)
+	//Work that was already started is finished, so cancelling takes effect after at most one tile per thread
+	class CancellationToken {
+	public:
+		void Cancel() { cancelled.store(true, std::memory_order_relaxed); }
+		bool IsCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+		//Allow the token to be used for another render
+		void Reset() { cancelled.store(false, std::memory_order_relaxed); }
+
+	private:
+		std::atomic<bool> cancelled{ false };
+	};
+}
@@ -17,12 +17,12 @@ RayTracer::Canvas::Canvas(size_t xSize, size_t ySize)
     }
 }
 
-size_t RayTracer::Canvas::GetHeight()
+size_t RayTracer::Canvas::GetHeight() const
 {
     return canvasSizeY;
 }
 
-size_t RayTracer::Canvas::GetWidth()
+size_t RayTracer::Canvas::GetWidth() const
 {
     return canvasSizeX;
 }
@@ -55,7 +55,7 @@ std::string RayTracer::Canvas::ConvertToPPM(unsigned int maxValue, size_t maxLin
             Color currentPixel = ReadPixel(row, line);
 
             //Format the color intensities as required
-            for (double colorValue : {currentPixel.r, currentPixel.g, currentPixel.b}) {
+            for (Real colorValue : {currentPixel.r, currentPixel.g, currentPixel.b}) {
                 //Limit the color's intensity
                 if (colorValue > 1.0) colorValue = 1.0;
                 if (colorValue < 0.0) colorValue = 0.0;
@@ -16,10 +16,10 @@ namespace RayTracer {
 		~Canvas() = default;
 
 		void WritePixel(Color color, size_t xPosition, size_t yPosition);
-		Color ReadPixel(size_t xPosition, size_t yPosition);
+		Color ReadPixel(size_t xPosition, size_t yPosition) const;
 
-		size_t GetHeight();
-		size_t GetWidth();
+		size_t GetHeight() const;
+		size_t GetWidth() const;
 
 		std::string ConvertToPPM(unsigned int maxValue = 255, size_t maxLineLength = 70);
 
@@ -38,7 +38,7 @@ namespace RayTracer {
 		frameBuffer[xPosition + yPosition * canvasSizeX] = color;
 	}
 
-	inline Color Canvas::ReadPixel(size_t xPosition, size_t yPosition) {
+	inline Color Canvas::ReadPixel(size_t xPosition, size_t yPosition) const {
 		if (xPosition >= canvasSizeX) return Color();
 		if (yPosition >= canvasSizeY) return Color();
 
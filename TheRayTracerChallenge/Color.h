@@ -6,10 +6,10 @@ namespace RayTracer {
 	class Color
 	{
 	public:
-		double r, g, b;
+		Real r, g, b;
 
 		Color();
-		Color(double r, double g, double b);
+		Color(Real r, Real g, Real b);
 		~Color() = default;
 
 		//Operator overloads
@@ -17,7 +17,7 @@ namespace RayTracer {
 		bool operator!= (Color c);
 		Color operator+(Color c);
 		Color operator- (Color c);
-		Color operator* (double scalar);
+		Color operator* (Real scalar);
 		Color operator* (Color c);
 	};
 
@@ -26,7 +26,7 @@ namespace RayTracer {
 		r = g = b = 0.0f;
 	}
 
-	inline Color::Color(double r, double g, double b)
+	inline Color::Color(Real r, Real g, Real b)
 	{
 		this->r = r;
 		this->g = g;
@@ -56,7 +56,7 @@ namespace RayTracer {
 		return Color(r - c.r, g - c.g, b - c.b);
 	}
 
-	inline Color Color::operator*(double scalar)
+	inline Color Color::operator*(Real scalar)
 	{
 		return Color(
 			r * scalar,
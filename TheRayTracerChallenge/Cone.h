@@ -13,7 +13,7 @@ namespace RayTracer {
 	{
 	public:
 		Cone();
-		Cone(double min, double max, bool isClosed);
+		Cone(Real min, Real max, bool isClosed);
 		~Cone() = default;
 
 		void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) override;
@@ -21,19 +21,19 @@ namespace RayTracer {
 		Vector FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) override;
 
 		//Limit the length of the cone
-		void SetMaximum(double value) { maximum = value; }
-		void SetMinimum(double value) { minimum = value; }
-		double GetMaximum() { return maximum; }
-		double GetMinimum() { return minimum; }
+		void SetMaximum(Real value) { maximum = value; }
+		void SetMinimum(Real value) { minimum = value; }
+		Real GetMaximum() { return maximum; }
+		Real GetMinimum() { return minimum; }
 
 		//Is the cone closed on both ends?
 		bool IsClosed() { return closed; }
 		void SetClosed(bool isClosed) { closed = isClosed; }
 
 		BoundingBox GetObjectSpaceBounds() override {
-			double a = abs(minimum);
-			double b = abs(maximum);
-			double limit = fmax(a, b);
+			Real a = abs(minimum);
+			Real b = abs(maximum);
+			Real limit = fmax(a, b);
 
 			return BoundingBox(Point::CreatePoint(-limit, minimum, -limit), Point::CreatePoint(limit, maximum, limit));
 		}
@@ -41,11 +41,11 @@ namespace RayTracer {
 		void PartitionChildren(size_t maximumShapeCount) override {}
 
 	private:
-		double minimum, maximum;
+		Real minimum, maximum;
 		bool closed;
 
 		//Check if the ray at 't' is inside the cone 
-		bool CheckCap(Ray ray, double t, double radius);
+		bool CheckCap(Ray ray, Real t, Real radius);
 
 		//Find the ray's intersections with the end caps
 		void IntersectEndCaps(Ray ray, IntersectionBuffer & buffer);
@@ -56,12 +56,12 @@ namespace RayTracer {
 	};
 
 	inline Cone::Cone() {
-		minimum = -std::numeric_limits<double>::infinity();
-		maximum = std::numeric_limits<double>::infinity();
+		minimum = -std::numeric_limits<Real>::infinity();
+		maximum = std::numeric_limits<Real>::infinity();
 		closed = false;
 	}
 
-	inline Cone::Cone(double min, double max, bool isClosed) {
+	inline Cone::Cone(Real min, Real max, bool isClosed) {
 		minimum = min;
 		maximum = max;
 		closed = isClosed;
@@ -70,25 +70,25 @@ namespace RayTracer {
 	inline void Cone::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer)
 	{
 
-		double a = (ray.direction.x * ray.direction.x) - (ray.direction.y * ray.direction.y) + (ray.direction.z * ray.direction.z);
+		Real a = (ray.direction.x * ray.direction.x) - (ray.direction.y * ray.direction.y) + (ray.direction.z * ray.direction.z);
 
-		double b = (2.0 * ray.origin.x * ray.direction.x)
+		Real b = (2.0 * ray.origin.x * ray.direction.x)
 			- (2.0 * ray.origin.y * ray.direction.y)
 			+ (2.0 * ray.origin.z * ray.direction.z);
 
-		double c = (ray.origin.x * ray.origin.x) - (ray.origin.y * ray.origin.y) + (ray.origin.z * ray.origin.z);
+		Real c = (ray.origin.x * ray.origin.x) - (ray.origin.y * ray.origin.y) + (ray.origin.z * ray.origin.z);
 
-		double discriminant = (b * b) - (4.0 * a * c);
+		Real discriminant = (b * b) - (4.0 * a * c);
 
 		//Ray is parallel to a wall -> only 1 intersection possible
 		if (Constants::DoubleEqual(a, 0.0)) {
 			if (!Constants::DoubleEqual(b, 0.0)) {
-				double t = -c / (2.0 * b);
-				double y0 = ray.origin.y + (t * ray.direction.y);
+				Real t = -c / (2.0 * b);
+				Real y0 = ray.origin.y + (t * ray.direction.y);
 
 				//Make sure the hit is inside the cone's limits
 				if (y0 < maximum && y0 > minimum) {
-					buffer.Add(Intersection(t, GetPointer()));
+					buffer.Add(Intersection(t, this));
 				}
 			}
 		}
@@ -96,21 +96,21 @@ namespace RayTracer {
 		//Multiple intersections possible
 		else if (discriminant >= 0.0) {
 
-			double solution1 = (-b - sqrt(discriminant)) / (2.0 * a);
-			double solution2 = (-b + sqrt(discriminant)) / (2.0 * a);
+			Real solution1 = (-b - sqrt(discriminant)) / (2.0 * a);
+			Real solution2 = (-b + sqrt(discriminant)) / (2.0 * a);
 
 			if (solution1 > solution2) {
 				std::swap(solution1, solution2);
 			}
 
 			//Intersections with the walls
-			double y1 = ray.origin.y + (solution1 * ray.direction.y);
+			Real y1 = ray.origin.y + (solution1 * ray.direction.y);
 			if (y1 < maximum && y1 > minimum) {
-				buffer.Add(Intersection(solution1, GetPointer()));
+				buffer.Add(Intersection(solution1, this));
 			}
-			double y2 = ray.origin.y + (solution2 * ray.direction.y);
+			Real y2 = ray.origin.y + (solution2 * ray.direction.y);
 			if (y2 < maximum && y2 > minimum) {
-				buffer.Add(Intersection(solution2, GetPointer()));
+				buffer.Add(Intersection(solution2, this));
 			}
 		}
 
@@ -120,7 +120,7 @@ namespace RayTracer {
 
 	inline Vector Cone::FindObjectSpaceNormal(Point p, const Intersection& globalIntersection)
 	{
-		double distance = sqrt((p.x * p.x) + (p.z * p.z));
+		Real distance = sqrt((p.x * p.x) + (p.z * p.z));
 
 		if (closed) {
 			//Is the point on the end cap at 'maximum'
@@ -142,10 +142,10 @@ namespace RayTracer {
 		return Vector::CreateVector(p.x, distance, p.z);
 	}
 
-	inline bool Cone::CheckCap(Ray ray, double t, double radius) {
+	inline bool Cone::CheckCap(Ray ray, Real t, Real radius) {
 
-		double x = ray.origin.x + (t * ray.direction.x);
-		double z = ray.origin.z + (t * ray.direction.z);
+		Real x = ray.origin.x + (t * ray.direction.x);
+		Real z = ray.origin.z + (t * ray.direction.z);
 
 		return (x * x) + (z * z) <= radius * radius;
 
@@ -160,15 +160,15 @@ namespace RayTracer {
 		}
 
 		//Check if the ray hit the cap at the 'minimum'
-		double t = (minimum - ray.origin.y) / ray.direction.y;
+		Real t = (minimum - ray.origin.y) / ray.direction.y;
 		if (CheckCap(ray, t, minimum)) {
-			buffer.Add(Intersection(t, GetPointer()));
+			buffer.Add(Intersection(t, this));
 		}
 
 		//Check if the ray hit the cap at the 'maximum'
 		t = (maximum - ray.origin.y) / ray.direction.y;
 		if (CheckCap(ray, t, maximum)) {
-			buffer.Add(Intersection(t, GetPointer()));
+			buffer.Add(Intersection(t, this));
 		}
 	}
 }
\ No newline at end of file
@@ -2,17 +2,64 @@
 
 #include <cmath>
 
+//Compilers may contract a product and a following addition into one FMA instruction, which skips the rounding of the product
+//(GCC does it across statements whenever FMA is available, e.g. with -mfma, -march=native or on ARM64, MSVC with /fp:contract)
+//Kernels whose results have to match another implementation exactly use MulRounded, the product has to pass through an empty
+//asm statement, so it is always rounded before it is used
+#if defined(__GNUC__) && defined(__SSE2__)
+#define RAYTRACER_KEEP_ROUNDED(value) __asm__("" : "+x"(value))
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define RAYTRACER_KEEP_ROUNDED(value) __asm__("" : "+w"(value))
+#else
+#define RAYTRACER_KEEP_ROUNDED(value) ((void)0)
+#endif
+
+//MSVC has no asm on x64, it only contracts with /fp:contract or /fp:fast (_M_FP_CONTRACT), which is turned off around these kernels
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_FP_CONTRACT)
+#define RAYTRACER_CONTRACT_OFF __pragma(fp_contract(off))
+#define RAYTRACER_CONTRACT_ON __pragma(fp_contract(on))
+#else
+#define RAYTRACER_CONTRACT_OFF
+#define RAYTRACER_CONTRACT_ON
+#endif
+
 namespace RayTracer {
+	//Floating point type used by the whole pipeline (Define RAYTRACER_USE_FLOAT to build with single precision)
+#if defined(RAYTRACER_USE_FLOAT)
+	using Real = float;
+#else
+	using Real = double;
+#endif
+
 	namespace Constants {
 		//If the distance between two floating point numbers is smaller than
 		//EPSILON, they are treated as equal
-		const double EPSILON = 0.00001;
+#if defined(RAYTRACER_USE_FLOAT)
+		const Real EPSILON = 0.0001f;
+#else
+		const Real EPSILON = 0.00001;
+#endif
 
-		const double PI = 3.14159265358979323846;
+		//Distance that hit points are moved away from the surface to avoid self intersections (acne)
+		//Floats need a larger distance, because the error of intersections grows with the distance from the origin
+#if defined(RAYTRACER_USE_FLOAT)
+		const Real SURFACE_OFFSET = 0.001f;
+#else
+		const Real SURFACE_OFFSET = EPSILON;
+#endif
+
+		const Real PI = static_cast<Real>(3.14159265358979323846);
 
 		//Compare two floating point numbers
-		inline bool DoubleEqual(double value1, double value2) {
-			return fabs(value1 - value2) < Constants::EPSILON;
+		inline bool DoubleEqual(Real value1, Real value2) {
+			return std::fabs(value1 - value2) < Constants::EPSILON;
+		}
+
+		//Product that is never contracted into an FMA (See RAYTRACER_KEEP_ROUNDED)
+		inline Real MulRounded(Real value1, Real value2) {
+			Real product = value1 * value2;
+			RAYTRACER_KEEP_ROUNDED(product);
+			return product;
 		}
 	}
-}
\ No newline at end of file
+}
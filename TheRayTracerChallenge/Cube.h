@@ -31,7 +31,7 @@ namespace RayTracer {
 		}
 
 		//Calculate the ray's 't value' at the points '-1.0' and '0.0'
-		std::pair<double, double> checkAxis(double origin, double direction);
+		std::pair<Real, Real> checkAxis(Real origin, Real direction);
 	};
 
 	inline void Cube::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer)
@@ -41,25 +41,25 @@ namespace RayTracer {
 		auto yValues = checkAxis(ray.origin.y, ray.direction.y);
 		auto zValues = checkAxis(ray.origin.z, ray.direction.z);
 
-		double minimumT = fmax(xValues.first, fmax(yValues.first, zValues.first));
-		double maximumT = fmin(xValues.second, fmin(yValues.second, zValues.second));
+		Real minimumT = fmax(xValues.first, fmax(yValues.first, zValues.first));
+		Real maximumT = fmin(xValues.second, fmin(yValues.second, zValues.second));
 
 		if (minimumT > maximumT) {
 			//There was no intersection with the cube
 			return;
 		}
-		buffer.Add(Intersection(minimumT, GetPointer()));
-		buffer.Add(Intersection(maximumT, GetPointer()));
+		buffer.Add(Intersection(minimumT, this));
+		buffer.Add(Intersection(maximumT, this));
 	}
 
 	inline Vector Cube::FindObjectSpaceNormal(Point p, const Intersection& globalIntersection)
 	{
 		//Determine the axis that the surface normal should be alligned with
 		//The largest coordinate value of the point corresponds to this axis
-		double absX = fabs(p.x);
-		double absY = fabs(p.y);
-		double absZ = fabs(p.z);
-		double maxCoordinate = fmax(absX, fmax(absY, absZ));
+		Real absX = fabs(p.x);
+		Real absY = fabs(p.y);
+		Real absZ = fabs(p.z);
+		Real maxCoordinate = fmax(absX, fmax(absY, absZ));
 
 		//X direction
 		if (Constants::DoubleEqual(maxCoordinate, absX)) {
@@ -76,16 +76,16 @@ namespace RayTracer {
 	}
 
 
-	inline std::pair<double, double> Cube::checkAxis(double origin, double direction) {
+	inline std::pair<Real, Real> Cube::checkAxis(Real origin, Real direction) {
 		//Division by 0.0 will result in +/- infinity, which is handled correctly by the comparisons
-		double tMin = (-1.0 - origin) / direction;
-		double tMax = (1.0 - origin) / direction;
+		Real tMin = (-1.0 - origin) / direction;
+		Real tMax = (1.0 - origin) / direction;
 
 		//Always return the smaller t value as pair.first 
 		if (tMin > tMax) {
-			return std::pair<double, double>(tMax, tMin);
+			return std::pair<Real, Real>(tMax, tMin);
 		}
-		return std::pair<double, double>(tMin, tMax);
+		return std::pair<Real, Real>(tMin, tMax);
 	}
 
 }
\ No newline at end of file
@@ -13,7 +13,7 @@ namespace RayTracer {
 	{
 	public:
 		Cylinder();
-		Cylinder(double min, double max, bool isClosed);
+		Cylinder(Real min, Real max, bool isClosed);
 		~Cylinder() = default;
 
 		void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) override;
@@ -21,10 +21,10 @@ namespace RayTracer {
 		Vector FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) override;
 
 		//Limit the length of the cylinder
-		void SetMaximum(double value) { maximum = value; }
-		void SetMinimum(double value) { minimum = value; }
-		double GetMaximum() { return maximum; }
-		double GetMinimum() { return minimum; }
+		void SetMaximum(Real value) { maximum = value; }
+		void SetMinimum(Real value) { minimum = value; }
+		Real GetMaximum() { return maximum; }
+		Real GetMinimum() { return minimum; }
 
 		//Is the cylinder closed on both ends?
 		bool IsClosed() { return closed; }
@@ -37,11 +37,11 @@ namespace RayTracer {
 		void PartitionChildren(size_t maximumShapeCount) override {}
 
 	private:
-		double minimum, maximum;
+		Real minimum, maximum;
 		bool closed;
 
 		//Check if the ray at 't' is inside the cylinder 
-		bool CheckCap(Ray ray, double t);
+		bool CheckCap(Ray ray, Real t);
 
 		//Find the ray's intersections with the end caps
 		void IntersectEndCaps(Ray ray, IntersectionBuffer & buffer);
@@ -52,12 +52,12 @@ namespace RayTracer {
 	};
 
 	inline Cylinder::Cylinder() {
-		minimum = -std::numeric_limits<double>::infinity();
-		maximum = std::numeric_limits<double>::infinity();
+		minimum = -std::numeric_limits<Real>::infinity();
+		maximum = std::numeric_limits<Real>::infinity();
 		closed = false;
 	}
 
-	inline Cylinder::Cylinder(double min, double max, bool isClosed) {
+	inline Cylinder::Cylinder(Real min, Real max, bool isClosed) {
 		minimum = min;
 		maximum = max;
 		closed = isClosed;
@@ -65,7 +65,7 @@ namespace RayTracer {
 
 	inline void Cylinder::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer)
 	{
-		double a = (ray.direction.x * ray.direction.x) + (ray.direction.z * ray.direction.z);
+		Real a = (ray.direction.x * ray.direction.x) + (ray.direction.z * ray.direction.z);
 
 		//Ray is parallel to y axis -> ray can only hit the end caps
 		if (Constants::DoubleEqual(a, 0.0)) {
@@ -73,33 +73,33 @@ namespace RayTracer {
 			return;
 		}
 
-		double b = (2.0 * ray.origin.x * ray.direction.x)
+		Real b = (2.0 * ray.origin.x * ray.direction.x)
 			+ (2.0 * ray.origin.z * ray.direction.z);
 
-		double c = (ray.origin.x * ray.origin.x) + (ray.origin.z * ray.origin.z) - 1.0;
+		Real c = (ray.origin.x * ray.origin.x) + (ray.origin.z * ray.origin.z) - 1.0;
 
-		double discriminant = (b * b) - (4.0 * a * c);
+		Real discriminant = (b * b) - (4.0 * a * c);
 
 		//No intersections with the walls -> ray can only hit the end caps
 		if (discriminant < 0.0) {
 			return IntersectEndCaps(ray, buffer);
 		}
 
-		double solution1 = (-b - sqrt(discriminant)) / (2.0 * a);
-		double solution2 = (-b + sqrt(discriminant)) / (2.0 * a);
+		Real solution1 = (-b - sqrt(discriminant)) / (2.0 * a);
+		Real solution2 = (-b + sqrt(discriminant)) / (2.0 * a);
 
 		if (solution1 > solution2) {
 			std::swap(solution1, solution2);
 		}
 
 		//Intersections with the walls
-		double y1 = ray.origin.y + (solution1 * ray.direction.y);
+		Real y1 = ray.origin.y + (solution1 * ray.direction.y);
 		if (y1 < maximum && y1 > minimum) {
-			buffer.Add(Intersection(solution1, GetPointer()));
+			buffer.Add(Intersection(solution1, this));
 		}
-		double y2 = ray.origin.y + (solution2 * ray.direction.y);
+		Real y2 = ray.origin.y + (solution2 * ray.direction.y);
 		if (y2 < maximum && y2 > minimum) {
-			buffer.Add(Intersection(solution2, GetPointer()));
+			buffer.Add(Intersection(solution2, this));
 		}
 		//Intersections with the end caps
 		IntersectEndCaps(ray, buffer);
@@ -107,7 +107,7 @@ namespace RayTracer {
 
 	inline Vector Cylinder::FindObjectSpaceNormal(Point p, const Intersection& globalIntersection)
 	{
-		double distanceSquared = (p.x * p.x) + (p.z * p.z);
+		Real distanceSquared = (p.x * p.x) + (p.z * p.z);
 
 		//Is the point on the end cap at 'maximum'
 		if (distanceSquared < 1.0 && p.y >= maximum - Constants::EPSILON) {
@@ -123,9 +123,9 @@ namespace RayTracer {
 		return Vector::CreateVector(p.x, 0.0, p.z);
 	}
 
-	inline bool Cylinder::CheckCap(Ray ray, double t) {
-		double x = ray.origin.x + (t * ray.direction.x);
-		double z = ray.origin.z + (t * ray.direction.z);
+	inline bool Cylinder::CheckCap(Ray ray, Real t) {
+		Real x = ray.origin.x + (t * ray.direction.x);
+		Real z = ray.origin.z + (t * ray.direction.z);
 
 		return (x * x) + (z * z) <= 1.0;
 	}
@@ -137,15 +137,15 @@ namespace RayTracer {
 		}
 
 		//Check if the ray hit the cap at the 'minimum'
-		double t = (minimum - ray.origin.y) / ray.direction.y;
+		Real t = (minimum - ray.origin.y) / ray.direction.y;
 		if (CheckCap(ray, t)) {
-			buffer.Add(Intersection(t, GetPointer()));
+			buffer.Add(Intersection(t, this));
 		}
 
 		//Check if the ray hit the cap at the 'maximum'
 		t = (maximum - ray.origin.y) / ray.direction.y;
 		if (CheckCap(ray, t)) {
-			buffer.Add(Intersection(t, GetPointer()));
+			buffer.Add(Intersection(t, this));
 		}
 	}
 }
\ No newline at end of file
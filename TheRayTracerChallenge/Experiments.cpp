@@ -1,4 +1,8 @@
 #include "Experiments.h"
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <limits>
 
 //End of chapter 4
 void RayTracer::DrawWatchface() {
@@ -113,7 +117,7 @@ void RayTracer::DrawSphereReflections() {
                 Vector normal = s->SurfaceNormal(hitPoint, hit);
                 Vector eye = -ray.direction;
 
-                canvas.WritePixel(l.Lighting(s, hitPoint, eye, normal, false) , x, y);
+                canvas.WritePixel(l.Lighting(s.get(), hitPoint, eye, normal, false) , x, y);
 
 
             }
@@ -279,7 +283,7 @@ void RayTracer::DrawChapter7Scene()
 	}
 	
 
-	camera.RenderFrame(world).SaveToFile("chapter14");
+	camera.RenderFrameMultithreaded(world).SaveToFile("chapter14");
 
 	std::cout << "\n";
 	std::cout << "Rays: " << std::to_string(world.numberOfRaysCast) << "\n";
@@ -337,10 +341,18 @@ void RayTracer::DrawBoundingBoxScene()
 		}
 	}
 
-	group->PartitionChildren(5);
+	group->BuildHierarchy(BVHBuildSettings());
 	world.AddShape(group);
 
-	camera.RenderFrame(world).SaveToFile("boundingBoxTest");
+	auto begin = std::chrono::steady_clock::now();
+	Canvas image = camera.RenderFrameMultithreaded(world);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	//Float and double builds write different files, which can be checked with CompareImages
+	std::string precision = (sizeof(Real) == sizeof(float)) ? "float" : "double";
+	std::cout << "Rendered with " << precision << " precision in " << seconds << " s\n";
+
+	image.SaveToFile("boundingBoxTest_" + precision);
 
 	std::cout << "\n";
 	std::cout << "Rays: " << std::to_string(world.numberOfRaysCast) << "\n";
@@ -365,19 +377,17 @@ void RayTracer::DrawTriangleScene()
 	lightSource->SetPosition(Point::CreatePoint(-70.0f, 400.0f, -70.0f));
 	world.AddLightSource(lightSource);
 
-	OBJParser parser;
-	
-	parser.ParseFile("C:/Users/Monst/Desktop/ML_HP.obj");
-
-	std::cout << "Splitting groups and generating bounding boxes ... ";
+	//Later runs read the mesh and its hierarchy from the binary cache next to the .obj file
+	OBJLoader loader;
+	auto mesh = loader.LoadMesh("C:/Users/Monst/Desktop/ML_HP.obj");
+	if (!mesh) return;
+	std::cout << loader.GetStatistics().ToString();
 
-	auto group = parser.MakeGroup();
-	Material groupMaterial;
-	groupMaterial.ambient = 0.4;
-	groupMaterial.specular = 0.4;
-	groupMaterial.shininess = 200;
-	group->SetMaterial(groupMaterial);
-	//auto group2 = group->Copy();
+	Material meshMaterial;
+	meshMaterial.ambient = 0.4;
+	meshMaterial.specular = 0.4;
+	meshMaterial.shininess = 200;
+	mesh->SetMaterial(meshMaterial);
 
 	auto background = Shape::MakeShared<Plane>();
 	//background->SetTransform(Transform::CreateRotationX(Constants::PI / 2.0).Translate(0.0, 0.0, 5.0));
@@ -388,8 +398,9 @@ void RayTracer::DrawTriangleScene()
 	backgroundMaterial.pattern->SetTransform(Transform::CreateScale(10, 10, 10));
 	background->SetMaterial(backgroundMaterial);
 
-	group->SetTransform(Transform::CreateTranslation(-60.0, 0.0, -50.0));
-	group->PartitionChildren(5);
+	mesh->SetTransform(Transform::CreateTranslation(-60.0, 0.0, -50.0));
+	std::cout << "Done\n";
+	std::cout << mesh->GetTriangleCount() << " Triangles, " << mesh->GetData().GetMemoryUsage() / 1024 << " KiB\n";
 	
 	/*group2->SetTransform(Transform::CreateRotationY(Constants::PI / 2.7).Translate(2.5, 0.0, 0.0));
 	group2->PartitionChildren(5);
@@ -401,18 +412,384 @@ void RayTracer::DrawTriangleScene()
 	m.pattern->SetTransform(Transform::CreateScale(0.1, 0.1, 0.1));
 	group2->SetMaterial(m);
 	*/
-	world.AddShape(group);
+	world.AddShape(mesh);
 	world.AddShape(background);
 	//world.AddShape(group2);
 
+	camera.RenderFrameMultithreaded(world).SaveToFile("Triangles");
 
+	std::cout << "\n";
+	std::cout << "Rays: " << std::to_string(world.numberOfRaysCast) << "\n";
+}
 
-	std::cout << "Done\n";
+void RayTracer::CompareHierarchies(std::string fileName)
+{
+	OBJParser parser;
+	if (!parser.ParseFile(fileName)) return;
 
-	camera.RenderFrame(world).SaveToFile("Triangles");
+	auto group = parser.MakeGroup();
 
-	std::cout << "\n";
-	std::cout << "Rays: " << std::to_string(world.numberOfRaysCast) << "\n";
+	//Compare the midpoint partitioning with the SAH builder
+	auto midpointGroup = std::dynamic_pointer_cast<ShapeGroup>(group->Copy());
+	midpointGroup->PartitionChildren(5);
+	std::cout << "\nMidpoint partitioning:\n" << midpointGroup->GetHierarchyStatistics().ToString();
+
+	group->BuildHierarchy(BVHBuildSettings());
+	std::cout << "SAH:\n" << group->GetHierarchyStatistics().ToString();
+}
+
+void RayTracer::MeasureOBJLoading(std::string fileName)
+{
+	//Double the thread count until every hardware thread is used
+	for (size_t threadCount = 1; ; threadCount *= 2) {
+		threadCount = std::min(threadCount, ThreadPool::GetHardwareThreadCount());
+
+		OBJLoader loader(threadCount);
+		if (!loader.LoadFile(fileName)) return;
+
+		std::cout << loader.GetStatistics().ToString() << "\n";
+
+		if (threadCount == ThreadPool::GetHardwareThreadCount()) break;
+	}
+}
+
+void RayTracer::MeasureAffineTransforms(size_t iterations)
+{
+	Transform transform = Transform::CreateScale(1.0, 2.0, 3.0).RotateY(Constants::PI / 5.0).RotateX(0.3).Translate(1.0, -2.0, 0.5);
+	Matrix4x4 matrix = transform.GetMatrix();
+	Affine3x4 affine = transform.GetAffine();
+
+	//Prints the time per operation, the checksum keeps the compiler from removing the loops
+	auto measure = [iterations](const char* name, auto operation) {
+		double checksum = 0.0;
+		auto begin = std::chrono::steady_clock::now();
+
+		for (size_t i = 0; i < iterations; i++) {
+			checksum += operation(static_cast<double>(i & 1023) * 0.001);
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		std::cout << name << ": " << seconds * 1e9 / static_cast<double>(iterations) << " ns (checksum " << checksum << ")\n";
+	};
+
+	measure("Matrix4x4 * Point", [&](double offset) {
+		return (matrix * Point::CreatePoint(offset, 1.0, 2.0)).x;
+	});
+	measure("Affine3x4 * Point", [&](double offset) {
+		return (affine * Point::CreatePoint(offset, 1.0, 2.0)).x;
+	});
+
+	Matrix4x4 matrixInverse = matrix.Inversion();
+	Affine3x4 affineInverse = affine.Inversion();
+	measure("Matrix4x4 Ray transform", [&](double offset) {
+		Ray ray(Point::CreatePoint(offset, 1.0, 2.0), Vector::CreateVector(0.0, offset, 1.0));
+		return (matrixInverse * ray.origin).y + (matrixInverse * ray.direction).z;
+	});
+	measure("Affine3x4 Ray transform", [&](double offset) {
+		Ray ray(Point::CreatePoint(offset, 1.0, 2.0), Vector::CreateVector(0.0, offset, 1.0));
+		ray = ray.Transform(affineInverse);
+		return ray.origin.y + ray.direction.z;
+	});
+
+	measure("Matrix4x4 Inversion", [&](double offset) {
+		matrix.elements[0][3] = offset;
+		return matrix.Inversion().elements[0][3];
+	});
+	measure("Affine3x4 Inversion", [&](double offset) {
+		affine.rows[0][3] = offset;
+		return affine.Inversion().rows[0][3];
+	});
+
+	measure("Matrix4x4 * Matrix4x4", [&](double offset) {
+		matrix.elements[0][3] = offset;
+		return (matrix * matrixInverse).elements[0][3];
+	});
+	measure("Affine3x4 * Affine3x4", [&](double offset) {
+		affine.rows[0][3] = offset;
+		return (affine * affineInverse).rows[0][3];
+	});
+}
+
+void RayTracer::MeasureTriangleIntersections(std::string fileName, size_t rayCount)
+{
+	OBJLoader loader;
+	auto mesh = loader.LoadMesh(fileName);
+	if (!mesh) return;
+
+	//Rays start on a sphere around the mesh and point at random positions inside of its bounds
+	BoundingBox bounds = mesh->GetObjectSpaceBounds();
+	Point center = bounds.GetCenter();
+	Vector extent = bounds.GetMax() - bounds.GetMin();
+	double radius = extent.Magnitude();
+
+	RenderContext context;
+	std::vector<Ray> rays;
+	rays.reserve(rayCount);
+
+	for (size_t i = 0; i < rayCount; i++) {
+		Vector offset = Vector::CreateVector(context.NextRandom() - 0.5, context.NextRandom() - 0.5, context.NextRandom() - 0.5);
+		Point target = bounds.GetMin() + Vector::CreateVector(context.NextRandom() * extent.x, context.NextRandom() * extent.y, context.NextRandom() * extent.z);
+		Point origin = center + offset.Normalize() * radius;
+		rays.push_back(Ray(origin, (target - origin).Normalize()));
+	}
+
+	std::cout << mesh->GetTriangleCount() << " triangles, " << rayCount << " rays\n";
+
+	//Both versions use the hierarchy they would be built with (Blocks lead to larger leaves)
+	for (auto mode : { TriangleIntersectionMode::MollerTrumbore, TriangleIntersectionMode::Watertight }) {
+		for (bool useBlocks : { false, true }) {
+			mesh->SetIntersectionMode(mode);
+			mesh->SetUseTriangleBlocks(useBlocks);
+			mesh->InvalidateAccelerationStructure();
+			mesh->BuildAccelerationStructure();
+
+			//Triangles in the leaves that are entered in front of the closest hit
+			size_t triangleTests = 0;
+			for (const Ray& ray : rays) {
+				Intersection hit(std::numeric_limits<Real>::infinity(), nullptr);
+				mesh->FindObjectSpaceClosestHit(ray, hit, context);
+				mesh->GetAccelerationStructure().Traverse(ray, 0.0, hit.t, [&](uint32_t) {
+					triangleTests++;
+					return false;
+				});
+			}
+
+			size_t hitCount = 0;
+			auto begin = std::chrono::steady_clock::now();
+
+			for (const Ray& ray : rays) {
+				Intersection hit(std::numeric_limits<Real>::infinity(), nullptr);
+				if (mesh->FindObjectSpaceClosestHit(ray, hit, context)) hitCount++;
+			}
+
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			std::cout << (mode == TriangleIntersectionMode::Watertight ? "Watertight, " : "Moller-Trumbore, ")
+				<< (useBlocks ? "triangle blocks: " : "single triangles: ")
+				<< static_cast<double>(triangleTests) / seconds / 1e6 << " M triangles/s, "
+				<< static_cast<double>(rayCount) / seconds / 1e6 << " M rays/s (" << hitCount << " hits)\n";
+		}
+	}
+}
+
+namespace RayTracer {
+	//Light source and a grid of size^3 colored spheres, added to the world directly (So the world's hierarchy is traversed)
+	static void AddSphereGrid(World& world, int size)
+	{
+		auto lightSource = std::make_shared<LightSource>(Point::CreatePoint(-10.0, 10.0, -10.0), Color(1.0, 1.0, 1.0));
+		world.AddLightSource(lightSource);
+
+		for (int x = 0; x < size; x++) {
+			for (int y = 0; y < size; y++) {
+				for (int z = 0; z < size; z++) {
+					double fracX = static_cast<double>(x) / static_cast<double>(size);
+					double fracY = static_cast<double>(y) / static_cast<double>(size);
+					double fracZ = static_cast<double>(z) / static_cast<double>(size);
+
+					auto shape = Shape::MakeShared<Sphere>();
+					Material m;
+					m.pattern = std::make_shared<ColorPattern>(Color(fracX, fracY, fracZ));
+					shape->SetMaterial(m);
+
+					Transform t;
+					t.Scale(0.4, 0.4, 0.4);
+					t.Translate(fracX * 30.0 - 15.0, fracY * 30.0 - 15.0, fracZ * 20.0 + 3.0);
+					shape->SetTransform(t);
+
+					world.AddShape(shape);
+				}
+			}
+		}
+	}
+}
+
+void RayTracer::MeasurePacketTracing(int size)
+{
+	World world;
+	AddSphereGrid(world, size);
+
+	Camera camera(400, 300, Constants::PI / 3.0,
+		Camera::CreateViewTransform(
+			Point::CreatePoint(0.0, 0.0, -30.0),
+			Point::CreatePoint(0.0, 0.0, 10.0),
+			Vector::CreateVector(0.0, 1.0, 0.0)
+		)
+	);
+
+	std::cout << world.GetShapes().size() << " spheres, " << camera.GetXSize() * camera.GetYSize() << " pixels\n";
+
+	//One thread, so the times only depend on the traversal
+	Canvas images[2] = { Canvas(1, 1), Canvas(1, 1) };
+
+	for (bool usePackets : { false, true }) {
+		camera.SetUsePacketTracing(usePackets);
+
+		auto begin = std::chrono::steady_clock::now();
+		images[usePackets ? 1 : 0] = camera.RenderFrameMultithreaded(world, 1);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		std::cout << (usePackets ? "Packets of " + std::to_string(RayPacket::Size) + " rays: " : "Single rays: ") << seconds << " s\n";
+	}
+
+	size_t differentPixels = 0;
+	for (size_t y = 0; y < camera.GetYSize(); y++) {
+		for (size_t x = 0; x < camera.GetXSize(); x++) {
+			if (!(images[0].ReadPixel(x, y) == images[1].ReadPixel(x, y))) differentPixels++;
+		}
+	}
+
+	std::cout << differentPixels << " pixels differ\n";
+}
+
+void RayTracer::MeasureRenderOrder(int size)
+{
+	World world;
+	AddSphereGrid(world, size);
+
+	Camera camera(800, 600, Constants::PI / 3.0,
+		Camera::CreateViewTransform(
+			Point::CreatePoint(0.0, 0.0, -30.0),
+			Point::CreatePoint(0.0, 0.0, 10.0),
+			Vector::CreateVector(0.0, 1.0, 0.0)
+		)
+	);
+
+	std::cout << world.GetShapes().size() << " spheres, " << camera.GetXSize() * camera.GetYSize() << " pixels\n";
+
+	for (bool usePackets : { false, true }) {
+		camera.SetUsePacketTracing(usePackets);
+
+		for (bool useMorton : { false, true }) {
+			camera.SetUseMortonOrder(useMorton);
+
+			auto begin = std::chrono::steady_clock::now();
+			camera.RenderFrame(world);
+			double serialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+			begin = std::chrono::steady_clock::now();
+			camera.RenderFrameMultithreaded(world, 1);
+			double tileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+			std::cout << (usePackets ? "Packets, " : "Single rays, ") << (useMorton ? "Z-order" : "columns / rows")
+				<< ": RenderFrame " << serialSeconds << " s, tiles on one thread " << tileSeconds << " s\n";
+		}
+	}
+}
+
+void RayTracer::MeasureAntialiasing()
+{
+	World world;
+
+	auto lightSource = std::make_shared<LightSource>(Point::CreatePoint(-10.0, 10.0, -10.0), Color(1.0, 1.0, 1.0));
+	world.AddLightSource(lightSource);
+
+	auto floor = Shape::MakeShared<Plane>();
+	Material floorMaterial;
+	floorMaterial.pattern = std::make_shared<CheckerPattern>(Color(0.1, 0.1, 0.1), Color(0.9, 0.9, 0.9));
+	floorMaterial.reflective = 0.2;
+	floor->SetMaterial(floorMaterial);
+	world.AddShape(floor);
+
+	for (int i = 0; i < 5; i++) {
+		auto sphere = Shape::MakeShared<Sphere>();
+		Material m;
+		m.pattern = std::make_shared<ColorPattern>(Color(0.2 * i, 0.5, 1.0 - 0.2 * i));
+		sphere->SetMaterial(m);
+		sphere->SetTransform(Transform::CreateScale(0.8, 0.8, 0.8).Translate(i * 2.0 - 4.0, 0.8, i * 1.5));
+		world.AddShape(sphere);
+	}
+
+	Camera camera(320, 180, Constants::PI / 3.0,
+		Camera::CreateViewTransform(
+			Point::CreatePoint(0.0, 3.0, -8.0),
+			Point::CreatePoint(0.0, 0.5, 2.0),
+			Vector::CreateVector(0.0, 1.0, 0.0)
+		)
+	);
+
+	auto render = [&](size_t initialSamples, size_t maximumSamples, Real threshold, double& seconds) {
+		AntialiasingSettings settings;
+		settings.initialSamples = initialSamples;
+		settings.maximumSamples = maximumSamples;
+		settings.threshold = threshold;
+		camera.SetAntialiasing(settings);
+
+		auto begin = std::chrono::steady_clock::now();
+		Canvas image = camera.RenderFrameMultithreaded(world, 1);
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		return image;
+	};
+
+	//Root mean square difference of the clamped colors
+	auto findError = [&](const Canvas& image, const Canvas& reference) {
+		double sum = 0.0;
+		for (size_t y = 0; y < camera.GetYSize(); y++) {
+			for (size_t x = 0; x < camera.GetXSize(); x++) {
+				Color a = image.ReadPixel(x, y), b = reference.ReadPixel(x, y);
+				Real channels[3][2] = { { a.r, b.r }, { a.g, b.g }, { a.b, b.b } };
+				for (auto& channel : channels) {
+					double difference = std::min(std::max(channel[0], static_cast<Real>(0.0)), static_cast<Real>(1.0))
+						- std::min(std::max(channel[1], static_cast<Real>(0.0)), static_cast<Real>(1.0));
+					sum += difference * difference;
+				}
+			}
+		}
+		return std::sqrt(sum / (camera.GetXSize() * camera.GetYSize() * 3));
+	};
+
+	double seconds;
+	Canvas reference = render(16, 64, 0.0, seconds);
+	std::cout << "Reference (64 samples per pixel): " << seconds << " s\n";
+
+	struct Setting { std::string name; size_t initialSamples, maximumSamples; Real threshold; };
+	for (const Setting& setting : { Setting{ "No antialiasing", 1, 1, 0.0 }, Setting{ "16 samples", 16, 16, 0.0 },
+		Setting{ "Adaptive 2 - 16", 2, 16, 0.01 }, Setting{ "Adaptive 4 - 16", 4, 16, 0.01 }, Setting{ "Adaptive 4 - 32", 4, 32, 0.01 } }) {
+		Canvas image = render(setting.initialSamples, setting.maximumSamples, setting.threshold, seconds);
+		std::cout << setting.name << ": " << seconds << " s, " << camera.GetAverageSamplesPerPixel() << " samples per pixel, error " << findError(image, reference) << "\n";
+	}
+}
+
+//Read the color values of a .ppm file written by Canvas::SaveToFile
+static bool ReadPPMValues(const std::string& fileName, std::vector<unsigned int>& values)
+{
+	std::ifstream file(fileName);
+	std::string magic;
+	size_t width = 0, height = 0;
+	unsigned int maxValue = 0;
+
+	if (!(file >> magic >> width >> height >> maxValue) || magic != "P3") return false;
+
+	values.clear();
+	values.reserve(width * height * 3);
+
+	unsigned int value;
+	while (file >> value) values.push_back(value);
+
+	return values.size() == width * height * 3;
+}
+
+bool RayTracer::CompareImages(std::string fileName1, std::string fileName2, unsigned int tolerance)
+{
+	std::vector<unsigned int> values1, values2;
+
+	if (!ReadPPMValues(fileName1, values1) || !ReadPPMValues(fileName2, values2) || values1.size() != values2.size()) {
+		std::cout << "Images can't be compared\n";
+		return false;
+	}
+
+	size_t differentValues = 0;
+	unsigned int maximumDifference = 0;
+
+	for (size_t i = 0; i < values1.size(); i++) {
+		unsigned int difference = (values1[i] > values2[i]) ? values1[i] - values2[i] : values2[i] - values1[i];
+
+		maximumDifference = std::max(maximumDifference, difference);
+		if (difference > tolerance) differentValues++;
+	}
+
+	std::cout << differentValues << " of " << values1.size() << " color values differ by more than " << tolerance
+		<< " (Maximum difference: " << maximumDifference << ")\n";
+
+	return differentValues == 0;
 }
 
 void RayTracer::DrawCSGScene()
@@ -510,7 +887,8 @@ void RayTracer::DrawCSGScene()
 
 	std::cout << "Done\n";
 
-	camera.RenderFrame(world).SaveToFile("CSG");
+	camera.SetProgressCallback(ProgressReporter::PrintToConsole);
+	camera.RenderFrameMultithreaded(world).SaveToFile("CSG");
 
 	std::cout << "\n";
 	std::cout << "Rays: " << std::to_string(world.numberOfRaysCast) << "\n";
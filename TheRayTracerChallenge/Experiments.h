@@ -28,7 +28,9 @@
 #include "Cone.h"
 #include "ShapeGroup.h"
 #include "Triangle.h"
+#include "TriangleMesh.h"
 #include "OBJParser.h"
+#include "OBJLoader.h"
 #include "CSGShape.h"
 
 namespace RayTracer {
@@ -41,10 +43,36 @@ namespace RayTracer {
 
 	void DrawChapter7Scene();
 
+	//Renders 1000 spheres and prints the time (The file name contains the precision of Real)
 	void DrawBoundingBoxScene();
 
+	//Compare two .ppm files and print how many color values differ by more than the tolerance
+	bool CompareImages(std::string fileName1, std::string fileName2, unsigned int tolerance);
+
 	void DrawTriangleScene();
 
+	//Print statistics of the midpoint and SAH hierarchies built for an .obj file
+	void CompareHierarchies(std::string fileName);
+
+	//Load an .obj file with 1, 2, 4, ... threads and print the throughput
+	void MeasureOBJLoading(std::string fileName);
+
+	//Time point transforms, ray transforms and inversions with Matrix4x4 and Affine3x4
+	void MeasureAffineTransforms(size_t iterations = 10000000);
+
+	//Shoot random rays at the mesh of an .obj file and print the triangle throughput of both intersection modes with and without triangle blocks
+	void MeasureTriangleIntersections(std::string fileName, size_t rayCount = 1000000);
+
+	//Render a world with size^3 spheres (Without a group, so the world's hierarchy is traversed) with and without ray packets and print the times
+	void MeasurePacketTracing(int size = 20);
+
+	//Render size^3 spheres with RenderFrame and with one thread, with the tiles / pixels in Z-order and in the previous column / row order, and print the times
+	void MeasureRenderOrder(int size = 10);
+
+	//Render spheres on a checkered plane without antialiasing, with 16 samples per pixel and with adaptive sampling (2 or 4 samples per batch)
+	//Prints the times, the samples per pixel and the error compared to an image with 64 samples per pixel
+	void MeasureAntialiasing();
+
 	void DrawCSGScene();
 
 }
\ No newline at end of file
@@ -19,7 +19,7 @@ namespace RayTracer {
 		Color ReadPattern(Point point) override {
 			Color colorDistance = color2 - color1;
 
-			double distanceFraction = point.x - floor(point.x);
+			Real distanceFraction = point.x - floor(point.x);
 
 			//Linear interpolation
 			return color1 + (colorDistance * distanceFraction);
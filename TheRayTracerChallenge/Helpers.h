@@ -13,6 +13,10 @@ namespace RayTracer {
 			return std::stod(str);
 		}
 
+		template<> inline float StrToNr<float>(std::string& str) {
+			return std::stof(str);
+		}
+
 		template<> static size_t StrToNr<size_t>(std::string& str) {
 			return std::stoul(str);
 		}
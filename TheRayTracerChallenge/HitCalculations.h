@@ -8,14 +8,15 @@
 #include <memory>
 #include <algorithm>
 #include "Constants.h"
+#include "RenderContext.h"
 
 
 namespace RayTracer {
 	//Calculates attributes that further describe the intersection of a ray with a shape
 	class HitCalculations {
 	public:
-		double t;
-		std::shared_ptr<Shape> shape;
+		Real t;
+		Shape* shape;
 		Point point;
 		Point overPoint;
 		Point underPoint;
@@ -23,13 +24,55 @@ namespace RayTracer {
 		Vector normalVector;
 		Vector reflectionVector;
 
-		double refractiveIndex1;
-		double refractiveIndex2;
+		Real refractiveIndex1;
+		Real refractiveIndex2;
 
 		bool insideShape;
 
-		HitCalculations(const Intersection& intersection, IntersectionBuffer& intersections, const Ray& ray, std::vector<std::shared_ptr<Shape>>& shapes) {
+		HitCalculations(const Intersection& intersection, IntersectionBuffer& intersections, const Ray& ray, const std::vector<std::shared_ptr<Shape>>& shapes) {
+			//List of objects that the ray is currently inside of
+			std::vector<Shape*> containers;
+
+			Calculate(intersection, intersections, ray, containers);
+		}
+
+		//Uses the context's medium stack instead of allocating a new list
+		HitCalculations(const Intersection& intersection, IntersectionBuffer& intersections, const Ray& ray, RenderContext& context) {
+			std::vector<Shape*>& containers = context.GetMediumStack();
+			containers.clear();
+
+			Calculate(intersection, intersections, ray, containers);
+		}
+
+		//Approximation used to blend the intensities of reflected and refracted colors (Simulates the 'Fresnel Effect')
+		Real SchlickApproximation() const {
+			Real cos = Vector::DotProduct(eyeVector, normalVector);
+
+			//Total internal reflection can only occur if N1 > N2
+			if (refractiveIndex1 > refractiveIndex2) {
+				Real refractiveRatio = refractiveIndex1 / refractiveIndex2;
+				Real sin2_t = refractiveRatio * refractiveRatio * (1.0 - (cos * cos));
+
+				//Total internal reflection
+				if (sin2_t > 1.0) {
+					return 1.0;
+				}
+
+				//When n1 > n2, use cos(theta_t) instead of cos for the other calculations
+				cos = sqrt(1.0 - sin2_t);
+			}
+
+			//Math...
+			Real r0 = pow((refractiveIndex1 - refractiveIndex2)
+				/ (refractiveIndex1 + refractiveIndex2), 2.0);
+
+			return r0 + ((1 - r0) * pow(1 - cos, 5.0));
+		}
 
+	private:
+		//Calculate the hit's attributes (containers is used as scratch memory for the shapes that the ray is inside of)
+		//intersection is copied, because it may refer to an element of intersections, which are reordered
+		void Calculate(const Intersection intersection, IntersectionBuffer& intersections, const Ray& ray, std::vector<Shape*>& containers) {
 			t = intersection.t;
 			shape = intersection.shape;
 			point = ray.PositionAt(t);
@@ -51,15 +94,8 @@ namespace RayTracer {
 			//Slightly adjusted points slightly above and below the actual hit:
 			//These are used for shading and reflection, so the reflected ray doesn't
 			//collide with the original shape due to floating point inaccuracies
-			overPoint = point + (normalVector * Constants::EPSILON);
-			underPoint = point - (normalVector * Constants::EPSILON);
-
-
-			//List of objects that the ray is currently inside of
-			std::vector<std::shared_ptr<Shape>> containers;
-
-
-			intersections.Sort();
+			overPoint = point + (normalVector * Constants::SURFACE_OFFSET);
+			underPoint = point - (normalVector * Constants::SURFACE_OFFSET);
 
 
 			//Refractive indices of the materials at the 'intersection'
@@ -67,8 +103,8 @@ namespace RayTracer {
 			refractiveIndex1 = 1.0;
 			refractiveIndex2 = 1.0;
 
-			//Go through every intersection
-			size_t numberOfIntersections = intersections.GetCount();
+			//Go through every intersection up to the hit (Only those need to be sorted)
+			size_t numberOfIntersections = intersections.SortUpTo(intersection.t);
 			for (size_t index = 0; index < numberOfIntersections; index++) {
 				Intersection currentIntersection = intersections[index];
 
@@ -111,30 +147,5 @@ namespace RayTracer {
 				}
 			}
 		}
-
-		//Approximation used to blend the intensities of reflected and refracted colors (Simulates the 'Fresnel Effect')
-		double SchlickApproximation() const {
-			double cos = Vector::DotProduct(eyeVector, normalVector);
-
-			//Total internal reflection can only occur if N1 > N2
-			if (refractiveIndex1 > refractiveIndex2) {
-				double refractiveRatio = refractiveIndex1 / refractiveIndex2;
-				double sin2_t = refractiveRatio * refractiveRatio * (1.0 - (cos * cos));
-
-				//Total internal reflection
-				if (sin2_t > 1.0) {
-					return 1.0;
-				}
-
-				//When n1 > n2, use cos(theta_t) instead of cos for the other calculations
-				cos = sqrt(1.0 - sin2_t);
-			}
-
-			//Math...
-			double r0 = pow((refractiveIndex1 - refractiveIndex2)
-				/ (refractiveIndex1 + refractiveIndex2), 2.0);
-
-			return r0 + ((1 - r0) * pow(1 - cos, 5.0));
-		}
 	};
 }
\ No newline at end of file
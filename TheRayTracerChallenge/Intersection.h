@@ -2,54 +2,78 @@
 
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <type_traits>
 #include "Constants.h"
 
 namespace RayTracer {
 	class Shape;
 
 	//Type used to store the intersection of a ray and a shape
+	//Trivially copyable, so buffers of intersections can be copied and sorted without touching reference counts
 	class Intersection {
 
 	public:
-		//Shape that was hit
-		std::shared_ptr<Shape> shape;
+		//Shape that was hit (Not owned: Only valid as long as the scene that contains the shape)
+		Shape* shape;
 
 		//Value of parameter 't' at the intersection
-		double t;
+		Real t;
 
 		//Hit positions for triangles, undefined for other shapes
-		double u, v;
+		Real u, v;
 		bool hitPositionSet;
 
+		//Shapes that consist of multiple primitives (Triangle meshes): Index of the primitive that was hit
+		uint32_t primitiveIndex;
+
 		Intersection();
-		Intersection(double t, std::shared_ptr<Shape> shapePointer);
-		Intersection(double t, std::shared_ptr <Shape> shapePointer, double u, double v);
+		Intersection(Real t, Shape* shapePointer);
+		//Setup code that holds the shape's shared_ptr
+		Intersection(Real t, const std::shared_ptr<Shape>& shapePointer) : Intersection(t, shapePointer.get()) {}
+		Intersection(Real t, Shape* shapePointer, Real u, Real v);
+		Intersection(Real t, Shape* shapePointer, Real u, Real v, uint32_t primitive);
 		~Intersection() = default;
 
 		bool IsValid() const { return shape != nullptr; }
 	};
 
+	static_assert(std::is_trivially_copyable<Intersection>::value, "Intersection should be trivially copyable");
+
 	inline Intersection::Intersection() {
+		shape = nullptr;
 		t = 0.0f;
 		u = 0.0;
 		v = 0.0;
 		hitPositionSet = false;
+		primitiveIndex = 0;
 	}
 
-	inline Intersection::Intersection(double t, std::shared_ptr<Shape> shapePointer) {
+	inline Intersection::Intersection(Real t, Shape* shapePointer) {
 		this->t = t;
 		this->shape = shapePointer;
 		u = 0.0;
 		v = 0.0;
 		hitPositionSet = false;
+		primitiveIndex = 0;
+	}
+
+	inline Intersection::Intersection(Real t, Shape* shapePointer, Real u, Real v) {
+		this->t = t;
+		this->shape = shapePointer;
+		this->u = u;
+		this->v = v;
+		hitPositionSet = true;
+		primitiveIndex = 0;
 	}
 
-	inline Intersection::Intersection(double t, std::shared_ptr <Shape> shapePointer, double u, double v) {
+	inline Intersection::Intersection(Real t, Shape* shapePointer, Real u, Real v, uint32_t primitive) {
 		this->t = t;
 		this->shape = shapePointer;
 		this->u = u;
 		this->v = v;
 		hitPositionSet = true;
+		primitiveIndex = primitive;
 	}
 
 	inline bool operator== (const Intersection i1, const Intersection i2) {
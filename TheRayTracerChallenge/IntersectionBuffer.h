@@ -2,95 +2,167 @@
 
 #include "Intersection.h"
 #include <algorithm>
+#include <vector>
 
 
 namespace RayTracer {
 	//Stores an arbitrary number of intersections
+	//The first intersections are stored inside the buffer itself, so most rays don't need any heap allocations
+	//Only larger numbers of intersections (e.g. deep CSG trees or stacks of glass) are moved to a vector,
+	//which keeps its memory after a Reset (Buffers borrowed from a RenderContext stop allocating after a few rays)
 	class IntersectionBuffer {
 	public:
+		static constexpr size_t InlineCapacity = 8;
+
 		//Constructors with initial elements
 		IntersectionBuffer(Intersection i);
 		IntersectionBuffer(Intersection i1, Intersection i2);
 		IntersectionBuffer(Intersection i1, Intersection i2, Intersection i3, Intersection i4);
 
-		IntersectionBuffer() { IsSorted = true; }
+		IntersectionBuffer() { IsSorted = true; count = 0; spilled = false; }
 		~IntersectionBuffer() = default;
 
+		//Buffers can only be moved (Copies of whole buffers are never needed while tracing rays)
+		IntersectionBuffer(const IntersectionBuffer&) = delete;
+		IntersectionBuffer& operator=(const IntersectionBuffer&) = delete;
+		IntersectionBuffer(IntersectionBuffer&& other) noexcept;
+		IntersectionBuffer& operator=(IntersectionBuffer&& other) noexcept;
+
 		//Add one or more intersections
-		void Add(Intersection intersection);
-		void Add(IntersectionBuffer intersections);
+		void Add(const Intersection& intersection);
+		void Add(const IntersectionBuffer& intersections);
 
 		//Access individual intersections
-		Intersection operator[](size_t i) const;
-		size_t GetCount();
-		void Reset() { IsSorted = false; intersections.clear(); }
+		const Intersection& operator[](size_t i) const { return GetData()[i]; }
+		size_t GetCount() const { return count; }
+		//Keeps the memory of the spill-over vector
+		void Reset() { IsSorted = true; count = 0; spilled = false; spilledIntersections.clear(); }
+
+		//True as long as the intersections fit into the inline storage
+		bool IsInline() const { return !spilled; }
 
 		void Sort();
+		//Only sort the intersections with t <= maximumT and move them to the front (The order of the others is undefined)
+		//Returns the number of sorted intersections
+		size_t SortUpTo(Real maximumT);
 
 		//Find the first 'hit' (Intersection with smallest, positive 't value')
-		const Intersection GetFirstHit();
+		//Doesn't sort the buffer
+		const Intersection GetFirstHit() const;
 
 	private:
 		bool IsSorted;
-		std::vector<Intersection> intersections;
+		size_t count;
+
+		Intersection inlineIntersections[InlineCapacity];
+
+		//Used for all intersections once the inline storage is full
+		bool spilled;
+		std::vector<Intersection> spilledIntersections;
+
+		Intersection* GetData() { return spilled ? spilledIntersections.data() : inlineIntersections; }
+		const Intersection* GetData() const { return spilled ? spilledIntersections.data() : inlineIntersections; }
 	};
 
 
-	inline IntersectionBuffer::IntersectionBuffer(Intersection i) : intersections{ i } {
+	inline IntersectionBuffer::IntersectionBuffer(Intersection i) : IntersectionBuffer() {
+		Add(i);
 		IsSorted = true;
 	}
-	inline IntersectionBuffer::IntersectionBuffer(Intersection i1, Intersection i2) : intersections{ i1, i2 } {
-		IsSorted = false;
+	inline IntersectionBuffer::IntersectionBuffer(Intersection i1, Intersection i2) : IntersectionBuffer() {
+		Add(i1);
+		Add(i2);
 	}
 
-	inline IntersectionBuffer::IntersectionBuffer(Intersection i1, Intersection i2, Intersection i3, Intersection i4) : intersections{ i1, i2, i3, i4 } {
-		IsSorted = false;
+	inline IntersectionBuffer::IntersectionBuffer(Intersection i1, Intersection i2, Intersection i3, Intersection i4) : IntersectionBuffer() {
+		Add(i1);
+		Add(i2);
+		Add(i3);
+		Add(i4);
 	}
 
-	inline void IntersectionBuffer::Add(Intersection intersection) {
-		intersections.push_back(intersection);
-
-		//List of intersections is no longer sorted
-		IsSorted = false;
+	inline IntersectionBuffer::IntersectionBuffer(IntersectionBuffer&& other) noexcept : IntersectionBuffer() {
+		*this = std::move(other);
 	}
 
-	inline void IntersectionBuffer::Add(IntersectionBuffer intersections) {
-		size_t count = intersections.GetCount();
+	inline IntersectionBuffer& IntersectionBuffer::operator=(IntersectionBuffer&& other) noexcept {
+		if (this == &other) return *this;
 
-		for (size_t i = 0; i < count; i++) {
-			Add(intersections[i]);
+		IsSorted = other.IsSorted;
+		count = other.count;
+		spilled = other.spilled;
+
+		if (spilled) {
+			spilledIntersections = std::move(other.spilledIntersections);
+		}
+		else {
+			spilledIntersections.clear();
+			std::copy(other.inlineIntersections, other.inlineIntersections + count, inlineIntersections);
 		}
 
+		other.Reset();
+		return *this;
+	}
+
+	inline void IntersectionBuffer::Add(const Intersection& intersection) {
+		if (!spilled) {
+			if (count < InlineCapacity) {
+				inlineIntersections[count] = intersection;
+			}
+			//Inline storage is full -> continue in the vector
+			else {
+				spilledIntersections.assign(inlineIntersections, inlineIntersections + count);
+				spilledIntersections.push_back(intersection);
+				spilled = true;
+			}
+		}
+		else {
+			spilledIntersections.push_back(intersection);
+		}
+
+		count++;
+
 		//List of intersections is no longer sorted
 		IsSorted = false;
 	}
 
-	inline Intersection IntersectionBuffer::operator[] (size_t i) const {
-		return intersections[i];
-	}
+	inline void IntersectionBuffer::Add(const IntersectionBuffer& intersections) {
+		size_t addedCount = intersections.GetCount();
 
-	inline size_t IntersectionBuffer::GetCount() {
-		return intersections.size();
+		for (size_t i = 0; i < addedCount; i++) {
+			Add(intersections[i]);
+		}
 	}
 
 	inline void IntersectionBuffer::Sort() {
 		//Sort the list if it is not already sorted
-		if (!IsSorted) std::sort(intersections.begin(), intersections.end());
+		if (!IsSorted) std::sort(GetData(), GetData() + count);
 		IsSorted = true;
 	}
 
-	inline const Intersection IntersectionBuffer::GetFirstHit() {
-		if (!intersections.size()) return Intersection();
+	inline size_t IntersectionBuffer::SortUpTo(Real maximumT) {
+		if (IsSorted) {
+			return std::upper_bound(GetData(), GetData() + count, maximumT, [](Real t, const Intersection& i) { return t < i.t; }) - GetData();
+		}
 
-		//Sort in ascending order of t
-		Sort();
+		Intersection* end = std::partition(GetData(), GetData() + count, [&](const Intersection& i) { return i.t <= maximumT; });
+		std::sort(GetData(), end);
 
+		IsSorted = (end == GetData() + count);
+		return end - GetData();
+	}
+
+	inline const Intersection IntersectionBuffer::GetFirstHit() const {
 		//Find lowest, non negative t value
-		for (const auto& i : intersections) {
-			if (i.t >= 0.0f) return i;
+		const Intersection* firstHit = nullptr;
+
+		for (const Intersection* i = GetData(); i != GetData() + count; i++) {
+			if (i->t >= 0.0f && (!firstHit || *i < *firstHit)) firstHit = i;
 		}
 
 		//No valid intersection found
-		return Intersection();
+		if (!firstHit) return Intersection();
+
+		return *firstHit;
 	}
 }
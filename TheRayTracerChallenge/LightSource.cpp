@@ -19,7 +19,7 @@ RayTracer::LightSource::~LightSource()
 {
 }
 
-RayTracer::Color RayTracer::LightSource::Lighting(std::shared_ptr<Shape> shape, Point p, Vector eye, Vector normal, bool IsInShadow)
+RayTracer::Color RayTracer::LightSource::Lighting(Shape* shape, Point p, Vector eye, Vector normal, bool IsInShadow)
 {
     Color ambient, diffuse, specular;
 
@@ -35,7 +35,7 @@ RayTracer::Color RayTracer::LightSource::Lighting(std::shared_ptr<Shape> shape,
     Vector lightVector = (position - p).Normalize();
 
     //Cosine of the angle between the light and normal vectors
-	double lightDotNormal = Vector::DotProduct(normal, lightVector);
+	Real lightDotNormal = Vector::DotProduct(normal, lightVector);
 
     //Negative value means the light source is on the other side of the surface
     if (lightDotNormal < 0.0 || IsInShadow) {
@@ -47,15 +47,15 @@ RayTracer::Color RayTracer::LightSource::Lighting(std::shared_ptr<Shape> shape,
         diffuse = effectiveColor * m.diffuse * lightDotNormal;
 
         //Cosine of angle between reflection and eye vectors
-		double reflectDotEye = Vector::DotProduct((-lightVector).Reflect(normal), eye);
+		Real reflectDotEye = Vector::DotProduct((-lightVector).Reflect(normal), eye);
 
         if (reflectDotEye <= 0.0) {
             specular = Color(0.0, 0.0, 0.0);
         }
         else {
             //Specular component
-            double factor = pow(reflectDotEye, m.shininess);
-            specular = intensity * static_cast<double>(m.specular * factor);
+            Real factor = pow(reflectDotEye, m.shininess);
+            specular = intensity * static_cast<Real>(m.specular * factor);
         }
     }
 
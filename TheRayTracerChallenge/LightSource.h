@@ -23,7 +23,7 @@ namespace RayTracer {
 		void SetPosition(Point position) { this->position = position; }
 
 		//Calculate the color of a point when illuminated by this light source
-		Color Lighting(std::shared_ptr<Shape> shape, Point p, Vector eye, Vector normal, bool IsInShadow);
+		Color Lighting(Shape* shape, Point p, Vector eye, Vector normal, bool IsInShadow);
 
 	private:
 		Color intensity;
@@ -0,0 +1,569 @@
+#pragma once
+
+#include "Shape.h"
+#include "BVHBuilder.h"
+#include "BoundingBox.h"
+#include "Vector3.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include "SIMDLanes.h"
+#include "IntersectionBuffer.h"
+#include "RenderContext.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+namespace RayTracer {
+	//Node of a compiled hierarchy (32 bytes, so two nodes fit into a cache line)
+	struct LinearBVHNode {
+		//Bounds stored as floats (Rounded outwards, so the box never shrinks)
+		float minimum[3];
+		float maximum[3];
+
+		//Leaves: index of the first primitive, interior nodes: index of the second child
+		//(The first child of an interior node is always stored directly after it)
+		uint32_t offset;
+		//0 for interior nodes
+		uint32_t primitiveCount;
+
+		bool IsLeaf() const { return primitiveCount != 0; }
+	};
+
+	static_assert(sizeof(LinearBVHNode) == 32, "LinearBVHNode should be 32 bytes");
+
+	//Bounding volume hierarchy compiled into a single array of nodes in depth first order
+	//Primitives are referenced by 32 bit ids and stored as raw pointers, so traversal doesn't touch any reference counts
+	//(The shapes are owned elsewhere and need to outlive the hierarchy)
+	class LinearBVH {
+	public:
+		//Traversal uses a fixed size stack, so the depth of the hierarchy is limited
+		static constexpr size_t MaximumDepth = 64;
+		//Packets that hit a node with fewer rays than this are split into single rays
+		static constexpr size_t MinimumPacketLanes = 4;
+
+		LinearBVH() = default;
+		~LinearBVH() = default;
+
+		//Build the hierarchy for shapes that share one coordinate system (Shapes with infinite bounds are always tested)
+		void Build(const std::vector<Shape*>& shapes, BVHBuildSettings settings = BVHBuildSettings());
+		//Build the hierarchy for primitives that are not shapes (Traverse reports indices into primitiveBounds)
+		void Build(const std::vector<BoundingBox>& primitiveBounds, BVHBuildSettings settings = BVHBuildSettings());
+		//Use nodes of a hierarchy that was built before (e.g. loaded from a file) for primitives that are not shapes
+		//Returns false (and clears the hierarchy) if the nodes don't form a valid hierarchy over primitiveCount primitives
+		bool SetNodes(std::vector<LinearBVHNode> hierarchyNodes, std::vector<uint32_t> hierarchyPrimitiveOrder, size_t primitiveCount);
+		void Clear();
+		bool IsEmpty() const { return nodes.empty() && unboundedPrimitives.empty(); }
+
+		//Find the intersections of all primitives whose bounding boxes are hit by the ray
+		void FindIntersections(const Ray& ray, IntersectionBuffer& buffer, RenderContext& context) const;
+
+		//Check if any primitive is hit at a t in [0.0, maximumT) (Returns at the first hit)
+		bool FindAnyHit(const Ray& ray, Real maximumT, RenderContext& context) const;
+
+		//Find the closest hit with t >= 0.0 in front of closestHit.t (Same rules as Shape::FindClosestHit)
+		bool FindClosestHit(const Ray& ray, Intersection& closestHit, RenderContext& context) const;
+		//FindClosestHit for every active ray of a packet (closestHits is indexed by lane), returns the lanes whose hit was replaced
+		RayPacket::LaneMask FindClosestHits(const RayPacket& packet, Intersection closestHits[], RenderContext& context) const;
+
+		//Call visitPrimitive(primitiveId) for every bounded primitive whose leaf is hit by the ray within [tMin, tMax]
+		//(primitiveId: Index of the primitive in the list the hierarchy was built from, without unbounded shapes)
+		//Children are visited front to back. tMax is read again after every primitive, so visitors can shrink it
+		//Traversal stops as soon as visitPrimitive returns true
+		template<typename PrimitiveFunction>
+		void Traverse(const Ray& ray, Real tMin, const Real& tMax, PrimitiveFunction&& visitPrimitive) const;
+
+		//Same as Traverse, but calls visitLeaf(nodeIndex, node) once per leaf instead of once per primitive
+		//(The leaf's primitives are GetPrimitiveOrder()[node.offset] to GetPrimitiveOrder()[node.offset + node.primitiveCount - 1])
+		template<typename LeafFunction>
+		void TraverseLeaves(const Ray& ray, Real tMin, const Real& tMax, LeafFunction&& visitLeaf) const;
+
+		//Traverse with all active rays of a packet at once: each node is tested against every ray and only left when no ray hits it
+		//visitLeaf(nodeIndex, node, lanes) is called with the rays that hit the leaf. tMax is indexed by lane (32 byte aligned) and read again after every leaf
+		//Once fewer than MinimumPacketLanes rays hit a node, each of them traverses the node's subtree on its own (Same leaves as TraverseLeaves)
+		template<typename LeafFunction>
+		void TraversePacket(const RayPacket& packet, Real tMin, const Real* tMax, LeafFunction&& visitLeaf) const;
+
+		const std::vector<LinearBVHNode>& GetNodes() const { return nodes; }
+		const std::vector<uint32_t>& GetPrimitiveOrder() const { return primitiveOrder; }
+		Shape* GetPrimitive(uint32_t primitiveId) const { return primitives[primitiveId]; }
+		size_t GetPrimitiveCount() const { return primitiveOrder.size(); }
+		size_t GetUnboundedPrimitiveCount() const { return unboundedPrimitives.size(); }
+
+	private:
+		std::vector<LinearBVHNode> nodes;
+
+		//Primitive ids sorted, so every leaf references a contiguous range
+		std::vector<uint32_t> primitiveOrder;
+
+		//Shapes with finite bounds (Indexed by primitive id) and shapes that are always tested
+		std::vector<Shape*> primitives;
+		std::vector<Shape*> unboundedPrimitives;
+
+		//Relative error of the exit distance of a slab: 2 * gamma(3) with gamma(n) = n * u / (1 - n * u)
+		static constexpr Real RoundingUnit = std::numeric_limits<Real>::epsilon() / 2;
+		static constexpr Real FarErrorBound = 2 * (3 * RoundingUnit / (1 - 3 * RoundingUnit));
+
+		static float RoundDown(Real value);
+		static float RoundUp(Real value);
+
+		//Slab test against the float bounds of a node (entryT: first t inside of the node)
+		static bool IntersectsNode(const LinearBVHNode& node, const Point3& origin, const Vec3& inverseDirection, Real tMin, Real tMax, Real& entryT);
+		//The same test for all lanes of a packet (Returns the lanes that hit the node, nearestEntryT: smallest entryT of these lanes)
+		static RayPacket::LaneMask IntersectsNode(const LinearBVHNode& node, const RayPacket& packet, RayPacket::LaneMask lanes, Real tMin, const Real* tMax, Real& nearestEntryT);
+
+		//TraverseLeaves starting at any node instead of the root
+		template<typename LeafFunction>
+		void TraverseSubtree(uint32_t rootIndex, const Ray& ray, Real tMin, const Real& tMax, LeafFunction&& visitLeaf) const;
+	};
+
+
+	inline void LinearBVH::Build(const std::vector<Shape*>& shapes, BVHBuildSettings settings) {
+		std::vector<Shape*> boundedShapes, unboundedShapes;
+		std::vector<BoundingBox> shapeBounds;
+
+		for (auto shape : shapes) {
+			auto box = shape->GetParentSpaceBounds();
+
+			if (box.IsEmpty()) continue;
+
+			if (std::isfinite(box.SurfaceArea())) {
+				boundedShapes.push_back(shape);
+				shapeBounds.push_back(box);
+			}
+			else {
+				unboundedShapes.push_back(shape);
+			}
+		}
+
+		Build(shapeBounds, settings);
+
+		primitives = std::move(boundedShapes);
+		unboundedPrimitives = std::move(unboundedShapes);
+	}
+
+	inline void LinearBVH::Build(const std::vector<BoundingBox>& primitiveBounds, BVHBuildSettings settings) {
+		Clear();
+
+		if (primitiveBounds.empty()) return;
+
+		//Deeper hierarchies wouldn't fit into the traversal stack
+		settings.maximumDepth = std::min(settings.maximumDepth, MaximumDepth);
+
+		BVHBuilder builder(settings);
+		builder.Build(primitiveBounds);
+
+		primitiveOrder.reserve(primitiveBounds.size());
+		for (size_t primitive : builder.GetPrimitiveOrder()) {
+			primitiveOrder.push_back(static_cast<uint32_t>(primitive));
+		}
+
+		//The builder already stores the nodes in depth first order
+		nodes.reserve(builder.GetNodes().size());
+
+		for (const auto& builderNode : builder.GetNodes()) {
+			LinearBVHNode node;
+			Point minimum = builderNode.bounds.GetMin();
+			Point maximum = builderNode.bounds.GetMax();
+
+			node.minimum[0] = RoundDown(minimum.x);
+			node.minimum[1] = RoundDown(minimum.y);
+			node.minimum[2] = RoundDown(minimum.z);
+			node.maximum[0] = RoundUp(maximum.x);
+			node.maximum[1] = RoundUp(maximum.y);
+			node.maximum[2] = RoundUp(maximum.z);
+
+			if (builderNode.IsLeaf()) {
+				node.offset = static_cast<uint32_t>(builderNode.firstPrimitive);
+				node.primitiveCount = static_cast<uint32_t>(builderNode.primitiveCount);
+			}
+			else {
+				node.offset = static_cast<uint32_t>(builderNode.rightChild);
+				node.primitiveCount = 0;
+			}
+
+			nodes.push_back(node);
+		}
+	}
+
+	inline bool LinearBVH::SetNodes(std::vector<LinearBVHNode> hierarchyNodes, std::vector<uint32_t> hierarchyPrimitiveOrder, size_t primitiveCount) {
+		Clear();
+
+		//Every primitive is referenced once
+		if (hierarchyPrimitiveOrder.size() != primitiveCount) return false;
+		if (hierarchyNodes.empty()) return primitiveCount == 0;
+
+		for (uint32_t primitive : hierarchyPrimitiveOrder) {
+			if (primitive >= primitiveCount) return false;
+		}
+
+		//Children are always stored after their parent, so the depth of a node is known before it is reached
+		std::vector<uint8_t> depth(hierarchyNodes.size(), 0);
+		depth[0] = 1;
+
+		for (size_t index = 0; index < hierarchyNodes.size(); index++) {
+			const LinearBVHNode& node = hierarchyNodes[index];
+
+			//Every node needs to be reachable from the root
+			if (depth[index] == 0) return false;
+
+			if (node.IsLeaf()) {
+				if (static_cast<size_t>(node.offset) + node.primitiveCount > hierarchyPrimitiveOrder.size()) return false;
+			}
+			else {
+				//Deeper hierarchies wouldn't fit into the traversal stack
+				if (depth[index] >= MaximumDepth) return false;
+				if (node.offset <= index + 1 || node.offset >= hierarchyNodes.size()) return false;
+
+				depth[index + 1] = depth[index] + 1;
+				depth[node.offset] = depth[index] + 1;
+			}
+		}
+
+		nodes = std::move(hierarchyNodes);
+		primitiveOrder = std::move(hierarchyPrimitiveOrder);
+		return true;
+	}
+
+	inline void LinearBVH::Clear() {
+		nodes.clear();
+		primitiveOrder.clear();
+		primitives.clear();
+		unboundedPrimitives.clear();
+	}
+
+	inline void LinearBVH::FindIntersections(const Ray& ray, IntersectionBuffer& buffer, RenderContext& context) const {
+		for (auto shape : unboundedPrimitives) {
+			shape->FindIntersections(ray, buffer, context);
+		}
+
+		//Intersections behind the origin are needed to find refractive indices -> the whole line is searched
+		constexpr Real infinity = std::numeric_limits<Real>::infinity();
+		const Real maximumT = infinity;
+
+		Traverse(ray, -infinity, maximumT, [&](uint32_t primitiveId) {
+			primitives[primitiveId]->FindIntersections(ray, buffer, context);
+			return false;
+		});
+	}
+
+	inline bool LinearBVH::FindAnyHit(const Ray& ray, Real maximumT, RenderContext& context) const {
+		for (auto shape : unboundedPrimitives) {
+			if (shape->FindAnyHit(ray, maximumT, context)) return true;
+		}
+
+		bool hit = false;
+
+		Traverse(ray, 0.0, maximumT, [&](uint32_t primitiveId) {
+			hit = primitives[primitiveId]->FindAnyHit(ray, maximumT, context);
+			return hit;
+		});
+
+		return hit;
+	}
+
+	inline bool LinearBVH::FindClosestHit(const Ray& ray, Intersection& closestHit, RenderContext& context) const {
+		bool found = false;
+
+		for (auto shape : unboundedPrimitives) {
+			if (shape->FindClosestHit(ray, closestHit, context)) found = true;
+		}
+
+		//Shrinks whenever a closer hit is found, so farther nodes are skipped
+		Real maximumT = closestHit.t;
+
+		Traverse(ray, 0.0, maximumT, [&](uint32_t primitiveId) {
+			if (primitives[primitiveId]->FindClosestHit(ray, closestHit, context)) {
+				found = true;
+				maximumT = closestHit.t;
+			}
+			return false;
+		});
+
+		return found;
+	}
+
+	inline RayPacket::LaneMask LinearBVH::FindClosestHits(const RayPacket& packet, Intersection closestHits[], RenderContext& context) const {
+		RayPacket::LaneMask found = 0;
+		alignas(32) Real maximumT[RayPacket::Size] = {};
+
+		for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+			if (!RayPacket::IsActive(packet.activeLanes, lane)) continue;
+
+			for (auto shape : unboundedPrimitives) {
+				if (shape->FindClosestHit(packet.rays[lane], closestHits[lane], context)) found |= RayPacket::LaneMask(1) << lane;
+			}
+
+			maximumT[lane] = closestHits[lane].t;
+		}
+
+		TraversePacket(packet, 0.0, maximumT, [&](uint32_t, const LinearBVHNode& node, RayPacket::LaneMask lanes) {
+			for (uint32_t index = node.offset; index < node.offset + node.primitiveCount; index++) {
+				Shape* primitive = primitives[primitiveOrder[index]];
+
+				for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+					if (!RayPacket::IsActive(lanes, lane)) continue;
+
+					if (primitive->FindClosestHit(packet.rays[lane], closestHits[lane], context)) {
+						found |= RayPacket::LaneMask(1) << lane;
+						maximumT[lane] = closestHits[lane].t;
+					}
+				}
+			}
+		});
+
+		return found;
+	}
+
+	template<typename PrimitiveFunction>
+	inline void LinearBVH::Traverse(const Ray& ray, Real tMin, const Real& tMax, PrimitiveFunction&& visitPrimitive) const {
+		TraverseLeaves(ray, tMin, tMax, [&](uint32_t, const LinearBVHNode& node) {
+			for (uint32_t index = node.offset; index < node.offset + node.primitiveCount; index++) {
+				if (visitPrimitive(primitiveOrder[index])) return true;
+			}
+			return false;
+		});
+	}
+
+	template<typename LeafFunction>
+	inline void LinearBVH::TraverseLeaves(const Ray& ray, Real tMin, const Real& tMax, LeafFunction&& visitLeaf) const {
+		if (nodes.empty()) return;
+
+		TraverseSubtree(0, ray, tMin, tMax, visitLeaf);
+	}
+
+	template<typename LeafFunction>
+	inline void LinearBVH::TraversePacket(const RayPacket& packet, Real tMin, const Real* tMax, LeafFunction&& visitLeaf) const {
+		if (nodes.empty()) return;
+
+		Real entryT;
+		RayPacket::LaneMask lanes = IntersectsNode(nodes[0], packet, packet.activeLanes, tMin, tMax, entryT);
+		if (lanes == 0) return;
+
+		//Farther children that still need to be visited and the rays that hit them
+		struct StackEntry {
+			uint32_t nodeIndex;
+			RayPacket::LaneMask lanes;
+		};
+		StackEntry stack[MaximumDepth];
+		size_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+
+		while (true) {
+			const LinearBVHNode& node = nodes[nodeIndex];
+
+			if (RayPacket::CountLanes(lanes) < MinimumPacketLanes) {
+				//The rays went different ways, testing boxes for the whole packet would be wasted on the other lanes
+				for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+					if (!RayPacket::IsActive(lanes, lane)) continue;
+
+					TraverseSubtree(nodeIndex, packet.rays[lane], tMin, tMax[lane], [&](uint32_t leafIndex, const LinearBVHNode& leaf) {
+						visitLeaf(leafIndex, leaf, RayPacket::LaneMask(1) << lane);
+						return false;
+					});
+				}
+			}
+			else if (node.IsLeaf()) {
+				visitLeaf(nodeIndex, node, lanes);
+			}
+			else {
+				uint32_t firstChild = nodeIndex + 1;
+				uint32_t secondChild = node.offset;
+				Real firstEntryT, secondEntryT;
+
+				RayPacket::LaneMask firstLanes = IntersectsNode(nodes[firstChild], packet, lanes, tMin, tMax, firstEntryT);
+				RayPacket::LaneMask secondLanes = IntersectsNode(nodes[secondChild], packet, lanes, tMin, tMax, secondEntryT);
+
+				if (firstLanes != 0 && secondLanes != 0) {
+					//Coherent rays mostly agree on the order, so the child that is entered first by any ray is visited first
+					if (secondEntryT < firstEntryT) {
+						std::swap(firstChild, secondChild);
+						std::swap(firstLanes, secondLanes);
+					}
+
+					stack[stackSize++] = { secondChild, secondLanes };
+					nodeIndex = firstChild;
+					lanes = firstLanes;
+					continue;
+				}
+				else if (firstLanes != 0 || secondLanes != 0) {
+					nodeIndex = (firstLanes != 0) ? firstChild : secondChild;
+					lanes = firstLanes | secondLanes;
+					continue;
+				}
+			}
+
+			//Hits found since the node was pushed may cull some of its rays, so it is tested again
+			do {
+				if (stackSize == 0) return;
+				stackSize--;
+
+				nodeIndex = stack[stackSize].nodeIndex;
+				lanes = IntersectsNode(nodes[nodeIndex], packet, stack[stackSize].lanes, tMin, tMax, entryT);
+			} while (lanes == 0);
+		}
+	}
+
+	template<typename LeafFunction>
+	inline void LinearBVH::TraverseSubtree(uint32_t rootIndex, const Ray& ray, Real tMin, const Real& tMax, LeafFunction&& visitLeaf) const {
+		Point3 origin(ray.origin);
+		//Infinite for rays parallel to an axis (Handled separately by the slab test)
+		Vec3 inverseDirection(1.0 / ray.direction.x, 1.0 / ray.direction.y, 1.0 / ray.direction.z);
+
+		Real entryT;
+		if (!IntersectsNode(nodes[rootIndex], origin, inverseDirection, tMin, tMax, entryT)) return;
+
+		//Farther children that still need to be visited and the t at which the ray enters them
+		struct StackEntry {
+			uint32_t nodeIndex;
+			Real entryT;
+		};
+		StackEntry stack[MaximumDepth];
+		size_t stackSize = 0;
+		uint32_t nodeIndex = rootIndex;
+
+		while (true) {
+			const LinearBVHNode& node = nodes[nodeIndex];
+
+			if (node.IsLeaf()) {
+				if (visitLeaf(nodeIndex, node)) return;
+			}
+			else {
+				uint32_t firstChild = nodeIndex + 1;
+				uint32_t secondChild = node.offset;
+				Real firstEntryT, secondEntryT;
+
+				bool firstHit = IntersectsNode(nodes[firstChild], origin, inverseDirection, tMin, tMax, firstEntryT);
+				bool secondHit = IntersectsNode(nodes[secondChild], origin, inverseDirection, tMin, tMax, secondEntryT);
+
+				if (firstHit && secondHit) {
+					//Visit the nearer child first, hits found in it may make the other one unnecessary
+					if (secondEntryT < firstEntryT) {
+						std::swap(firstChild, secondChild);
+						std::swap(firstEntryT, secondEntryT);
+					}
+
+					stack[stackSize++] = { secondChild, secondEntryT };
+					nodeIndex = firstChild;
+					continue;
+				}
+				else if (firstHit || secondHit) {
+					nodeIndex = firstHit ? firstChild : secondChild;
+					continue;
+				}
+			}
+
+			//Skip nodes that are entered behind the closest hit found so far
+			do {
+				if (stackSize == 0) return;
+				stackSize--;
+			} while (stack[stackSize].entryT > tMax);
+
+			nodeIndex = stack[stackSize].nodeIndex;
+		}
+	}
+
+	inline bool LinearBVH::IntersectsNode(const LinearBVHNode& node, const Point3& origin, const Vec3& inverseDirection, Real tMin, Real tMax, Real& entryT) {
+		for (size_t axis = 0; axis < 3; axis++) {
+			//Parallel to the slab: either always or never inside of it (Avoids 0.0 * infinity for rays that start on a face)
+			if (std::isinf(inverseDirection[axis])) {
+				if (origin[axis] < node.minimum[axis] || origin[axis] > node.maximum[axis]) return false;
+				continue;
+			}
+
+			Real t1 = (static_cast<Real>(node.minimum[axis]) - origin[axis]) * inverseDirection[axis];
+			Real t2 = (static_cast<Real>(node.maximum[axis]) - origin[axis]) * inverseDirection[axis];
+
+			if (t1 > t2) std::swap(t1, t2);
+			//Rounding errors could otherwise make rays miss boxes they touch (e.g. at a vertex shared by watertight triangles)
+			//Ize: "Robust BVH Ray Traversal" (2013)
+			t2 += std::fabs(t2) * FarErrorBound;
+
+			if (t1 > tMin) tMin = t1;
+			if (t2 < tMax) tMax = t2;
+
+			if (tMin > tMax) return false;
+		}
+
+		entryT = tMin;
+		return true;
+	}
+
+	inline RayPacket::LaneMask LinearBVH::IntersectsNode(const LinearBVHNode& node, const RayPacket& packet, RayPacket::LaneMask lanes, Real tMin, const Real* tMax, Real& nearestEntryT) {
+		using Lanes = SIMDLanes::Default;
+		using Value = Lanes::Value;
+		using Mask = Lanes::Mask;
+
+		constexpr Real infinity = std::numeric_limits<Real>::infinity();
+		constexpr RayPacket::LaneMask groupLanes = (RayPacket::LaneMask(1) << Lanes::Count) - 1;
+
+		const Value positiveInfinity = Lanes::Broadcast(infinity);
+		const Value negativeInfinity = Lanes::Broadcast(-infinity);
+		const Value errorBound = Lanes::Broadcast(FarErrorBound);
+
+		Value minimum[3], maximum[3];
+		for (size_t axis = 0; axis < 3; axis++) {
+			minimum[axis] = Lanes::Broadcast(node.minimum[axis]);
+			maximum[axis] = Lanes::Broadcast(node.maximum[axis]);
+		}
+
+		alignas(32) Real entryT[RayPacket::Size];
+		RayPacket::LaneMask hits = 0;
+
+		for (size_t first = 0; first < RayPacket::Size; first += Lanes::Count) {
+			if (((lanes >> first) & groupLanes) == 0) continue;
+
+			bool anyParallel = ((packet.parallelLanes >> first) & groupLanes) != 0;
+			Value entry = Lanes::Broadcast(tMin);
+			Value exit = Lanes::Load(tMax + first);
+
+			//Same operations as the single ray test, so every ray hits exactly the same nodes
+			for (size_t axis = 0; axis < 3; axis++) {
+				Value origin = Lanes::Load(packet.origin[axis] + first);
+				Value inverseDirection = Lanes::Load(packet.inverseDirection[axis] + first);
+
+				Value t1 = Lanes::Mul(Lanes::Sub(minimum[axis], origin), inverseDirection);
+				Value t2 = Lanes::Mul(Lanes::Sub(maximum[axis], origin), inverseDirection);
+
+				Value nearT = Lanes::Min(t1, t2);
+				Value farT = Lanes::Max(t1, t2);
+				farT = Lanes::Add(farT, Lanes::Mul(Lanes::Abs(farT), errorBound));
+
+				//Parallel to the slab: either always or never inside of it (t1 and t2 may be NaN)
+				if (anyParallel) {
+					Mask parallel = Lanes::AbsGreaterEqual(inverseDirection, positiveInfinity);
+					Mask insideSlab = Lanes::And(Lanes::GreaterEqual(origin, minimum[axis]), Lanes::LessEqual(origin, maximum[axis]));
+					nearT = Lanes::Select(parallel, Lanes::Select(insideSlab, negativeInfinity, positiveInfinity), nearT);
+					farT = Lanes::Select(parallel, Lanes::Select(insideSlab, positiveInfinity, negativeInfinity), farT);
+				}
+
+				entry = Lanes::Max(nearT, entry);
+				exit = Lanes::Min(farT, exit);
+			}
+
+			Lanes::Store(entryT + first, entry);
+			hits |= static_cast<RayPacket::LaneMask>(Lanes::ToBits(Lanes::LessEqual(entry, exit))) << first;
+		}
+
+		hits &= lanes;
+		nearestEntryT = infinity;
+
+		for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+			if (RayPacket::IsActive(hits, lane) && entryT[lane] < nearestEntryT) nearestEntryT = entryT[lane];
+		}
+
+		return hits;
+	}
+
+	inline float LinearBVH::RoundDown(Real value) {
+		float result = static_cast<float>(value);
+		if (static_cast<Real>(result) > value) result = std::nextafter(result, -std::numeric_limits<float>::infinity());
+		return result;
+	}
+
+	inline float LinearBVH::RoundUp(Real value) {
+		float result = static_cast<float>(value);
+		if (static_cast<Real>(result) < value) result = std::nextafter(result, std::numeric_limits<float>::infinity());
+		return result;
+	}
+}
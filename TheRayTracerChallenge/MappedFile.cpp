@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool RayTracer::MappedFile::Open(const std::string& fileName)
+{
+	Close();
+
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	size = static_cast<size_t>(fileSize.QuadPart);
+	isOpen = true;
+
+	//Empty files can't be mapped
+	if (size == 0) return true;
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		Close();
+		return false;
+	}
+	mappingHandle = mapping;
+
+	data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr) {
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void RayTracer::MappedFile::Close()
+{
+	if (data != nullptr) UnmapViewOfFile(data);
+	if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+	if (fileHandle != nullptr) CloseHandle(fileHandle);
+
+	data = nullptr;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+	size = 0;
+	isOpen = false;
+}
+
+#else
+
+bool RayTracer::MappedFile::Open(const std::string& fileName)
+{
+	Close();
+
+	int file = open(fileName.c_str(), O_RDONLY);
+	if (file < 0) return false;
+
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0) {
+		close(file);
+		return false;
+	}
+
+	fileDescriptor = file;
+	size = static_cast<size_t>(fileStatus.st_size);
+	isOpen = true;
+
+	//Empty files can't be mapped
+	if (size == 0) return true;
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	if (mapping == MAP_FAILED) {
+		Close();
+		return false;
+	}
+
+	//The file is read from front to back
+	madvise(mapping, size, MADV_SEQUENTIAL);
+
+	data = static_cast<const char*>(mapping);
+	return true;
+}
+
+void RayTracer::MappedFile::Close()
+{
+	if (data != nullptr) munmap(const_cast<char*>(data), size);
+	if (fileDescriptor >= 0) close(fileDescriptor);
+
+	data = nullptr;
+	fileDescriptor = -1;
+	size = 0;
+	isOpen = false;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace RayTracer {
+	//Read only view of a whole file that is mapped into memory (Pages are loaded by the OS when they are accessed)
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+
+		//Owns the mapping
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& fileName);
+		void Close();
+
+		bool IsOpen() const { return isOpen; }
+
+		//nullptr for empty files
+		const char* GetData() const { return data; }
+		size_t GetSize() const { return size; }
+
+	private:
+		bool isOpen = false;
+		const char* data = nullptr;
+		size_t size = 0;
+
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#else
+		int fileDescriptor = -1;
+#endif
+	};
+}
@@ -14,15 +14,15 @@ namespace RayTracer {
 		std::shared_ptr<Pattern> pattern;
 
 		//Lighting properties
-		double ambient;
-		double diffuse;
-		double specular;
-		double shininess;
+		Real ambient;
+		Real diffuse;
+		Real specular;
+		Real shininess;
 
 		//Reflection and refraction
-		double reflective;
-		double transparency;
-		double refractiveIndex;
+		Real reflective;
+		Real transparency;
+		Real refractiveIndex;
 
 		Material();
 		~Material() = default;
@@ -8,10 +8,10 @@ namespace RayTracer {
 	template <size_t nRows, size_t nColumns> class MatrixTemplate {
 	public:
 		//The matrix's dimensions
-		const double rows = nRows, columns = nColumns;
+		const Real rows = nRows, columns = nColumns;
 
 		//All stored values
-		std::array<std::array<double, nColumns>, nRows> elements;
+		std::array<std::array<Real, nColumns>, nRows> elements;
 
 		MatrixTemplate() {
 			for (size_t row = 0; row < rows; row++) {
@@ -20,6 +20,7 @@ namespace RayTracer {
 				}
 			}
 		}
+		MatrixTemplate(const MatrixTemplate<nRows, nColumns>& matrix) = default;
 		~MatrixTemplate() = default;
 
 		//Creating a smaller matrix by removing a row and a column
@@ -85,14 +86,14 @@ namespace RayTracer {
 
 
 		//Minor
-		inline double Minor(size_t row, size_t column) {
+		inline Real Minor(size_t row, size_t column) {
 			auto submatrix = Submatrix(row, column);
 			return submatrix.Determinant();
 		}
 
 		//Cofactor
-		inline double Cofactor(size_t row, size_t column) {
-			double minor = Minor(row, column);
+		inline Real Cofactor(size_t row, size_t column) {
+			Real minor = Minor(row, column);
 
 			//The sign needs to be switched if row + column is an odd number
 			return ((row + column) % 2 != 0) ?
@@ -101,8 +102,8 @@ namespace RayTracer {
 		}
 
 		//Determinant of a matrix of any size
-		inline double Determinant() {
-			double determinant = 0.0f;
+		inline Real Determinant() {
+			Real determinant = 0.0f;
 
 			for (size_t column = 0; column < columns; column++) {
 				determinant += elements[0][column] * Cofactor(0, column);
@@ -116,7 +117,7 @@ namespace RayTracer {
 		}
 
 		inline MatrixTemplate<nRows, nColumns> Inversion() {
-			double det = Determinant();
+			Real det = Determinant();
 
 			if (Constants::DoubleEqual(det, 0.0f)) {
 				std::cerr << "Matrix not invertible\n";
@@ -130,7 +131,7 @@ namespace RayTracer {
 
 			for (size_t row = 0; row < rows; row++) {
 				for (size_t column = 0; column < columns; column++) {
-					double c = Cofactor(row, column);
+					Real c = Cofactor(row, column);
 
 					//switching column and row accomplishes the transpose operation
 					inversion.elements[column][row] = c / det;
@@ -149,8 +150,8 @@ namespace RayTracer {
 	namespace Matrix {
 
 		//Initializing a 2x2 matrix
-		inline Matrix2x2 Create(double a, double b,
-			double c, double d) {
+		inline Matrix2x2 Create(Real a, Real b,
+			Real c, Real d) {
 
 			Matrix2x2 matrix;
 
@@ -161,9 +162,9 @@ namespace RayTracer {
 		}
 
 		//Initializing a 3x3 matrix
-		inline Matrix3x3 Create(double a, double b, double c,
-			double d, double e, double f,
-			double g, double h, double i) {
+		inline Matrix3x3 Create(Real a, Real b, Real c,
+			Real d, Real e, Real f,
+			Real g, Real h, Real i) {
 
 			Matrix3x3 matrix;
 
@@ -175,10 +176,10 @@ namespace RayTracer {
 		}
 
 		//Initializing a 4x4 matrix
-		inline Matrix4x4 Create(double a, double b, double c, double d,
-			double e, double f, double g, double h,
-			double i, double j, double k, double l,
-			double m, double n, double o, double p) {
+		inline Matrix4x4 Create(Real a, Real b, Real c, Real d,
+			Real e, Real f, Real g, Real h,
+			Real i, Real j, Real k, Real l,
+			Real m, Real n, Real o, Real p) {
 
 			Matrix4x4 matrix;
 
@@ -240,7 +241,7 @@ namespace RayTracer {
 
 	//Template specialization for 2x2 matrices
 	template <>
-	inline double MatrixTemplate<2, 2>::Determinant() {
+	inline Real MatrixTemplate<2, 2>::Determinant() {
 		return elements[0][0] * elements[1][1] - elements[1][0] * elements[0][1];
 	}
 
@@ -251,22 +252,22 @@ namespace RayTracer {
 		//Source: https://stackoverflow.com/questions/2624422/efficient-4x4-matrix-inverse-affine-transform (Adapted to c++)
 
 
-		double s0 = elements[0][0] * elements[1][1] - elements[1][0] * elements[0][1];
-		double s1 = elements[0][0] * elements[1][2] - elements[1][0] * elements[0][2];
-		double s2 = elements[0][0] * elements[1][3] - elements[1][0] * elements[0][3];
-		double s3 = elements[0][1] * elements[1][2] - elements[1][1] * elements[0][2];
-		double s4 = elements[0][1] * elements[1][3] - elements[1][1] * elements[0][3];
-		double s5 = elements[0][2] * elements[1][3] - elements[1][2] * elements[0][3];
+		Real s0 = elements[0][0] * elements[1][1] - elements[1][0] * elements[0][1];
+		Real s1 = elements[0][0] * elements[1][2] - elements[1][0] * elements[0][2];
+		Real s2 = elements[0][0] * elements[1][3] - elements[1][0] * elements[0][3];
+		Real s3 = elements[0][1] * elements[1][2] - elements[1][1] * elements[0][2];
+		Real s4 = elements[0][1] * elements[1][3] - elements[1][1] * elements[0][3];
+		Real s5 = elements[0][2] * elements[1][3] - elements[1][2] * elements[0][3];
 
-		double c5 = elements[2][2] * elements[3][3] - elements[3][2] * elements[2][3];
-		double c4 = elements[2][1] * elements[3][3] - elements[3][1] * elements[2][3];
-		double c3 = elements[2][1] * elements[3][2] - elements[3][1] * elements[2][2];
-		double c2 = elements[2][0] * elements[3][3] - elements[3][0] * elements[2][3];
-		double c1 = elements[2][0] * elements[3][2] - elements[3][0] * elements[2][2];
-		double c0 = elements[2][0] * elements[3][1] - elements[3][0] * elements[2][1];
+		Real c5 = elements[2][2] * elements[3][3] - elements[3][2] * elements[2][3];
+		Real c4 = elements[2][1] * elements[3][3] - elements[3][1] * elements[2][3];
+		Real c3 = elements[2][1] * elements[3][2] - elements[3][1] * elements[2][2];
+		Real c2 = elements[2][0] * elements[3][3] - elements[3][0] * elements[2][3];
+		Real c1 = elements[2][0] * elements[3][2] - elements[3][0] * elements[2][2];
+		Real c0 = elements[2][0] * elements[3][1] - elements[3][0] * elements[2][1];
 
 
-		double det = (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+		Real det = (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
 
 		//Not invertible
 		if (Constants::DoubleEqual(det, 0.0f)) {
@@ -274,7 +275,7 @@ namespace RayTracer {
 			return Matrix4x4();
 		}
 
-		double invdet = 1.0f / det;
+		Real invdet = 1.0f / det;
 
 
 		return Matrix::Create(
@@ -0,0 +1,157 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+namespace {
+	//Append the elements of an array and pad it to 8 bytes
+	template<typename T>
+	void WriteArray(std::ofstream& file, const std::vector<T>& values) {
+		size_t bytes = values.size() * sizeof(T);
+		if (bytes != 0) file.write(reinterpret_cast<const char*>(values.data()), bytes);
+
+		const char padding[8] = {};
+		size_t paddingBytes = ((bytes + 7) & ~static_cast<size_t>(7)) - bytes;
+		if (paddingBytes != 0) file.write(padding, paddingBytes);
+	}
+
+	//Copy count elements from position and move position behind the padded array
+	template<typename T>
+	void ReadArray(const char*& position, uint64_t count, std::vector<T>& values) {
+		size_t bytes = static_cast<size_t>(count) * sizeof(T);
+
+		values.resize(static_cast<size_t>(count));
+		if (bytes != 0) std::memcpy(values.data(), position, bytes);
+
+		position += (bytes + 7) & ~static_cast<size_t>(7);
+	}
+}
+
+uint64_t RayTracer::MeshCache::ComputeChecksum(const char* data, size_t length)
+{
+	const uint64_t prime = 0x100000001B3ULL;
+	uint64_t hash = 0xCBF29CE484222325ULL;
+
+	size_t wordCount = length / 8;
+	for (size_t index = 0; index < wordCount; index++) {
+		uint64_t word;
+		std::memcpy(&word, data + index * 8, 8);
+
+		hash ^= word;
+		hash *= prime;
+	}
+
+	//Remaining bytes
+	for (size_t index = wordCount * 8; index < length; index++) {
+		hash ^= static_cast<unsigned char>(data[index]);
+		hash *= prime;
+	}
+
+	return hash;
+}
+
+bool RayTracer::MeshCache::Write(const std::string& fileName, TriangleMesh& mesh, uint64_t sourceChecksum, uint64_t sourceSize)
+{
+	mesh.BuildAccelerationStructure();
+
+	const MeshData& data = mesh.GetData();
+	const LinearBVH& hierarchy = mesh.GetAccelerationStructure();
+
+	Header header;
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.headerSize = sizeof(Header);
+	header.realSize = sizeof(Real);
+	header.reserved = 0;
+	header.sourceChecksum = sourceChecksum;
+	header.sourceSize = sourceSize;
+	header.positionCount = data.positions.size();
+	header.normalCount = data.normals.size();
+	header.vertexIndexCount = data.vertexIndices.size();
+	header.normalIndexCount = data.normalIndices.size();
+	header.nodeCount = hierarchy.GetNodes().size();
+	header.primitiveOrderCount = hierarchy.GetPrimitiveOrder().size();
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) return false;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	WriteArray(file, data.positions);
+	WriteArray(file, data.normals);
+	WriteArray(file, data.vertexIndices);
+	WriteArray(file, data.normalIndices);
+	WriteArray(file, hierarchy.GetNodes());
+	WriteArray(file, hierarchy.GetPrimitiveOrder());
+
+	file.close();
+
+	//Don't leave incomplete files behind
+	if (file.fail()) {
+		std::remove(fileName.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+std::shared_ptr<RayTracer::TriangleMesh> RayTracer::MeshCache::Read(const std::string& fileName, uint64_t sourceChecksum, uint64_t sourceSize)
+{
+	MappedFile file;
+	if (!file.Open(fileName) || file.GetSize() < sizeof(Header)) return nullptr;
+
+	Header header;
+	std::memcpy(&header, file.GetData(), sizeof(Header));
+
+	if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) return nullptr;
+	if (header.version != Version || header.headerSize != sizeof(Header) || header.realSize != sizeof(Real)) return nullptr;
+	if (header.sourceChecksum != sourceChecksum || header.sourceSize != sourceSize) return nullptr;
+
+	//Checked one array at a time, so the sum can't overflow
+	uint64_t expectedSize = sizeof(Header);
+	uint64_t arrays[][2] = {
+		{ header.positionCount, sizeof(Real) },
+		{ header.normalCount, sizeof(Real) },
+		{ header.vertexIndexCount, sizeof(uint32_t) },
+		{ header.normalIndexCount, sizeof(uint32_t) },
+		{ header.nodeCount, sizeof(LinearBVHNode) },
+		{ header.primitiveOrderCount, sizeof(uint32_t) }
+	};
+
+	for (auto& array : arrays) {
+		if (array[0] > file.GetSize() / array[1]) return nullptr;
+		expectedSize += PaddedSize(static_cast<size_t>(array[0] * array[1]));
+		if (expectedSize > file.GetSize()) return nullptr;
+	}
+
+	if (expectedSize != file.GetSize()) return nullptr;
+
+	MeshData data;
+	std::vector<LinearBVHNode> nodes;
+	std::vector<uint32_t> primitiveOrder;
+
+	const char* position = file.GetData() + sizeof(Header);
+	ReadArray(position, header.positionCount, data.positions);
+	ReadArray(position, header.normalCount, data.normals);
+	ReadArray(position, header.vertexIndexCount, data.vertexIndices);
+	ReadArray(position, header.normalIndexCount, data.normalIndices);
+	ReadArray(position, header.nodeCount, nodes);
+	ReadArray(position, header.primitiveOrderCount, primitiveOrder);
+
+	//Damaged files must not lead to out of bounds accesses
+	if (data.positions.size() % 3 != 0 || data.normals.size() % 3 != 0 || data.vertexIndices.size() % 3 != 0) return nullptr;
+	if (!data.normalIndices.empty() && data.normalIndices.size() != data.vertexIndices.size()) return nullptr;
+
+	for (uint32_t index : data.vertexIndices) {
+		if (index >= data.GetVertexCount()) return nullptr;
+	}
+	for (uint32_t index : data.normalIndices) {
+		if (index >= data.GetNormalCount() && index != MeshData::NoNormal) return nullptr;
+	}
+
+	auto mesh = Shape::MakeShared<TriangleMesh>(std::move(data));
+	if (!mesh->SetAccelerationStructure(std::move(nodes), std::move(primitiveOrder))) return nullptr;
+
+	return mesh;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "TriangleMesh.h"
+#include "LinearBVH.h"
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace RayTracer {
+	//Binary file that stores a triangle mesh together with its hierarchy, so the source file doesn't have to be parsed again
+	//Layout: Header followed by the arrays of the mesh and its hierarchy (Native byte order, each array padded to 8 bytes)
+	class MeshCache {
+	public:
+		//Needs to be increased whenever the layout changes
+		static constexpr uint32_t Version = 2;
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t headerSize;
+			//sizeof(Real) of the build that wrote the file (Float and double builds can't share files)
+			uint32_t realSize;
+			uint32_t reserved;
+			//Checksum and size of the file the mesh was created from
+			uint64_t sourceChecksum;
+			uint64_t sourceSize;
+
+			//Number of elements of every array
+			uint64_t positionCount;
+			uint64_t normalCount;
+			uint64_t vertexIndexCount;
+			uint64_t normalIndexCount;
+			uint64_t nodeCount;
+			uint64_t primitiveOrderCount;
+		};
+
+		static std::string GetCacheFileName(const std::string& sourceFileName) { return sourceFileName + ".meshcache"; }
+
+		//64 bit FNV-1a over 8 byte words (Fast enough to check large source files on every load)
+		static uint64_t ComputeChecksum(const char* data, size_t length);
+
+		//Builds the mesh's hierarchy if necessary
+		static bool Write(const std::string& fileName, TriangleMesh& mesh, uint64_t sourceChecksum, uint64_t sourceSize);
+
+		//Returns nullptr if the file doesn't exist, is damaged, has a different version or precision or was created from a different source
+		static std::shared_ptr<TriangleMesh> Read(const std::string& fileName, uint64_t sourceChecksum, uint64_t sourceSize);
+
+	private:
+		static constexpr char Magic[8] = { 'R', 'T', 'M', 'E', 'S', 'H', 'C', '\0' };
+
+		static size_t PaddedSize(size_t bytes) { return (bytes + 7) & ~static_cast<size_t>(7); }
+	};
+}
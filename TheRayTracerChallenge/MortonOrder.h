@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace RayTracer {
+	//Z-order curve: the code of a cell interleaves the bits of its x and y coordinates (x in the even bits)
+	//Cells that follow each other on the curve are also close in 2D, so rendering tiles / pixels in this order keeps neighbouring rays together
+	namespace MortonOrder {
+		//Move the lower 16 bits of a value to the even bits
+		inline uint32_t SpreadBits(uint32_t value) {
+			value &= 0x0000FFFF;
+			value = (value | (value << 8)) & 0x00FF00FF;
+			value = (value | (value << 4)) & 0x0F0F0F0F;
+			value = (value | (value << 2)) & 0x33333333;
+			value = (value | (value << 1)) & 0x55555555;
+			return value;
+		}
+
+		//Inverse of SpreadBits
+		inline uint32_t CompactBits(uint32_t value) {
+			value &= 0x55555555;
+			value = (value | (value >> 1)) & 0x33333333;
+			value = (value | (value >> 2)) & 0x0F0F0F0F;
+			value = (value | (value >> 4)) & 0x00FF00FF;
+			value = (value | (value >> 8)) & 0x0000FFFF;
+			return value;
+		}
+
+		inline uint32_t Encode(uint32_t x, uint32_t y) { return SpreadBits(x) | (SpreadBits(y) << 1); }
+
+		inline void Decode(uint32_t code, uint32_t& x, uint32_t& y) {
+			x = CompactBits(code);
+			y = CompactBits(code >> 1);
+		}
+
+		//Call visit(x, y) for every cell of a width x height grid (both at most 65536) in Z-order
+		//The curve covers a power of two square, codes outside of the grid are skipped (Cheap for grids that are roughly square, like the tiles of an image)
+		template<typename Visitor>
+		void ForEachCell(size_t width, size_t height, Visitor&& visit) {
+			if (width == 0 || height == 0) return;
+
+			uint64_t side = 1;
+			while (side < width || side < height) side *= 2;
+
+			for (uint64_t code = 0; code < side * side; code++) {
+				uint32_t x, y;
+				Decode(static_cast<uint32_t>(code), x, y);
+
+				if (x < width && y < height) visit(static_cast<size_t>(x), static_cast<size_t>(y));
+			}
+		}
+	}
+}
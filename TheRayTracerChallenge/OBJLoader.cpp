@@ -0,0 +1,466 @@
+#include "OBJLoader.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+std::string RayTracer::OBJLoadStatistics::ToString() const
+{
+	std::string str;
+
+	str += "Size: " + std::to_string(bytes / (1024.0 * 1024.0)) + " MB\n";
+	str += "Lines: " + std::to_string(lines) + " (" + std::to_string(ignoredLines) + " ignored)\n";
+	str += "Chunks: " + std::to_string(chunks) + " on " + std::to_string(threads) + " thread(s)\n";
+	str += "Time: " + std::to_string(seconds) + " s" + (loadedFromCache ? " (Loaded from cache)" : "") + "\n";
+	str += "Throughput: " + std::to_string(GetMegabytesPerSecond()) + " MB/s, " + std::to_string(GetLinesPerSecond()) + " lines/s\n";
+
+	return str;
+}
+
+
+RayTracer::OBJLoader::OBJLoader(size_t threadCount)
+{
+	this->threadCount = threadCount;
+	chunkSize = DefaultChunkSize;
+	Clear();
+}
+
+void RayTracer::OBJLoader::Clear()
+{
+	data = MeshData();
+	statistics = OBJLoadStatistics();
+
+	groups.clear();
+	groups.push_back(OBJGroup());
+	groups.back().name = "default";
+}
+
+bool RayTracer::OBJLoader::LoadFile(const std::string& fileName)
+{
+	MappedFile file;
+	if (!file.Open(fileName)) return false;
+
+	Load(file.GetData(), file.GetSize());
+	return true;
+}
+
+std::shared_ptr<RayTracer::TriangleMesh> RayTracer::OBJLoader::LoadMesh(const std::string& fileName, bool useCache)
+{
+	auto begin = std::chrono::steady_clock::now();
+
+	MappedFile file;
+	if (!file.Open(fileName)) return nullptr;
+
+	Clear();
+
+	//The cache is only used if it was created from exactly the same file
+	uint64_t checksum = MeshCache::ComputeChecksum(file.GetData(), file.GetSize());
+	std::string cacheFileName = MeshCache::GetCacheFileName(fileName);
+
+	std::shared_ptr<TriangleMesh> mesh = useCache ? MeshCache::Read(cacheFileName, checksum, file.GetSize()) : nullptr;
+
+	if (mesh) {
+		statistics.bytes = file.GetSize();
+		statistics.loadedFromCache = true;
+	}
+	else {
+		Load(file.GetData(), file.GetSize());
+		mesh = MakeMesh();
+		mesh->BuildAccelerationStructure();
+
+		//The mesh is still usable if the cache can't be written (e.g. read-only directory)
+		if (useCache) MeshCache::Write(cacheFileName, *mesh, checksum, file.GetSize());
+	}
+
+	statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	return mesh;
+}
+
+void RayTracer::OBJLoader::Load(const char* text, size_t length)
+{
+	auto begin = std::chrono::steady_clock::now();
+
+	std::vector<Chunk> chunks = CreateChunks(text, length);
+	ThreadPool threadPool(threadCount);
+
+	threadPool.ParallelFor(chunks.size(), [&](size_t taskIndex, size_t) {
+		chunks[taskIndex].Parse();
+	});
+
+	MergeChunks(chunks, threadPool);
+
+	statistics.bytes += length;
+	statistics.chunks += chunks.size();
+	statistics.threads = std::min(threadPool.GetThreadCount(), chunks.size());
+	statistics.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+std::vector<RayTracer::OBJLoader::Chunk> RayTracer::OBJLoader::CreateChunks(const char* text, size_t length) const
+{
+	std::vector<Chunk> chunks;
+	const char* end = text + length;
+	const char* chunkBegin = text;
+
+	while (chunkBegin < end) {
+		size_t remaining = end - chunkBegin;
+		const char* chunkEnd = end;
+
+		//Extend the chunk to the end of the line it stops in
+		if (remaining > chunkSize) {
+			const char* lineEnd = static_cast<const char*>(std::memchr(chunkBegin + chunkSize - 1, '\n', remaining - chunkSize + 1));
+			if (lineEnd != nullptr) chunkEnd = lineEnd + 1;
+		}
+
+		chunks.push_back(Chunk());
+		chunks.back().textBegin = chunkBegin;
+		chunks.back().textEnd = chunkEnd;
+
+		chunkBegin = chunkEnd;
+	}
+
+	return chunks;
+}
+
+void RayTracer::OBJLoader::MergeChunks(std::vector<Chunk>& chunks, ThreadPool& threadPool)
+{
+	//Prefix sums of the vertex and normal counts
+	size_t vertexCount = data.GetVertexCount();
+	size_t normalCount = data.GetNormalCount();
+	std::vector<size_t> invalidChunks;
+
+	for (size_t index = 0; index < chunks.size(); index++) {
+		Chunk& chunk = chunks[index];
+		chunk.vertexOffset = vertexCount;
+		chunk.normalOffset = normalCount;
+
+		if (chunk.requiredVertexOffset > chunk.vertexOffset || chunk.requiredNormalOffset > chunk.normalOffset) {
+			invalidChunks.push_back(index);
+		}
+
+		vertexCount += chunk.data.GetVertexCount();
+		normalCount += chunk.data.GetNormalCount();
+	}
+
+	//Faces that reference vertices that don't exist (yet) need to be ignored -> only possible once the offsets are known
+	threadPool.ParallelFor(invalidChunks.size(), [&](size_t taskIndex, size_t) {
+		Chunk& chunk = chunks[invalidChunks[taskIndex]];
+		chunk.Reparse(chunk.vertexOffset, chunk.normalOffset);
+	});
+
+	//Prefix sums of the triangle counts
+	std::vector<size_t> cornerOffsets(chunks.size());
+	size_t cornerCount = data.vertexIndices.size();
+	bool hasNormalIndices = !data.normalIndices.empty();
+
+	for (size_t index = 0; index < chunks.size(); index++) {
+		cornerOffsets[index] = cornerCount;
+		cornerCount += chunks[index].data.vertexIndices.size();
+		hasNormalIndices = hasNormalIndices || !chunks[index].data.normalIndices.empty();
+	}
+
+	//A single chunk can be moved instead of copied
+	bool moveChunk = chunks.size() == 1 && data.positions.empty() && data.normals.empty() && data.vertexIndices.empty();
+
+	if (moveChunk) {
+		data = std::move(chunks[0].data);
+	}
+	else {
+		data.positions.resize(vertexCount * 3);
+		data.normals.resize(normalCount * 3);
+		data.vertexIndices.resize(cornerCount);
+		//Triangles without normal vectors (including the ones loaded before) use NoNormal
+		if (hasNormalIndices) data.normalIndices.resize(cornerCount, MeshData::NoNormal);
+
+		threadPool.ParallelFor(chunks.size(), [&](size_t taskIndex, size_t) {
+			Chunk& chunk = chunks[taskIndex];
+			MeshData& chunkData = chunk.data;
+
+			std::copy(chunkData.positions.begin(), chunkData.positions.end(), data.positions.begin() + chunk.vertexOffset * 3);
+			std::copy(chunkData.normals.begin(), chunkData.normals.end(), data.normals.begin() + chunk.normalOffset * 3);
+			std::copy(chunkData.vertexIndices.begin(), chunkData.vertexIndices.end(), data.vertexIndices.begin() + cornerOffsets[taskIndex]);
+			std::copy(chunkData.normalIndices.begin(), chunkData.normalIndices.end(), data.normalIndices.begin() + cornerOffsets[taskIndex]);
+
+			//Free the memory as soon as possible
+			chunkData = MeshData();
+		});
+	}
+
+	//Relative indices become absolute (Unsigned overflow is intended, the result is always a valid index)
+	threadPool.ParallelFor(chunks.size(), [&](size_t taskIndex, size_t) {
+		Chunk& chunk = chunks[taskIndex];
+		uint32_t vertexOffset = static_cast<uint32_t>(chunk.vertexOffset);
+		uint32_t normalOffset = static_cast<uint32_t>(chunk.normalOffset);
+
+		for (size_t corner : chunk.relativeVertexCorners) {
+			data.vertexIndices[cornerOffsets[taskIndex] + corner] += vertexOffset;
+		}
+		for (size_t corner : chunk.relativeNormalCorners) {
+			data.normalIndices[cornerOffsets[taskIndex] + corner] += normalOffset;
+		}
+	});
+
+	//Replay the groups in file order
+	for (size_t index = 0; index < chunks.size(); index++) {
+		Chunk& chunk = chunks[index];
+		size_t firstTriangle = cornerOffsets[index] / 3;
+
+		groups.back().triangleCount += chunk.leadingTriangleCount;
+
+		for (auto& group : chunk.groups) {
+			StartGroup(group.name, firstTriangle + group.firstTriangle);
+			groups.back().triangleCount += group.triangleCount;
+		}
+
+		statistics.lines += chunk.lines;
+		statistics.ignoredLines += chunk.ignoredLines;
+	}
+}
+
+void RayTracer::OBJLoader::StartGroup(const std::string& name, size_t firstTriangle)
+{
+	//Groups without triangles are replaced
+	if (groups.back().triangleCount != 0) {
+		groups.push_back(OBJGroup());
+		groups.back().firstTriangle = firstTriangle;
+	}
+
+	groups.back().name = name;
+}
+
+std::shared_ptr<RayTracer::TriangleMesh> RayTracer::OBJLoader::MakeMesh()
+{
+	auto mesh = Shape::MakeShared<TriangleMesh>(std::move(data));
+
+	//Keep the statistics of the load
+	OBJLoadStatistics loadStatistics = statistics;
+	Clear();
+	statistics = loadStatistics;
+
+	return mesh;
+}
+
+void RayTracer::OBJLoader::Chunk::Parse()
+{
+	const char* position = textBegin;
+
+	while (position < textEnd) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(position, '\n', textEnd - position));
+		if (lineEnd == nullptr) lineEnd = textEnd;
+
+		lines++;
+		if (!ParseLine(position, lineEnd)) {
+			ignoredLines++;
+		}
+
+		position = lineEnd + 1;
+	}
+}
+
+void RayTracer::OBJLoader::Chunk::Reparse(size_t knownVertexOffset, size_t knownNormalOffset)
+{
+	const char* begin = textBegin;
+	const char* end = textEnd;
+
+	*this = Chunk();
+	textBegin = begin;
+	textEnd = end;
+	vertexOffset = knownVertexOffset;
+	normalOffset = knownNormalOffset;
+
+	Parse();
+}
+
+bool RayTracer::OBJLoader::Chunk::ParseLine(const char* position, const char* end)
+{
+	position = SkipWhitespace(position, end);
+
+	//Empty line or comment
+	if (position == end || *position == '#') return false;
+
+	const char* commandEnd = SkipToWhitespace(position, end);
+	size_t commandLength = commandEnd - position;
+
+	if (commandLength == 1) {
+		switch (*position) {
+		case 'v': return ParseVertex(commandEnd, end, data.positions);
+		case 'f': return ParseFace(commandEnd, end);
+		case 'g': return ParseGroup(commandEnd, end);
+		}
+	}
+	else if (commandLength == 2 && position[0] == 'v' && position[1] == 'n') {
+		return ParseVertex(commandEnd, end, data.normals);
+	}
+
+	//Unsupported command
+	return false;
+}
+
+bool RayTracer::OBJLoader::Chunk::ParseVertex(const char* position, const char* end, std::vector<Real>& target)
+{
+	Real values[3];
+
+	//Additional values (like w) are ignored
+	for (Real& value : values) {
+		position = SkipWhitespace(position, end);
+
+		//from_chars doesn't accept a leading '+'
+		if (position != end && *position == '+') position++;
+
+		auto result = std::from_chars(position, end, value);
+		if (result.ec != std::errc()) return false;
+
+		position = result.ptr;
+		if (position != end && !IsWhitespace(*position)) return false;
+	}
+
+	target.push_back(values[0]);
+	target.push_back(values[1]);
+	target.push_back(values[2]);
+
+	return true;
+}
+
+bool RayTracer::OBJLoader::Chunk::ParseFace(const char* position, const char* end)
+{
+	faceVertices.clear();
+	faceNormals.clear();
+	faceVertexIsRelative.clear();
+	faceNormalIsRelative.clear();
+
+	size_t vertexCount = data.GetVertexCount();
+	size_t normalCount = data.GetNormalCount();
+	size_t faceVertexOffset = 0, faceNormalOffset = 0;
+	bool everyCornerHasNormal = true;
+
+	//Corners: v, v/vt, v//vn or v/vt/vn
+	while ((position = SkipWhitespace(position, end)) != end) {
+		int64_t index;
+		uint32_t vertex, normal = MeshData::NoNormal;
+		bool hasNormal = false, vertexIsRelative = false, normalIsRelative = false;
+		size_t requiredOffset = 0;
+
+		auto result = std::from_chars(position, end, index);
+		if (result.ec != std::errc() || !ResolveIndex(index, vertexCount, vertexOffset, vertex, vertexIsRelative, requiredOffset)) return false;
+		faceVertexOffset = std::max(faceVertexOffset, requiredOffset);
+		position = result.ptr;
+
+		if (position != end && *position == '/') {
+			//Texture coordinates are not supported
+			position++;
+			while (position != end && *position != '/' && !IsWhitespace(*position)) position++;
+
+			if (position != end && *position == '/') {
+				position++;
+
+				result = std::from_chars(position, end, index);
+				if (result.ec != std::errc() || !ResolveIndex(index, normalCount, normalOffset, normal, normalIsRelative, requiredOffset)) return false;
+				faceNormalOffset = std::max(faceNormalOffset, requiredOffset);
+				hasNormal = true;
+				position = result.ptr;
+			}
+		}
+
+		if (position != end && !IsWhitespace(*position)) return false;
+
+		faceVertices.push_back(vertex);
+		faceNormals.push_back(normal);
+		faceVertexIsRelative.push_back(vertexIsRelative);
+		faceNormalIsRelative.push_back(normalIsRelative);
+		//(Relative indices can't be compared with NoNormal before they are fixed)
+		if (!hasNormal) everyCornerHasNormal = false;
+	}
+
+	if (faceVertices.size() < 3) return false;
+
+	requiredVertexOffset = std::max(requiredVertexOffset, faceVertexOffset);
+	requiredNormalOffset = std::max(requiredNormalOffset, faceNormalOffset);
+
+	//Same layout as MeshData::AddTriangle, but relative indices may look like NoNormal until they are fixed
+	bool storeNormals = everyCornerHasNormal || !data.normalIndices.empty();
+	if (storeNormals) data.normalIndices.resize(data.vertexIndices.size(), MeshData::NoNormal);
+
+	//Build the polygon from triangles
+	for (size_t index = 2; index < faceVertices.size(); index++) {
+		for (size_t corner : { size_t(0), index - 1, index }) {
+			//Remember where the relative indices are stored
+			if (faceVertexIsRelative[corner]) relativeVertexCorners.push_back(data.vertexIndices.size());
+			data.vertexIndices.push_back(faceVertices[corner]);
+
+			if (storeNormals) {
+				if (everyCornerHasNormal && faceNormalIsRelative[corner]) relativeNormalCorners.push_back(data.normalIndices.size());
+				data.normalIndices.push_back(everyCornerHasNormal ? faceNormals[corner] : MeshData::NoNormal);
+			}
+		}
+	}
+
+	size_t triangleCount = faceVertices.size() - 2;
+	if (groups.empty()) {
+		leadingTriangleCount += triangleCount;
+	}
+	else {
+		groups.back().triangleCount += triangleCount;
+	}
+
+	return true;
+}
+
+bool RayTracer::OBJLoader::Chunk::ParseGroup(const char* position, const char* end)
+{
+	position = SkipWhitespace(position, end);
+
+	//Remove whitespace at the end
+	const char* nameEnd = end;
+	while (nameEnd != position && IsWhitespace(*(nameEnd - 1))) nameEnd--;
+
+	if (position == nameEnd) return false;
+
+	//Groups without triangles are replaced (Groups are merged with the same rules later on)
+	if (groups.empty() || groups.back().triangleCount != 0) {
+		groups.push_back(OBJGroup());
+		groups.back().firstTriangle = data.GetTriangleCount();
+	}
+
+	groups.back().name.assign(position, nameEnd);
+	return true;
+}
+
+bool RayTracer::OBJLoader::ResolveIndex(int64_t index, size_t localCount, size_t offset, uint32_t& result, bool& isRelative, size_t& requiredOffset)
+{
+	if (index > 0) {
+		//Absolute index, needs to be smaller than offset + localCount
+		if (static_cast<uint64_t>(index) > UINT32_MAX) return false;
+
+		result = static_cast<uint32_t>(index - 1);
+		isRelative = false;
+		requiredOffset = (static_cast<size_t>(index) > localCount) ? static_cast<size_t>(index) - localCount : 0;
+	}
+	else if (index < 0) {
+		//Relative to the end of the elements defined so far (Stored relative to the chunk's first element)
+		if (static_cast<uint64_t>(-index) > UINT32_MAX) return false;
+
+		int64_t localIndex = static_cast<int64_t>(localCount) + index;
+		result = static_cast<uint32_t>(localIndex);
+		isRelative = true;
+		requiredOffset = (localIndex < 0) ? static_cast<size_t>(-localIndex) : 0;
+	}
+	else {
+		return false;
+	}
+
+	//Offset is unknown while chunks are parsed in parallel -> checked after all chunks are done
+	return offset == Chunk::UnknownOffset || requiredOffset <= offset;
+}
+
+const char* RayTracer::OBJLoader::SkipWhitespace(const char* position, const char* end)
+{
+	while (position != end && IsWhitespace(*position)) position++;
+	return position;
+}
+
+const char* RayTracer::OBJLoader::SkipToWhitespace(const char* position, const char* end)
+{
+	while (position != end && !IsWhitespace(*position)) position++;
+	return position;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "TriangleMesh.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace RayTracer {
+	//Counters of a single load
+	struct OBJLoadStatistics {
+		size_t bytes = 0;
+		size_t lines = 0;
+		//Empty lines, comments, unsupported commands and malformed lines
+		size_t ignoredLines = 0;
+		size_t chunks = 0;
+		size_t threads = 0;
+		double seconds = 0.0;
+		bool loadedFromCache = false;
+
+		double GetMegabytesPerSecond() const { return seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+		double GetLinesPerSecond() const { return seconds > 0.0 ? lines / seconds : 0.0; }
+
+		std::string ToString() const;
+	};
+
+	//Consecutive triangles of a mesh that were defined after the same "g" command
+	struct OBJGroup {
+		std::string name;
+		size_t firstTriangle = 0;
+		size_t triangleCount = 0;
+	};
+
+	//Fast alternative to OBJParser for large files
+	//Supports the same commands (v, vn, f, g), but writes directly into the flat arrays of a MeshData
+	//instead of creating shapes or temporary strings
+	//The input is split into chunks at line boundaries, which are parsed in parallel and merged afterwards
+	class OBJLoader {
+	public:
+		static constexpr size_t DefaultChunkSize = 4 * 1024 * 1024;
+
+		//threadCount = 0 -> one thread per hardware thread
+		OBJLoader(size_t threadCount = 0);
+		~OBJLoader() = default;
+
+		//Memory-maps the file and parses it (Returns false if the file can't be opened)
+		bool LoadFile(const std::string& fileName);
+		//Parse .obj data that is already in memory (Appends to previously loaded data)
+		void Load(const char* text, size_t length);
+		//Load a mesh with a built hierarchy, using the binary cache next to the file (See MeshCache) if it is up to date
+		//A missing or outdated cache is recreated after parsing, groups are not available for cached meshes
+		//Returns nullptr if the file can't be opened
+		std::shared_ptr<TriangleMesh> LoadMesh(const std::string& fileName, bool useCache = true);
+
+		//Approximate number of bytes that are parsed by one task
+		void SetChunkSize(size_t size) { chunkSize = (size == 0) ? 1 : size; }
+		void SetThreadCount(size_t count) { threadCount = count; }
+
+		const MeshData& GetData() const { return data; }
+		const std::vector<OBJGroup>& GetGroups() const { return groups; }
+		const OBJLoadStatistics& GetStatistics() const { return statistics; }
+
+		//Create a mesh that contains every triangle (The loader's data is moved into the mesh)
+		std::shared_ptr<TriangleMesh> MakeMesh();
+
+		//Remove all loaded data
+		void Clear();
+
+	private:
+		size_t threadCount;
+		size_t chunkSize;
+
+		MeshData data;
+		std::vector<OBJGroup> groups;
+		OBJLoadStatistics statistics;
+
+		//Part of the input that is parsed independently of the others
+		//Chunks don't know how many vertices and normals were defined before them,
+		//so negative (relative) indices are stored relative to the chunk and fixed while merging
+		struct Chunk {
+			const char* textBegin = nullptr;
+			const char* textEnd = nullptr;
+
+			//Vertices / normals defined before the chunk (Unknown while the chunks are parsed in parallel)
+			static constexpr size_t UnknownOffset = SIZE_MAX;
+			size_t vertexOffset = UnknownOffset;
+			size_t normalOffset = UnknownOffset;
+
+			MeshData data;
+
+			//Positions in data.vertexIndices / data.normalIndices that are relative to the chunk's first vertex / normal
+			std::vector<size_t> relativeVertexCorners;
+			std::vector<size_t> relativeNormalCorners;
+
+			//Smallest offsets for which every face of the chunk references existing vertices / normals
+			size_t requiredVertexOffset = 0;
+			size_t requiredNormalOffset = 0;
+
+			//Triangles before the first "g" command belong to the group of the previous chunk
+			size_t leadingTriangleCount = 0;
+			std::vector<OBJGroup> groups;
+
+			size_t lines = 0;
+			size_t ignoredLines = 0;
+
+			//Corners of the current face (Kept to avoid allocations per face)
+			std::vector<uint32_t> faceVertices;
+			std::vector<uint32_t> faceNormals;
+			std::vector<uint8_t> faceVertexIsRelative;
+			std::vector<uint8_t> faceNormalIsRelative;
+
+			void Parse();
+			//Parse again after the offsets are known (Rejects faces with invalid indices like a serial parse would)
+			void Reparse(size_t knownVertexOffset, size_t knownNormalOffset);
+
+			//Returns false if the line was ignored
+			bool ParseLine(const char* position, const char* end);
+			bool ParseVertex(const char* position, const char* end, std::vector<Real>& target);
+			bool ParseFace(const char* position, const char* end);
+			bool ParseGroup(const char* position, const char* end);
+		};
+
+		//Split the input at line boundaries
+		std::vector<Chunk> CreateChunks(const char* text, size_t length) const;
+		void MergeChunks(std::vector<Chunk>& chunks, ThreadPool& threadPool);
+
+		//Same rules as a "g" command
+		void StartGroup(const std::string& name, size_t firstTriangle);
+
+		//index: Index from the file (Starting at 1, negative: counted backwards from the last element)
+		//localCount: Elements defined in the chunk so far, offset: Elements defined before the chunk
+		//requiredOffset: Smallest offset for which the index is valid
+		static bool ResolveIndex(int64_t index, size_t localCount, size_t offset, uint32_t& result, bool& isRelative, size_t& requiredOffset);
+
+		//'\r' is included for files with Windows line endings
+		static bool IsWhitespace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+		static const char* SkipWhitespace(const char* position, const char* end);
+		static const char* SkipToWhitespace(const char* position, const char* end);
+	};
+}
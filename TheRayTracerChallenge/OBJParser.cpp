@@ -4,7 +4,7 @@ RayTracer::OBJParser::OBJParser()
 {
 	ignoredLines = 0;
 	currentGroup = "default";
-	groups.emplace(currentGroup, std::vector<std::shared_ptr<Triangle>>());
+	groups.emplace(currentGroup, FaceGroup());
 
 	commands.emplace(std::string("v"), std::make_shared<ParseVertexCommand>());
 	commands.emplace(std::string("vn"), std::make_shared<ParseVertexNormalCommand>());
@@ -70,12 +70,7 @@ bool RayTracer::OBJParser::ParseFile(std::string fileName)
 	std::cout << "Done\n";
 	std::cout << ignoredLines << " Line(s) ignored\n";
 	
-	size_t triangleCount = 0;
-	for (auto& group : groups) {
-		triangleCount += group.second.size();
-	}
-
-	std::cout << triangleCount << " Triangles\n";
+	std::cout << GetTriangleCount() << " Triangles\n";
 
 	return true;
 }
@@ -88,31 +83,130 @@ std::shared_ptr<RayTracer::ShapeGroup> RayTracer::OBJParser::MakeGroup()
 	//Go through every group of shapes from within the .obj file
 	for (auto& group : groups) {
 		//Combine every shape of every group
-		for (auto& triangle : group.second) {
-			//Create copies, so that adding the same group
-			//multiple times won't cause problems
-			shapeGroup->AddShape(triangle->Copy());
+		//(New triangles are created every time, so that adding the same group
+		//multiple times won't cause problems)
+		for (size_t triangle = 0; triangle < group.second.vertexIndices.size() / 3; triangle++) {
+			shapeGroup->AddShape(CreateTriangle(group.second, triangle));
 		}
 	}
 
 	return shapeGroup;
 }
 
+std::shared_ptr<RayTracer::TriangleMesh> RayTracer::OBJParser::MakeMesh()
+{
+	MeshData data;
+
+	data.positions.reserve(vertices.size() * 3);
+	for (auto& vertex : vertices) {
+		data.positions.push_back(vertex.x);
+		data.positions.push_back(vertex.y);
+		data.positions.push_back(vertex.z);
+	}
+
+	data.normals.reserve(normalVectors.size() * 3);
+	for (auto& normal : normalVectors) {
+		data.normals.push_back(normal.x);
+		data.normals.push_back(normal.y);
+		data.normals.push_back(normal.z);
+	}
+
+	bool hasNormals = false;
+	for (auto& group : groups) {
+		data.vertexIndices.insert(data.vertexIndices.end(), group.second.vertexIndices.begin(), group.second.vertexIndices.end());
+		data.normalIndices.insert(data.normalIndices.end(), group.second.normalIndices.begin(), group.second.normalIndices.end());
+
+		hasNormals = hasNormals || std::any_of(group.second.normalIndices.begin(), group.second.normalIndices.end(),
+			[](uint32_t index) { return index != MeshData::NoNormal; });
+	}
+
+	//Flat meshes don't need to store normal indices
+	if (!hasNormals) {
+		data.normalIndices.clear();
+		data.normalIndices.shrink_to_fit();
+	}
+
+	return Shape::MakeShared<TriangleMesh>(std::move(data));
+}
+
+const std::vector<std::shared_ptr<RayTracer::Triangle>>& RayTracer::OBJParser::GetGroup(std::string name)
+{
+	FaceGroup& group = groups[name];
+
+	if (!group.trianglesCreated) {
+		for (size_t triangle = 0; triangle < group.vertexIndices.size() / 3; triangle++) {
+			group.triangles.push_back(CreateTriangle(group, triangle));
+		}
+		group.trianglesCreated = true;
+	}
+
+	return group.triangles;
+}
+
 void RayTracer::OBJParser::SetActiveGroup(std::string groupName)
 {
 	if (!HasGroup(groupName)) {
-		groups.emplace(groupName, std::vector<std::shared_ptr<Triangle>>());
+		groups.emplace(groupName, FaceGroup());
 	}
 	currentGroup = groupName;
 }
 
+void RayTracer::OBJParser::AddTriangle(size_t vertex0, size_t vertex1, size_t vertex2)
+{
+	FaceGroup& group = groups[currentGroup];
+
+	for (size_t vertex : { vertex0, vertex1, vertex2 }) {
+		group.vertexIndices.push_back(static_cast<uint32_t>(vertex - 1));
+		group.normalIndices.push_back(MeshData::NoNormal);
+	}
+
+	group.triangles.clear();
+	group.trianglesCreated = false;
+}
+
+void RayTracer::OBJParser::AddTriangle(size_t vertex0, size_t vertex1, size_t vertex2, size_t normal0, size_t normal1, size_t normal2)
+{
+	AddTriangle(vertex0, vertex1, vertex2);
+
+	FaceGroup& group = groups[currentGroup];
+	size_t first = group.normalIndices.size() - 3;
+	group.normalIndices[first] = static_cast<uint32_t>(normal0 - 1);
+	group.normalIndices[first + 1] = static_cast<uint32_t>(normal1 - 1);
+	group.normalIndices[first + 2] = static_cast<uint32_t>(normal2 - 1);
+}
+
+size_t RayTracer::OBJParser::GetTriangleCount()
+{
+	size_t triangleCount = 0;
+	for (auto& group : groups) {
+		triangleCount += group.second.vertexIndices.size() / 3;
+	}
+
+	return triangleCount;
+}
+
+std::shared_ptr<RayTracer::Triangle> RayTracer::OBJParser::CreateTriangle(const FaceGroup& group, size_t triangle)
+{
+	const uint32_t* vertex = &group.vertexIndices[3 * triangle];
+	const uint32_t* normal = &group.normalIndices[3 * triangle];
+
+	if (normal[0] != MeshData::NoNormal) {
+		return Shape::MakeShared<Triangle>(
+			vertices[vertex[0]], vertices[vertex[1]], vertices[vertex[2]],
+			normalVectors[normal[0]], normalVectors[normal[1]], normalVectors[normal[2]]
+		);
+	}
+
+	return Shape::MakeShared<Triangle>(vertices[vertex[0]], vertices[vertex[1]], vertices[vertex[2]]);
+}
+
 
 
 
 bool RayTracer::OBJParser::ParseVertexCommand::operator()(std::string& str, OBJParser& parser)
 {
 	try {
-		auto numbers = Helpers::ParseNumbers<double>(str, 3);
+		auto numbers = Helpers::ParseNumbers<Real>(str, 3);
 
 		//Store the vertex for later
 		parser.AddVertex(Point::CreatePoint(
@@ -189,28 +283,26 @@ bool RayTracer::OBJParser::ParseFaceCommand::operator()(std::string& str, OBJPar
 		//Only use normal vectors if they were parsed correctly
 		bool useNormalVectors = !normalIndices.empty() && normalIndices.size() == vertexIndices.size();
 
+		//Triangles only store indices -> make sure they reference existing vertices / normals
+		for (size_t index : vertexIndices) {
+			if (index == 0 || index > parser.vertices.size()) return false;
+		}
+		if (useNormalVectors) {
+			for (size_t index : normalIndices) {
+				if (index == 0 || index > parser.normalVectors.size()) return false;
+			}
+		}
+
 		//Build the polygon from triangles
 		for (size_t index = 2; index < vertexIndices.size(); index++) {
 			if (useNormalVectors) {
 				parser.AddTriangle(
-					Shape::MakeShared<Triangle>(
-						parser.GetVertex(vertexIndices[0]),
-						parser.GetVertex(vertexIndices[index - 1]),
-						parser.GetVertex(vertexIndices[index]),
-						parser.GetNormal(normalIndices[0]),
-						parser.GetNormal(normalIndices[index - 1]),
-						parser.GetNormal(normalIndices[index])
-					)
+					vertexIndices[0], vertexIndices[index - 1], vertexIndices[index],
+					normalIndices[0], normalIndices[index - 1], normalIndices[index]
 				);
 			}
 			else {
-				parser.AddTriangle(
-					Shape::MakeShared<Triangle>(
-						parser.GetVertex(vertexIndices[0]),
-						parser.GetVertex(vertexIndices[index - 1]),
-						parser.GetVertex(vertexIndices[index])
-					)
-				);
+				parser.AddTriangle(vertexIndices[0], vertexIndices[index - 1], vertexIndices[index]);
 			}
 		}
 
@@ -233,7 +325,7 @@ bool RayTracer::OBJParser::ParseGroupCommand::operator()(std::string & str, OBJP
 bool RayTracer::OBJParser::ParseVertexNormalCommand::operator()(std::string & str, OBJParser & parser)
 {
 	try {
-		auto numbers = Helpers::ParseNumbers<double>(str, 3);
+		auto numbers = Helpers::ParseNumbers<Real>(str, 3);
 
 		parser.AddNormal(Vector::CreateVector(
 			numbers[0],
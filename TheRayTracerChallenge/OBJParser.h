@@ -6,6 +6,7 @@
 #include "Shape.h"
 #include "Triangle.h"
 #include "ShapeGroup.h"
+#include "TriangleMesh.h"
 #include <memory>
 #include <map>
 #include <iostream>
@@ -33,8 +34,11 @@ namespace RayTracer {
 		size_t GetVertexCount() { return vertices.size(); }
 
 		//Read a triangle (index starts at 1!)
-		std::shared_ptr<Triangle> GetTriangle(size_t id, std::string groupName) { return groups[groupName][id - 1]; }
-		void AddTriangle(std::shared_ptr<Triangle> triangle) { groups[currentGroup].push_back(triangle); }
+		std::shared_ptr<Triangle> GetTriangle(size_t id, std::string groupName) { return GetGroup(groupName)[id - 1]; }
+		//Add a triangle to the active group (Vertex and normal indices start at 1!)
+		void AddTriangle(size_t vertex0, size_t vertex1, size_t vertex2);
+		void AddTriangle(size_t vertex0, size_t vertex1, size_t vertex2, size_t normal0, size_t normal1, size_t normal2);
+		size_t GetTriangleCount();
 
 		//Read a normal vector (Starts at 1!)
 		Vector GetNormal(size_t id) { return normalVectors[id - 1]; }
@@ -42,9 +46,11 @@ namespace RayTracer {
 
 		//Create a group of triangles from the parsed file
 		std::shared_ptr<ShapeGroup> MakeGroup();
+		//Create a single mesh that contains the triangles of every group (Uses far less memory than MakeGroup)
+		std::shared_ptr<TriangleMesh> MakeMesh();
 
 		//Get a named group from within a .obj file
-		const std::vector<std::shared_ptr<Triangle>>& GetGroup(std::string name) { return groups[name]; }
+		const std::vector<std::shared_ptr<Triangle>>& GetGroup(std::string name);
 		void SetActiveGroup(std::string groupName);
 
 		//Find out if the file contained a group with the specified name
@@ -62,8 +68,21 @@ namespace RayTracer {
 
 		std::vector<Vector> normalVectors;
 
+		//Triangles are only stored as indices (Starting at 0), Triangle shapes are created when they are requested
+		struct FaceGroup {
+			std::vector<uint32_t> vertexIndices;
+			//NoNormal for triangles without normal vectors
+			std::vector<uint32_t> normalIndices;
+
+			//Created by GetGroup
+			std::vector<std::shared_ptr<Triangle>> triangles;
+			bool trianglesCreated = false;
+		};
+
 		//Named groups of triangles
-		std::map<std::string, std::vector<std::shared_ptr<Triangle>>> groups;
+		std::map<std::string, FaceGroup> groups;
+
+		std::shared_ptr<Triangle> CreateTriangle(const FaceGroup& group, size_t triangle);
 
 
 
@@ -18,7 +18,11 @@ namespace RayTracer {
 		//Find the pattern's color at a point in world space
 		Color ColorAtShapePoint(Point shapePoint);
 
-		void SetTransform(Transform t) { transform = t; }
+		void SetTransform(Transform t) {
+			transform = t;
+			//Calculate the inverse now, so it is never written while multiple threads are rendering
+			transform.GetInverseAffine();
+		}
 		Transform GetTransform() { return transform; }
 
 
@@ -39,7 +43,7 @@ namespace RayTracer {
 
 	inline Color Pattern::ColorAtShapePoint(Point shapePoint) {
 		//Transform the point to the pattern's coordinate space
-		Point patternPoint = shapePoint * GetTransform().Inversion();
+		Point patternPoint = transform.GetInverseAffine() * shapePoint;
 		return ReadPattern(patternPoint);
 	}
 }
@@ -20,7 +20,7 @@ namespace RayTracer {
 		Vector FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) override;
 
 		BoundingBox GetObjectSpaceBounds() override {
-			constexpr auto inf = std::numeric_limits<double>::infinity();
+			constexpr auto inf = std::numeric_limits<Real>::infinity();
 			return BoundingBox(Point::CreatePoint(-inf, 0.0, -inf), Point::CreatePoint(inf, 0.0, inf));
 		}
 
@@ -40,9 +40,9 @@ namespace RayTracer {
 		}
 
 		//How far does the ray need to travel, until it reaches the plane (at y = 0.0)
-		double t = -ray.origin.y / ray.direction.y;
+		Real t = -ray.origin.y / ray.direction.y;
 
-		buffer.Add(Intersection(t, GetPointer()));
+		buffer.Add(Intersection(t, this));
 	}
 
 	inline Vector Plane::FindObjectSpaceNormal(Point p, const Intersection& globalIntersection)
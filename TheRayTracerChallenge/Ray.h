@@ -19,10 +19,11 @@ namespace RayTracer {
 		~Ray();
 
 		//Determine the ray's position after a certain distance is traveld
-		Point PositionAt(double t) const { return origin + (direction * t); }
+		Point PositionAt(Real t) const { return origin + (direction * t); }
 
 		//Create a new ray by applying transformations to this one
-		Ray Transform(Transform m);
+		Ray Transform(const RayTracer::Transform& m) const { return Transform(m.GetAffine()); }
+		Ray Transform(const Affine3x4& m) const;
 	};
 
 
@@ -44,7 +45,7 @@ namespace RayTracer {
 
 	//Mathematical functions
 
-	inline Ray Ray::Transform(RayTracer::Transform m) {
+	inline Ray Ray::Transform(const Affine3x4& m) const {
 		Ray r;
 		r.direction = m * direction;
 		r.origin = m * origin;
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Constants.h"
+#include "Ray.h"
+#include <cstddef>
+#include <cstdint>
+#include <bitset>
+
+namespace RayTracer {
+	//Rays through a square block of neighbouring pixels that are traced through a hierarchy together
+	//Origins and inverse directions are also stored as structure of arrays, so the box tests of all rays vectorize
+	struct RayPacket {
+		//4 x 4 pixels, lane = x + y * Width (One bit per lane in a LaneMask)
+		static constexpr size_t Width = 4;
+		static constexpr size_t Size = Width * Width;
+
+		using LaneMask = uint32_t;
+		static constexpr LaneMask AllLanes = (LaneMask(1) << Size) - 1;
+
+		//Lanes that contain a ray (Pixels outside of the image are left empty)
+		LaneMask activeLanes = 0;
+		//Lanes with rays that are parallel to an axis (Box tests need extra work for them)
+		LaneMask parallelLanes = 0;
+
+		Ray rays[Size];
+
+		//Box tests run on every lane and mask out the inactive ones, which may still hold the rays of an earlier use of the packet
+		//(Clear() only resets the masks, the arrays are zero initialized so no lane is ever uninitialized)
+		alignas(32) Real origin[3][Size] = {};
+		//Infinite for rays parallel to an axis
+		alignas(32) Real inverseDirection[3][Size] = {};
+
+		void Clear() { activeLanes = parallelLanes = 0; }
+		void SetRay(size_t lane, const Ray& ray);
+
+		static bool IsActive(LaneMask lanes, size_t lane) { return (lanes & (LaneMask(1) << lane)) != 0; }
+		static size_t CountLanes(LaneMask lanes);
+	};
+
+
+	inline void RayPacket::SetRay(size_t lane, const Ray& ray) {
+		rays[lane] = ray;
+
+		origin[0][lane] = ray.origin.x;
+		origin[1][lane] = ray.origin.y;
+		origin[2][lane] = ray.origin.z;
+		inverseDirection[0][lane] = 1.0 / ray.direction.x;
+		inverseDirection[1][lane] = 1.0 / ray.direction.y;
+		inverseDirection[2][lane] = 1.0 / ray.direction.z;
+
+		activeLanes |= LaneMask(1) << lane;
+		if (ray.direction.x == 0.0 || ray.direction.y == 0.0 || ray.direction.z == 0.0) {
+			parallelLanes |= LaneMask(1) << lane;
+		}
+		else {
+			parallelLanes &= ~(LaneMask(1) << lane);
+		}
+	}
+
+	inline size_t RayPacket::CountLanes(LaneMask lanes) {
+		return std::bitset<32>(lanes).count();
+	}
+}
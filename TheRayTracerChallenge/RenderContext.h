@@ -0,0 +1,97 @@
+#pragma once
+
+#include "IntersectionBuffer.h"
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace RayTracer {
+	class Shape;
+
+	//Counters that are updated while tracing rays
+	struct RenderStatistics {
+		//Rays that were intersected with the world (including shadow rays)
+		unsigned long long raysCast = 0;
+		unsigned long long shadowRaysCast = 0;
+		//Samples the camera took (One per pixel without antialiasing)
+		unsigned long long pixelSamples = 0;
+
+		void Add(const RenderStatistics& statistics) {
+			raysCast += statistics.raysCast;
+			shadowRaysCast += statistics.shadowRaysCast;
+			pixelSamples += statistics.pixelSamples;
+		}
+	};
+
+	//State needed while tracing rays through a world
+	//A context may only be used by one thread at a time, but any number of contexts can trace the same world
+	class RenderContext {
+	public:
+		RenderContext(uint64_t seed = 1);
+		~RenderContext() = default;
+
+		//Contexts own their buffers and are not meant to be shared
+		RenderContext(const RenderContext&) = delete;
+		RenderContext& operator=(const RenderContext&) = delete;
+
+		//Borrow an empty buffer for temporary intersections
+		//(Buffers need to be released in the reverse order they were acquired in)
+		IntersectionBuffer& AcquireBuffer();
+		void ReleaseBuffer();
+
+		//Shapes that a ray is currently inside of (Used to find refractive indices)
+		std::vector<Shape*>& GetMediumStack() { return mediumStack; }
+
+		RenderStatistics& GetStatistics() { return statistics; }
+
+		//Uniformly distributed random number in [0.0, 1.0)
+		double NextRandom();
+		void SetSeed(uint64_t seed) { randomState = (seed == 0) ? 1 : seed; }
+
+	private:
+		//Buffers are only allocated once and reused afterwards
+		//(unique_ptr, so references stay valid when the pool grows)
+		std::vector<std::unique_ptr<IntersectionBuffer>> bufferPool;
+		size_t buffersInUse;
+
+		std::vector<Shape*> mediumStack;
+
+		RenderStatistics statistics;
+
+		//State of the xorshift64* generator (never 0)
+		uint64_t randomState;
+	};
+
+
+	inline RenderContext::RenderContext(uint64_t seed) {
+		buffersInUse = 0;
+		SetSeed(seed);
+	}
+
+	inline IntersectionBuffer& RenderContext::AcquireBuffer() {
+		//All existing buffers are in use -> add a new one
+		if (buffersInUse == bufferPool.size()) {
+			bufferPool.push_back(std::make_unique<IntersectionBuffer>());
+		}
+
+		IntersectionBuffer& buffer = *bufferPool[buffersInUse];
+		buffersInUse++;
+
+		//Keeps the allocated memory
+		buffer.Reset();
+		return buffer;
+	}
+
+	inline void RenderContext::ReleaseBuffer() {
+		if (buffersInUse > 0) buffersInUse--;
+	}
+
+	inline double RenderContext::NextRandom() {
+		randomState ^= randomState >> 12;
+		randomState ^= randomState << 25;
+		randomState ^= randomState >> 27;
+
+		//Use the upper 53 bits to fill the mantissa of a double
+		return static_cast<double>((randomState * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace RayTracer {
+	//Counters of a running render. Render threads add to them after every tile, a ProgressReporter reads them
+	//Relaxed atomics: the counters are independent of each other and of the image, a report may be a tile behind
+	class RenderProgress {
+	public:
+		RenderProgress(unsigned long long totalTiles = 0) : totalTiles{ totalTiles } {}
+
+		void AddTile(unsigned long long tileRays) {
+			raysCast.fetch_add(tileRays, std::memory_order_relaxed);
+			completedTiles.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		unsigned long long GetTotalTiles() const { return totalTiles; }
+		unsigned long long GetCompletedTiles() const { return completedTiles.load(std::memory_order_relaxed); }
+		unsigned long long GetRaysCast() const { return raysCast.load(std::memory_order_relaxed); }
+
+	private:
+		unsigned long long totalTiles;
+
+		//On separate cache lines, so the threads don't also contend with the reporter on the rays
+		alignas(64) std::atomic<unsigned long long> completedTiles{ 0 };
+		alignas(64) std::atomic<unsigned long long> raysCast{ 0 };
+	};
+
+	//Snapshot of a RenderProgress that is passed to a progress callback
+	struct RenderProgressReport {
+		unsigned long long completedTiles = 0;
+		unsigned long long totalTiles = 0;
+		double elapsedSeconds = 0.0;
+		//Extrapolated from the tiles so far (0.0 before the first tile is done)
+		double remainingSeconds = 0.0;
+		double raysPerSecond = 0.0;
+		//Last report of a render (Also delivered if the render was cancelled)
+		bool finished = false;
+
+		double GetFraction() const { return (totalTiles == 0) ? 1.0 : static_cast<double>(completedTiles) / static_cast<double>(totalTiles); }
+	};
+
+	using RenderProgressCallback = std::function<void(const RenderProgressReport& report)>;
+
+	//Samples a RenderProgress on its own thread at a fixed interval and passes the reports to a callback, so render threads never wait for the output
+	//The callback is only called from the reporter's thread, the last time with finished = true when the reporter is stopped
+	class ProgressReporter {
+	public:
+		ProgressReporter(const RenderProgress& progress, RenderProgressCallback callback, std::chrono::milliseconds interval);
+		~ProgressReporter() { Stop(); }
+
+		ProgressReporter(const ProgressReporter&) = delete;
+		ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+		//Deliver the final report and wait for the thread
+		void Stop();
+
+		//Default callback: prints the percentage, the remaining time and the rays per second to std::cout
+		static void PrintToConsole(const RenderProgressReport& report);
+
+	private:
+		const RenderProgress& progress;
+		RenderProgressCallback callback;
+		std::chrono::milliseconds interval;
+		std::chrono::steady_clock::time_point start;
+
+		std::mutex mutex;
+		std::condition_variable stopCondition;
+		bool stopping = false;
+
+		std::thread thread;
+
+		RenderProgressReport CreateReport(bool finished) const;
+		void Run();
+	};
+
+
+	inline ProgressReporter::ProgressReporter(const RenderProgress& progress, RenderProgressCallback callback, std::chrono::milliseconds interval)
+		: progress{ progress }, callback{ std::move(callback) }, interval{ interval } {
+		start = std::chrono::steady_clock::now();
+		thread = std::thread(&ProgressReporter::Run, this);
+	}
+
+	inline void ProgressReporter::Stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		stopCondition.notify_one();
+
+		if (thread.joinable()) thread.join();
+	}
+
+	inline void ProgressReporter::PrintToConsole(const RenderProgressReport& report) {
+		std::cout << std::to_string(report.GetFraction() * 100.0) + "%, " + std::to_string(report.remainingSeconds) + " s left, "
+			+ std::to_string(report.raysPerSecond / 1000000.0) + " million rays/s\n";
+	}
+
+	inline RenderProgressReport ProgressReporter::CreateReport(bool finished) const {
+		RenderProgressReport report;
+		report.completedTiles = progress.GetCompletedTiles();
+		report.totalTiles = progress.GetTotalTiles();
+		report.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		report.finished = finished;
+
+		if (report.elapsedSeconds > 0.0) {
+			report.raysPerSecond = static_cast<double>(progress.GetRaysCast()) / report.elapsedSeconds;
+		}
+
+		if (report.completedTiles > 0 && report.completedTiles < report.totalTiles) {
+			double secondsPerTile = report.elapsedSeconds / static_cast<double>(report.completedTiles);
+			report.remainingSeconds = secondsPerTile * static_cast<double>(report.totalTiles - report.completedTiles);
+		}
+
+		return report;
+	}
+
+	inline void ProgressReporter::Run() {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!stopCondition.wait_for(lock, interval, [this] { return stopping; })) {
+			//The callback may take a while (e.g. saving a preview), Stop() must not wait for the lock in the meantime
+			lock.unlock();
+			callback(CreateReport(false));
+			lock.lock();
+		}
+
+		lock.unlock();
+		callback(CreateReport(true));
+	}
+}
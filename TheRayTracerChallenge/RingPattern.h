@@ -37,7 +37,7 @@ namespace RayTracer {
 
 	inline Color RingPattern::ReadPattern(Point point) {
 		//Calculate the point's distance from the 'center' (0.0/0.0/0.0)
-		double distance = sqrt((point.x * point.x) + (point.z * point.z));
+		Real distance = sqrt((point.x * point.x) + (point.z * point.z));
 
 		//Apply a line pattern to this distance -> rings
 		if (Constants::DoubleEqual(fmod(floor(distance), 2.0), 0.0)) {
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Constants.h"
+#include <cmath>
+#include <cstddef>
+
+//Kernels that work on several values at once use AVX (4 doubles), SSE2 (2 x 2 doubles) or SSE (4 floats), depending on the target
+//Define RAYTRACER_SIMD_SCALAR to use the plain C++ version instead (e.g. to compare the results)
+#if !defined(RAYTRACER_SIMD_SCALAR)
+#if defined(__AVX__) && !defined(RAYTRACER_USE_FLOAT)
+#define RAYTRACER_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAYTRACER_SIMD_SSE
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace RayTracer {
+	//Kernels are written once against these wrappers, each of them processes Count lanes per operation
+	//Loads and stores need 32 byte aligned arrays
+	namespace SIMDLanes {
+		struct Scalar {
+			static constexpr size_t Count = 1;
+			using Value = Real;
+			using Mask = bool;
+
+			static Value Load(const Real* values) { return *values; }
+			static Value Broadcast(Real value) { return value; }
+			static void Store(Real* target, Value value) { *target = value; }
+
+			static Value Add(Value a, Value b) { return a + b; }
+			static Value Sub(Value a, Value b) { return a - b; }
+			static Value Mul(Value a, Value b) { return a * b; }
+			//Product that is never contracted into an FMA (See RAYTRACER_KEEP_ROUNDED in Constants.h)
+			static Value MulRounded(Value a, Value b) { return Constants::MulRounded(a, b); }
+			static Value Div(Value a, Value b) { return a / b; }
+			//Same as the SSE / AVX instructions: b if either value is NaN
+			static Value Min(Value a, Value b) { return (a < b) ? a : b; }
+			static Value Max(Value a, Value b) { return (a > b) ? a : b; }
+			static Value Abs(Value a) { return std::fabs(a); }
+			static Value Select(Mask mask, Value a, Value b) { return mask ? a : b; }
+
+			static Mask AbsGreaterEqual(Value a, Value b) { return std::fabs(a) >= b; }
+			static Mask GreaterEqual(Value a, Value b) { return a >= b; }
+			static Mask LessEqual(Value a, Value b) { return a <= b; }
+			static Mask Equal(Value a, Value b) { return a == b; }
+			static Mask Less(Value a, Value b) { return a < b; }
+			static Mask NotEqual(Value a, Value b) { return a < b || a > b; }
+			static Mask And(Mask a, Mask b) { return a && b; }
+			static Mask Or(Mask a, Mask b) { return a || b; }
+			static int ToBits(Mask mask) { return mask ? 1 : 0; }
+		};
+
+#if defined(RAYTRACER_SIMD_AVX)
+		struct AVX {
+			static constexpr size_t Count = 4;
+			using Value = __m256d;
+			using Mask = __m256d;
+
+			static Value Load(const Real* values) { return _mm256_load_pd(values); }
+			static Value Broadcast(Real value) { return _mm256_set1_pd(value); }
+			static void Store(Real* target, Value value) { _mm256_store_pd(target, value); }
+
+			static Value Add(Value a, Value b) { return _mm256_add_pd(a, b); }
+			static Value Sub(Value a, Value b) { return _mm256_sub_pd(a, b); }
+			static Value Mul(Value a, Value b) { return _mm256_mul_pd(a, b); }
+			static Value MulRounded(Value a, Value b) { Value product = Mul(a, b); RAYTRACER_KEEP_ROUNDED(product); return product; }
+			static Value Div(Value a, Value b) { return _mm256_div_pd(a, b); }
+			static Value Min(Value a, Value b) { return _mm256_min_pd(a, b); }
+			static Value Max(Value a, Value b) { return _mm256_max_pd(a, b); }
+			static Value Abs(Value a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+			static Value Select(Mask mask, Value a, Value b) { return _mm256_blendv_pd(b, a, mask); }
+
+			static Mask AbsGreaterEqual(Value a, Value b) { return _mm256_cmp_pd(Abs(a), b, _CMP_GE_OQ); }
+			static Mask GreaterEqual(Value a, Value b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+			static Mask LessEqual(Value a, Value b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+			static Mask Equal(Value a, Value b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+			static Mask Less(Value a, Value b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+			static Mask NotEqual(Value a, Value b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_OQ); }
+			static Mask And(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+			static Mask Or(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+			static int ToBits(Mask mask) { return _mm256_movemask_pd(mask); }
+		};
+#elif defined(RAYTRACER_SIMD_SSE) && defined(RAYTRACER_USE_FLOAT)
+		struct SSE {
+			static constexpr size_t Count = 4;
+			using Value = __m128;
+			using Mask = __m128;
+
+			static Value Load(const Real* values) { return _mm_load_ps(values); }
+			static Value Broadcast(Real value) { return _mm_set1_ps(value); }
+			static void Store(Real* target, Value value) { _mm_store_ps(target, value); }
+
+			static Value Add(Value a, Value b) { return _mm_add_ps(a, b); }
+			static Value Sub(Value a, Value b) { return _mm_sub_ps(a, b); }
+			static Value Mul(Value a, Value b) { return _mm_mul_ps(a, b); }
+			static Value MulRounded(Value a, Value b) { Value product = Mul(a, b); RAYTRACER_KEEP_ROUNDED(product); return product; }
+			static Value Div(Value a, Value b) { return _mm_div_ps(a, b); }
+			static Value Min(Value a, Value b) { return _mm_min_ps(a, b); }
+			static Value Max(Value a, Value b) { return _mm_max_ps(a, b); }
+			static Value Abs(Value a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+			//SSE2 has no blend instruction
+			static Value Select(Mask mask, Value a, Value b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+			static Mask AbsGreaterEqual(Value a, Value b) { return _mm_cmpge_ps(Abs(a), b); }
+			static Mask GreaterEqual(Value a, Value b) { return _mm_cmpge_ps(a, b); }
+			static Mask LessEqual(Value a, Value b) { return _mm_cmple_ps(a, b); }
+			static Mask Equal(Value a, Value b) { return _mm_cmpeq_ps(a, b); }
+			static Mask Less(Value a, Value b) { return _mm_cmplt_ps(a, b); }
+			static Mask NotEqual(Value a, Value b) { return _mm_and_ps(_mm_cmpneq_ps(a, b), _mm_cmpord_ps(a, b)); }
+			static Mask And(Mask a, Mask b) { return _mm_and_ps(a, b); }
+			static Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+			static int ToBits(Mask mask) { return _mm_movemask_ps(mask); }
+		};
+#elif defined(RAYTRACER_SIMD_SSE)
+		struct SSE {
+			static constexpr size_t Count = 2;
+			using Value = __m128d;
+			using Mask = __m128d;
+
+			static Value Load(const Real* values) { return _mm_load_pd(values); }
+			static Value Broadcast(Real value) { return _mm_set1_pd(value); }
+			static void Store(Real* target, Value value) { _mm_store_pd(target, value); }
+
+			static Value Add(Value a, Value b) { return _mm_add_pd(a, b); }
+			static Value Sub(Value a, Value b) { return _mm_sub_pd(a, b); }
+			static Value Mul(Value a, Value b) { return _mm_mul_pd(a, b); }
+			static Value MulRounded(Value a, Value b) { Value product = Mul(a, b); RAYTRACER_KEEP_ROUNDED(product); return product; }
+			static Value Div(Value a, Value b) { return _mm_div_pd(a, b); }
+			static Value Min(Value a, Value b) { return _mm_min_pd(a, b); }
+			static Value Max(Value a, Value b) { return _mm_max_pd(a, b); }
+			static Value Abs(Value a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+			//SSE2 has no blend instruction
+			static Value Select(Mask mask, Value a, Value b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+
+			static Mask AbsGreaterEqual(Value a, Value b) { return _mm_cmpge_pd(Abs(a), b); }
+			static Mask GreaterEqual(Value a, Value b) { return _mm_cmpge_pd(a, b); }
+			static Mask LessEqual(Value a, Value b) { return _mm_cmple_pd(a, b); }
+			static Mask Equal(Value a, Value b) { return _mm_cmpeq_pd(a, b); }
+			static Mask Less(Value a, Value b) { return _mm_cmplt_pd(a, b); }
+			static Mask NotEqual(Value a, Value b) { return _mm_and_pd(_mm_cmpneq_pd(a, b), _mm_cmpord_pd(a, b)); }
+			static Mask And(Mask a, Mask b) { return _mm_and_pd(a, b); }
+			static Mask Or(Mask a, Mask b) { return _mm_or_pd(a, b); }
+			static int ToBits(Mask mask) { return _mm_movemask_pd(mask); }
+		};
+#endif
+
+#if defined(RAYTRACER_SIMD_AVX)
+		using Default = AVX;
+#elif defined(RAYTRACER_SIMD_SSE)
+		using Default = SSE;
+#else
+		using Default = Scalar;
+#endif
+	}
+}
@@ -5,17 +5,30 @@
 #include "Ray.h"
 #include "Matrix.h"
 #include "BoundingBox.h"
+#include "BVHBuildSettings.h"
+#include "RenderContext.h"
+#include <atomic>
 
 namespace RayTracer {
 	//Abstract class common to all shapes
 	class Shape
 	{
 	public:
-		Shape() { material = Material(); transformIsActive = false; }
+		Shape() { material = Material(); transformIsActive = false; worldTransformIsValid = false; }
 		~Shape() = default;
 
-		void SetTransform(Transform newTransform) { transform = newTransform; transformIsActive = true; }
+		void SetTransform(Transform newTransform) {
+			transform = newTransform;
+			transformIsActive = true;
+			//Calculate the inverse now, so it is never written while multiple threads are rendering
+			transform.Inversion();
+			InvalidateWorldTransform();
+			//The bounds changed, so structures built over this shape are out of date (Its own structure is still valid)
+			Shape::InvalidateAccelerationStructure();
+		}
 		Transform GetTransformCopy() { return transform; }
+		//False if no transform was ever set (The shape's object space is the same as its parent's)
+		bool HasTransform() const { return transformIsActive; }
 		//Get the shape's transform by reference (Caching of calculations can improve performance
 		Transform& GetTransformRef() { return transform; }
 
@@ -24,13 +37,32 @@ namespace RayTracer {
 		Material GetMaterial() { return material; }
 
 		//Find intersections of this shape and a ray
+		void FindIntersections(Ray ray, IntersectionBuffer& buffer, RenderContext& context);
 		void FindIntersections(Ray ray, IntersectionBuffer& buffer);
 
+		//Check if the ray hits the shape at any t in [0.0, maximumT) (Stops at the first hit that is found, nothing is sorted)
+		bool FindAnyHit(Ray ray, Real maximumT, RenderContext& context);
+
+		//Find the closest hit with t >= 0.0 (Only hits in front of closestHit.t are considered, closestHit is replaced by closer hits)
+		//Returns true if closestHit was replaced
+		bool FindClosestHit(Ray ray, Intersection& closestHit, RenderContext& context);
+
 		//Calculate the surface normal at a point on the shape (Point assumed to be on shape's surface)
 		Vector SurfaceNormal(Point p, const Intersection& i);
 
 		//Calculate all intersections with a ray in object space (Individually implemented by each shape)
 		virtual void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) = 0;
+		//Shapes that contain other shapes override this version, so the context is passed on to their children
+		virtual void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer, RenderContext& /*context*/) {
+			FindObjectSpaceIntersections(ray, buffer);
+		}
+
+		//Any hit query in object space (Transforms don't change t, so maximumT is the same in every space)
+		//The default checks all intersections of the shape, shapes that contain other shapes override it to stop early
+		virtual bool FindObjectSpaceAnyHit(Ray ray, Real maximumT, RenderContext& context);
+
+		//Closest hit query in object space (The default checks all intersections of the shape)
+		virtual bool FindObjectSpaceClosestHit(Ray ray, Intersection& closestHit, RenderContext& context);
 
 		//Calculate the normal vector of a point in object space (Implemented by each concrete shape)
 		virtual Vector FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) = 0;
@@ -61,7 +93,7 @@ namespace RayTracer {
 			if (parent.expired()) return std::shared_ptr<Shape>();
 			return static_cast<std::shared_ptr<Shape>>(parent);
 		}
-		void SetParent(std::shared_ptr<Shape> newPtr) { parent = static_cast<std::weak_ptr<Shape>>(newPtr); }
+		void SetParent(std::shared_ptr<Shape> newPtr) { parent = static_cast<std::weak_ptr<Shape>>(newPtr); InvalidateWorldTransform(); }
 
 		std::shared_ptr<Shape> Copy() {
 			auto shape = ShapeSpecificCopy();
@@ -71,8 +103,8 @@ namespace RayTracer {
 			return shape;
 		}
 
-		virtual bool ContainsShape(std::shared_ptr<Shape> shape) {
-			return shape == GetPointer();
+		virtual bool ContainsShape(const Shape* shape) {
+			return shape == this;
 		}
 
 		BoundingBox GetParentSpaceBounds() { return GetObjectSpaceBounds().ApplyTransform(transform); }
@@ -81,31 +113,124 @@ namespace RayTracer {
 
 		virtual void PartitionChildren(size_t maximumShapeCount) = 0;
 
+		//Subdivide contained shapes into a hierarchy using the surface area heuristic (Only used by shapes that contain other shapes)
+		virtual void BuildHierarchy(const BVHBuildSettings& /*settings*/) {}
+
+		//Compile the contained shapes into flat acceleration structures before rendering (Only used by shapes that contain other shapes)
+		virtual void BuildAccelerationStructure(const BVHBuildSettings& /*settings*/ = BVHBuildSettings()) {}
+		//Called when contained shapes change, so compiled structures of this shape and its parents are rebuilt
+		virtual void InvalidateAccelerationStructure() {
+			changeCount.fetch_add(1, std::memory_order_relaxed);
+
+			auto parentShape = GetParent();
+			if (parentShape) parentShape->InvalidateAccelerationStructure();
+		}
+
+		//Incremented whenever the transform or the contained shapes of any shape change
+		//(World compares it to the value of its last PrepareFrame, so it never traces a hierarchy with outdated bounds)
+		static unsigned long long GetChangeCount() { return changeCount.load(std::memory_order_relaxed); }
+
+		//Combine the transforms of this shape and all of its parents into single matrices, so PointToObjectSpace
+		//and NormalToWorldSpace don't need to walk up the parent chain (Shapes that contain other shapes update them as well)
+		//Called by World::PrepareFrame, so the cached matrices are never written while multiple threads are rendering
+		virtual void UpdateWorldTransform();
+		//Called when the transform of this shape or one of its parents changes (Shapes that contain other shapes invalidate them as well)
+		virtual void InvalidateWorldTransform() { worldTransformIsValid = false; }
+		bool HasWorldTransform() const { return worldTransformIsValid; }
+
 	private:
 
 		virtual std::shared_ptr<Shape> ShapeSpecificCopy() = 0;
 
+		//Update the cached matrices of this shape and its parents (Not the contained shapes)
+		void ComputeWorldTransform();
+
 		bool transformIsActive;
 		Transform transform;
 
+		//Cached by UpdateWorldTransform: All inverse transforms from the root down to this shape
+		//(Its transposed 3x3 part transforms normals back to world space)
+		bool worldTransformIsValid;
+		Affine3x4 worldToObject;
+
 		std::weak_ptr<Shape> thisShapePtr;
 		std::weak_ptr<Shape> parent;
 
+		static inline std::atomic<unsigned long long> changeCount{ 0 };
+
 	protected:
 		Material material;
 	};
 
 
-	inline void Shape::FindIntersections(Ray ray, IntersectionBuffer& buffer) {
+	inline void Shape::FindIntersections(Ray ray, IntersectionBuffer& buffer, RenderContext& context) {
 
 		if (transformIsActive) {
 			//Transform the ray into object space
-			ray = ray.Transform(GetTransformRef().Inversion());
+			ray = ray.Transform(GetTransformRef().GetInverseAffine());
 
 		}
 
 		//Find intersections
-		FindObjectSpaceIntersections(ray, buffer);
+		FindObjectSpaceIntersections(ray, buffer, context);
+	}
+
+	inline void Shape::FindIntersections(Ray ray, IntersectionBuffer& buffer) {
+		RenderContext context;
+		FindIntersections(ray, buffer, context);
+	}
+
+	inline bool Shape::FindAnyHit(Ray ray, Real maximumT, RenderContext& context) {
+		if (transformIsActive) {
+			//The direction is not normalized, so t stays the same in object space
+			ray = ray.Transform(GetTransformRef().GetInverseAffine());
+		}
+
+		return FindObjectSpaceAnyHit(ray, maximumT, context);
+	}
+
+	inline bool Shape::FindObjectSpaceAnyHit(Ray ray, Real maximumT, RenderContext& context) {
+		IntersectionBuffer& intersections = context.AcquireBuffer();
+		FindObjectSpaceIntersections(ray, intersections, context);
+
+		bool hit = false;
+		size_t count = intersections.GetCount();
+
+		for (size_t index = 0; index < count && !hit; index++) {
+			Real t = intersections[index].t;
+			hit = t >= 0.0 && t < maximumT;
+		}
+
+		context.ReleaseBuffer();
+		return hit;
+	}
+
+	inline bool Shape::FindClosestHit(Ray ray, Intersection& closestHit, RenderContext& context) {
+		if (transformIsActive) {
+			ray = ray.Transform(GetTransformRef().GetInverseAffine());
+		}
+
+		return FindObjectSpaceClosestHit(ray, closestHit, context);
+	}
+
+	inline bool Shape::FindObjectSpaceClosestHit(Ray ray, Intersection& closestHit, RenderContext& context) {
+		IntersectionBuffer& intersections = context.AcquireBuffer();
+		FindObjectSpaceIntersections(ray, intersections, context);
+
+		bool found = false;
+		size_t count = intersections.GetCount();
+
+		for (size_t index = 0; index < count; index++) {
+			const Intersection& intersection = intersections[index];
+
+			if (intersection.t >= 0.0 && intersection.t < closestHit.t) {
+				closestHit = intersection;
+				found = true;
+			}
+		}
+
+		context.ReleaseBuffer();
+		return found;
 	}
 
 	inline Vector Shape::SurfaceNormal(Point p, const Intersection& i) {
@@ -132,7 +257,30 @@ namespace RayTracer {
 	}
 
 
+	inline void Shape::UpdateWorldTransform() {
+		ComputeWorldTransform();
+	}
+
+	inline void Shape::ComputeWorldTransform() {
+		if (worldTransformIsValid) return;
+
+		Affine3x4 parentWorldToObject;
+
+		auto parentShape = GetParent();
+		if (parentShape) {
+			parentShape->ComputeWorldTransform();
+			parentWorldToObject = parentShape->worldToObject;
+		}
+
+		worldToObject = transformIsActive ? transform.GetInverseAffine() * parentWorldToObject : parentWorldToObject;
+		worldTransformIsValid = true;
+	}
+
 	inline Point Shape::PointToObjectSpace(Point p) {
+		if (worldTransformIsValid) {
+			return worldToObject * p;
+		}
+
 		//Handle the transforms of parent shapes
 		if (!parent.expired()) {
 			p = GetParent()->PointToObjectSpace(p);
@@ -140,16 +288,18 @@ namespace RayTracer {
 
 		//Only transform the point if a transform was set
 		if (transformIsActive) {
-			return transform.Inversion()* p;
+			return transform.GetInverseAffine() * p;
 		}
 
 		return p;
 	}
 
 	inline Vector Shape::NormalToWorldSpace(Vector normal) {
-		normal = transform.Inversion().GetMatrix().Transpose() * normal;
+		if (worldTransformIsValid) {
+			return worldToObject.TransformNormal(normal).Normalize();
+		}
 
-		normal.w = 0.0;
+		normal = transform.GetInverseAffine().TransformNormal(normal);
 		normal = normal.Normalize();
 
 		//Handle parent transforms
@@ -6,6 +6,8 @@
 #include "IntersectionBuffer.h"
 #include "Ray.h"
 #include "Shape.h"
+#include "BVHBuilder.h"
+#include "LinearBVH.h"
 
 namespace RayTracer {
 	//A Group of multiple shapes
@@ -17,6 +19,9 @@ namespace RayTracer {
 
 		//Virtual methods that need to be implemented
 		void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) override;
+		void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer, RenderContext& context) override;
+		bool FindObjectSpaceAnyHit(Ray ray, Real maximumT, RenderContext& context) override;
+		bool FindObjectSpaceClosestHit(Ray ray, Intersection& closestHit, RenderContext& context) override;
 
 		Vector FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) override;
 
@@ -25,16 +30,34 @@ namespace RayTracer {
 		void AddShape(std::shared_ptr<Shape> shape) {
 			shapes.push_back(shape); shape->SetParent(GetPointer());
 			bounds.Add(shape->GetParentSpaceBounds());
+			InvalidateAccelerationStructure();
 		}
 
 		BoundingBox GetObjectSpaceBounds() override { return bounds; }
 
+		//Split the group at the middle of its bounding box (Shapes that don't fit into either half stay in this group)
 		void PartitionChildren(size_t maximumShapeCount) override;
 
+		//Rebuild the group as a binary hierarchy with the binned surface area heuristic (Shapes with infinite bounds stay in this group)
+		void BuildHierarchy(const BVHBuildSettings& settings) override;
+
+		//Describe the group's current hierarchy (The settings only provide the costs used for the SAH cost)
+		BVHStatistics GetHierarchyStatistics(const BVHBuildSettings& settings = BVHBuildSettings());
+
+		//Flatten the group (and nested groups without transforms) into a LinearBVH, which is used for all following intersections
+		//Shapes that are added afterwards invalidate it until it is built again
+		void BuildAccelerationStructure(const BVHBuildSettings& settings = BVHBuildSettings()) override;
+		void InvalidateAccelerationStructure() override;
+		bool HasAccelerationStructure() const { return accelerationStructureIsValid; }
+
+		void UpdateWorldTransform() override;
+		void InvalidateWorldTransform() override;
+		const LinearBVH& GetAccelerationStructure() const { return accelerationStructure; }
+
 		void SetMaterial(Material newMaterial) override;
 
-		bool ContainsShape(std::shared_ptr<Shape> shape) override {
-			for (auto currentShape : shapes) {
+		bool ContainsShape(const Shape* shape) override {
+			for (const auto& currentShape : shapes) {
 				if (currentShape->ContainsShape(shape)) {
 					return true;
 				}
@@ -48,6 +71,18 @@ namespace RayTracer {
 
 		BoundingBox bounds;
 
+		LinearBVH accelerationStructure;
+		bool accelerationStructureIsValid = false;
+
+		//Add the shapes that share this group's coordinate system (Nested groups with transforms are kept as a single shape)
+		void CollectPrimitives(std::vector<Shape*>& primitives, const BVHBuildSettings& settings);
+
+		//Create the shape that represents a node of a finished hierarchy
+		static std::shared_ptr<Shape> CreateHierarchyNode(const BVHBuilder& builder, const std::vector<std::shared_ptr<Shape>>& primitives, size_t nodeIndex);
+
+		//areaScale converts the area of this group's bounds into the root's coordinate system
+		void CollectStatistics(BVHStatistics& statistics, const BVHBuildSettings& settings, size_t depth, Real rootArea, Real areaScale);
+
 		std::shared_ptr<Shape> ShapeSpecificCopy() override {
 			auto group = Shape::MakeShared<ShapeGroup>();
 
@@ -61,17 +96,57 @@ namespace RayTracer {
 	};
 
 	inline void ShapeGroup::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) {
-		IntersectionBuffer intersections;
+		RenderContext context;
+		FindObjectSpaceIntersections(ray, buffer, context);
+	}
+
+	inline void ShapeGroup::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer, RenderContext& context) {
+		//Compiled hierarchy is available
+		if (accelerationStructureIsValid) {
+			accelerationStructure.FindIntersections(ray, buffer, context);
+			return;
+		}
 
 		//The contained shapes only need to be checked when the bounding box is hit by the ray
 		if (bounds.CheckIntersection(ray)) {
 			//Find all intersections inside this group of shapes
 			for (auto currentShape : shapes) {
-				currentShape->FindIntersections(ray, buffer);
+				currentShape->FindIntersections(ray, buffer, context);
 			}
 		}
 	}
 
+	inline bool ShapeGroup::FindObjectSpaceAnyHit(Ray ray, Real maximumT, RenderContext& context) {
+		if (accelerationStructureIsValid) {
+			return accelerationStructure.FindAnyHit(ray, maximumT, context);
+		}
+
+		if (!bounds.CheckIntersection(ray, 0.0, maximumT)) return false;
+
+		for (auto& currentShape : shapes) {
+			if (currentShape->FindAnyHit(ray, maximumT, context)) return true;
+		}
+
+		return false;
+	}
+
+	inline bool ShapeGroup::FindObjectSpaceClosestHit(Ray ray, Intersection& closestHit, RenderContext& context) {
+		if (accelerationStructureIsValid) {
+			return accelerationStructure.FindClosestHit(ray, closestHit, context);
+		}
+
+		if (!bounds.CheckIntersection(ray, 0.0, closestHit.t)) return false;
+
+		bool found = false;
+
+		for (auto& currentShape : shapes) {
+			//Every hit that is found makes the search range shorter for the following shapes
+			if (currentShape->FindClosestHit(ray, closestHit, context)) found = true;
+		}
+
+		return found;
+	}
+
 	inline Vector ShapeGroup::FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) {
 		std::cerr << "Normal of Group\n";
 		return Vector::CreateVector(0.0, 0.0, 0.0);
@@ -137,6 +212,169 @@ namespace RayTracer {
 	}
 
 
+	inline void ShapeGroup::BuildHierarchy(const BVHBuildSettings& settings) {
+		//Subdivide nested groups first (Doesn't change their bounds)
+		for (auto& shape : shapes) {
+			shape->BuildHierarchy(settings);
+		}
+
+		std::vector<std::shared_ptr<Shape>> boundedShapes, unboundedShapes;
+		std::vector<BoundingBox> shapeBounds;
+
+		for (auto& shape : shapes) {
+			auto box = shape->GetParentSpaceBounds();
+
+			if (std::isfinite(box.SurfaceArea())) {
+				boundedShapes.push_back(shape);
+				shapeBounds.push_back(box);
+			}
+			else {
+				unboundedShapes.push_back(shape);
+			}
+		}
+
+		//Small enough already
+		if (boundedShapes.size() <= settings.maximumLeafSize) return;
+
+		BVHBuilder builder(settings);
+		builder.Build(shapeBounds);
+
+		//Rebuild this group from the hierarchy's root
+		shapes.clear();
+		bounds = BoundingBox();
+
+		for (auto& shape : unboundedShapes) {
+			AddShape(shape);
+		}
+
+		const auto& root = builder.GetNodes()[0];
+
+		if (root.IsLeaf()) {
+			for (auto& shape : boundedShapes) {
+				AddShape(shape);
+			}
+		}
+		else {
+			AddShape(CreateHierarchyNode(builder, boundedShapes, root.leftChild));
+			AddShape(CreateHierarchyNode(builder, boundedShapes, root.rightChild));
+		}
+	}
+
+	inline std::shared_ptr<Shape> ShapeGroup::CreateHierarchyNode(const BVHBuilder& builder, const std::vector<std::shared_ptr<Shape>>& primitives, size_t nodeIndex) {
+		const auto& node = builder.GetNodes()[nodeIndex];
+		const auto& order = builder.GetPrimitiveOrder();
+
+		//Leaves with a single shape don't need their own group
+		if (node.IsLeaf() && node.primitiveCount == 1) {
+			return primitives[order[node.firstPrimitive]];
+		}
+
+		auto group = Shape::MakeShared<ShapeGroup>();
+
+		if (node.IsLeaf()) {
+			for (size_t index = node.firstPrimitive; index < node.firstPrimitive + node.primitiveCount; index++) {
+				group->AddShape(primitives[order[index]]);
+			}
+		}
+		else {
+			group->AddShape(CreateHierarchyNode(builder, primitives, node.leftChild));
+			group->AddShape(CreateHierarchyNode(builder, primitives, node.rightChild));
+		}
+
+		return group;
+	}
+
+	inline BVHStatistics ShapeGroup::GetHierarchyStatistics(const BVHBuildSettings& settings) {
+		BVHStatistics statistics;
+		CollectStatistics(statistics, settings, 1, bounds.SurfaceArea(), 1.0);
+		return statistics;
+	}
+
+	inline void ShapeGroup::CollectStatistics(BVHStatistics& statistics, const BVHBuildSettings& settings, size_t depth, Real rootArea, Real areaScale) {
+		Real area = bounds.SurfaceArea() * areaScale;
+		Real relativeArea = (std::isfinite(area) && std::isfinite(rootArea) && rootArea > 0.0) ? area / rootArea : 1.0;
+
+		size_t primitiveCount = 0;
+		bool hasSubgroups = false;
+
+		for (auto& shape : shapes) {
+			auto group = std::dynamic_pointer_cast<ShapeGroup>(shape);
+
+			if (group) {
+				hasSubgroups = true;
+
+				//Transforms of nested groups change the size of their bounds
+				Real objectSpaceArea = group->GetObjectSpaceBounds().SurfaceArea();
+				Real parentSpaceArea = group->GetParentSpaceBounds().SurfaceArea();
+				Real scale = (objectSpaceArea > 0.0 && std::isfinite(parentSpaceArea / objectSpaceArea)) ? parentSpaceArea / objectSpaceArea : 1.0;
+
+				group->CollectStatistics(statistics, settings, depth + 1, rootArea, areaScale * scale);
+			}
+			else {
+				primitiveCount++;
+			}
+		}
+
+		if (hasSubgroups) {
+			statistics.AddInteriorNode(relativeArea, depth, settings);
+		}
+
+		//Shapes stored directly inside of a group are tested whenever the group is hit
+		if (primitiveCount != 0 || !hasSubgroups) {
+			statistics.AddLeaf(primitiveCount, relativeArea, depth, settings);
+		}
+	}
+
+	inline void ShapeGroup::BuildAccelerationStructure(const BVHBuildSettings& settings) {
+		if (accelerationStructureIsValid) return;
+
+		std::vector<Shape*> primitives;
+		CollectPrimitives(primitives, settings);
+
+		accelerationStructure.Build(primitives, settings);
+		accelerationStructureIsValid = true;
+	}
+
+	inline void ShapeGroup::InvalidateAccelerationStructure() {
+		accelerationStructureIsValid = false;
+		accelerationStructure.Clear();
+
+		//Parents may have flattened this group into their own structure
+		Shape::InvalidateAccelerationStructure();
+	}
+
+	inline void ShapeGroup::UpdateWorldTransform() {
+		Shape::UpdateWorldTransform();
+
+		//Children can be invalidated without their parent (Children that are still valid return immediately)
+		for (auto& shape : shapes) {
+			shape->UpdateWorldTransform();
+		}
+	}
+
+	inline void ShapeGroup::InvalidateWorldTransform() {
+		Shape::InvalidateWorldTransform();
+
+		for (auto& shape : shapes) {
+			shape->InvalidateWorldTransform();
+		}
+	}
+
+	inline void ShapeGroup::CollectPrimitives(std::vector<Shape*>& primitives, const BVHBuildSettings& settings) {
+		for (auto& shape : shapes) {
+			auto group = dynamic_cast<ShapeGroup*>(shape.get());
+
+			if (group && !group->HasTransform()) {
+				group->CollectPrimitives(primitives, settings);
+			}
+			else {
+				//Shapes with their own coordinate system compile their own structures
+				shape->BuildAccelerationStructure(settings);
+				primitives.push_back(shape.get());
+			}
+		}
+	}
+
 	inline void ShapeGroup::SetMaterial(Material newMaterial) {
 		material = newMaterial;
 
@@ -37,11 +37,11 @@ namespace RayTracer {
 		Vector sphereToRayOrigin = ray.origin - Point::CreatePoint(0.0, 0.0, 0.0);
 
 		//Calculating the discriminant
-		double a = Vector::DotProduct(ray.direction, ray.direction);
-		double b = 2.0 * Vector::DotProduct(ray.direction, sphereToRayOrigin);
-		double c = Vector::DotProduct(sphereToRayOrigin, sphereToRayOrigin) - 1.0;
+		Real a = Vector::DotProduct(ray.direction, ray.direction);
+		Real b = 2.0 * Vector::DotProduct(ray.direction, sphereToRayOrigin);
+		Real c = Vector::DotProduct(sphereToRayOrigin, sphereToRayOrigin) - 1.0;
 
-		double discriminant = (b * b) - (4.0 * a * c);
+		Real discriminant = (b * b) - (4.0 * a * c);
 
 
 		//No intersections
@@ -53,8 +53,8 @@ namespace RayTracer {
 		i1.t = (-b - sqrt(discriminant)) / (2.0 * a);
 		i2.t = (-b + sqrt(discriminant)) / (2.0 * a);
 
-		i1.shape = GetPointer();
-		i2.shape = GetPointer();
+		i1.shape = this;
+		i2.shape = this;
 
 		buffer.Add(i1);
 		buffer.Add(i2);
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace RayTracer {
+	//Distributes a number of independent tasks over multiple threads
+	class ThreadPool {
+	public:
+		//threadCount = 0 -> one thread per hardware thread
+		ThreadPool(size_t threadCount = 0);
+		~ThreadPool() = default;
+
+		size_t GetThreadCount() { return threadCount; }
+
+		//Execute task(taskIndex, threadIndex) once for every taskIndex in [0, taskCount)
+		//Returns after all tasks have been completed
+		void ParallelFor(size_t taskCount, const std::function<void(size_t taskIndex, size_t threadIndex)>& task);
+
+		static size_t GetHardwareThreadCount();
+
+	private:
+		size_t threadCount;
+
+		//Range of tasks owned by a thread, packed into 64 bits so it can be updated atomically
+		//(lower 32 bits: first remaining task, upper 32 bits: end of the range)
+		struct alignas(64) TaskRange {
+			std::atomic<uint64_t> range;
+		};
+
+		static uint64_t PackRange(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(end) << 32) | begin; }
+		static uint32_t RangeBegin(uint64_t range) { return static_cast<uint32_t>(range); }
+		static uint32_t RangeEnd(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+
+		//Take the next task from the front of a thread's own range
+		static bool PopTask(TaskRange& taskRange, size_t& taskIndex);
+		//Move the back half of another thread's range into an empty range
+		static bool StealTasks(TaskRange& victim, TaskRange& thief);
+	};
+
+
+	inline ThreadPool::ThreadPool(size_t threadCount) {
+		this->threadCount = (threadCount == 0) ? GetHardwareThreadCount() : threadCount;
+	}
+
+	inline size_t ThreadPool::GetHardwareThreadCount() {
+		size_t count = std::thread::hardware_concurrency();
+
+		//hardware_concurrency() may return 0 if the value is not computable
+		return (count == 0) ? 1 : count;
+	}
+
+	inline bool ThreadPool::PopTask(TaskRange& taskRange, size_t& taskIndex) {
+		uint64_t range = taskRange.range.load(std::memory_order_acquire);
+
+		while (RangeBegin(range) < RangeEnd(range)) {
+			uint64_t newRange = PackRange(RangeBegin(range) + 1, RangeEnd(range));
+
+			if (taskRange.range.compare_exchange_weak(range, newRange, std::memory_order_acq_rel)) {
+				taskIndex = RangeBegin(range);
+				return true;
+			}
+		}
+
+		//No tasks left
+		return false;
+	}
+
+	inline bool ThreadPool::StealTasks(TaskRange& victim, TaskRange& thief) {
+		uint64_t range = victim.range.load(std::memory_order_acquire);
+
+		while (RangeBegin(range) < RangeEnd(range)) {
+			uint32_t begin = RangeBegin(range);
+			uint32_t end = RangeEnd(range);
+			//Take the back half (at least one task), so the victim keeps working on adjacent tasks
+			uint32_t middle = begin + (end - begin) / 2;
+
+			if (victim.range.compare_exchange_weak(range, PackRange(begin, middle), std::memory_order_acq_rel)) {
+				thief.range.store(PackRange(middle, end), std::memory_order_release);
+				return true;
+			}
+		}
+
+		//Nothing to steal
+		return false;
+	}
+
+	inline void ThreadPool::ParallelFor(size_t taskCount, const std::function<void(size_t taskIndex, size_t threadIndex)>& task) {
+		if (taskCount == 0) return;
+
+		size_t workerCount = (threadCount < taskCount) ? threadCount : taskCount;
+
+		//Single thread -> no synchronisation needed
+		if (workerCount == 1) {
+			for (size_t taskIndex = 0; taskIndex < taskCount; taskIndex++) {
+				task(taskIndex, 0);
+			}
+			return;
+		}
+
+		//Every thread starts with a contiguous block of tasks
+		std::unique_ptr<TaskRange[]> ranges(new TaskRange[workerCount]);
+		for (size_t worker = 0; worker < workerCount; worker++) {
+			uint32_t begin = static_cast<uint32_t>(taskCount * worker / workerCount);
+			uint32_t end = static_cast<uint32_t>(taskCount * (worker + 1) / workerCount);
+			ranges[worker].range.store(PackRange(begin, end), std::memory_order_relaxed);
+		}
+
+		auto workerFunction = [&](size_t worker) {
+			size_t taskIndex;
+
+			while (true) {
+				//Work on own tasks first
+				while (PopTask(ranges[worker], taskIndex)) {
+					task(taskIndex, worker);
+				}
+
+				//Out of work -> try to steal from the other threads
+				bool stolen = false;
+				for (size_t offset = 1; offset < workerCount && !stolen; offset++) {
+					stolen = StealTasks(ranges[(worker + offset) % workerCount], ranges[worker]);
+				}
+
+				//All ranges are empty
+				if (!stolen) return;
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(workerCount - 1);
+
+		for (size_t worker = 1; worker < workerCount; worker++) {
+			threads.emplace_back(workerFunction, worker);
+		}
+
+		//The calling thread also takes part in the work
+		workerFunction(0);
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+}
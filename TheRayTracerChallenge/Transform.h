@@ -1,5 +1,6 @@
 #pragma once
 #include "Matrix.h"
+#include "Affine3x4.h"
 #include <cmath>
 
 namespace RayTracer {
@@ -10,6 +11,7 @@ namespace RayTracer {
 
 		Transform();
 		Transform(Matrix4x4 initialMatrix);
+		explicit Transform(const Affine3x4& initialMatrix);
 
 		~Transform() = default;
 
@@ -19,68 +21,86 @@ namespace RayTracer {
 		Transform Inversion();
 
 		//Creating Transforms
-		static Transform CreateTranslation(double x, double y, double z);
-		static Transform CreateScale(double x, double y, double z);
-		static Transform CreateRotationX(double angle);
-		static Transform CreateRotationY(double angle);
-		static Transform CreateRotationZ(double angle);
-		static Transform CreateShear(double xy, double xz, double yx, double yz, double zx, double zy);
+		static Transform CreateTranslation(Real x, Real y, Real z);
+		static Transform CreateScale(Real x, Real y, Real z);
+		static Transform CreateRotationX(Real angle);
+		static Transform CreateRotationY(Real angle);
+		static Transform CreateRotationZ(Real angle);
+		static Transform CreateShear(Real xy, Real xz, Real yx, Real yz, Real zx, Real zy);
 
 		//Applying translations to an existing transform
-		Transform& Translate(double x, double y, double z);
-		Transform& Scale(double x, double y, double z);
-		Transform& RotateX(double angle);
-		Transform& RotateY(double angle);
-		Transform& RotateZ(double angle);
-		Transform& Shear(double xy, double xz, double yx, double yz, double zx, double zy);
+		Transform& Translate(Real x, Real y, Real z);
+		Transform& Scale(Real x, Real y, Real z);
+		Transform& RotateX(Real angle);
+		Transform& RotateY(Real angle);
+		Transform& RotateZ(Real angle);
+		Transform& Shear(Real xy, Real xz, Real yx, Real yz, Real zx, Real zy);
 
-		void SetMatrix(Matrix4x4 newMatrix) { inverseIsCached = false; matrix = newMatrix; }
-		Matrix4x4 GetMatrix() { return matrix; }
+		void SetMatrix(Matrix4x4 newMatrix) { inverseIsCached = false; matrix = Affine3x4(newMatrix); }
+		Matrix4x4 GetMatrix() const { return matrix.ToMatrix(); }
+
+		//Direct access to the stored matrix and its inverse (No copies of the whole transform)
+		const Affine3x4& GetAffine() const { return matrix; }
+		const Affine3x4& GetInverseAffine();
 
 	private:
-		//The transformation matrix
-		Matrix4x4 matrix;
+		Transform(const Affine3x4& matrix, const Affine3x4& inverse);
+
+		//The transformation matrix (All transforms are affine, so the last row is not stored)
+		Affine3x4 matrix;
 
 		//Caching the transforms results in a 2x performance increase...
-		Matrix4x4 cachedInverse;
+		Affine3x4 cachedInverse;
 		bool inverseIsCached;
 	};
 
 
-	inline Transform::Transform() : matrix{ Matrix::IndentityMatrix4x4() }, cachedInverse{ Matrix::IndentityMatrix4x4() } {
+	inline Transform::Transform() {
 		//Identity matrix is it's own inversion
 		inverseIsCached = true;
 	}
 
-	inline Transform::Transform(Matrix4x4 initialMatrix) {
-		matrix = initialMatrix;
+	inline Transform::Transform(Matrix4x4 initialMatrix) : matrix{ initialMatrix } {
 		inverseIsCached = false;
 	}
 
-
-	inline Transform Transform::Invert() {
-		matrix = matrix.Inversion();
+	inline Transform::Transform(const Affine3x4& initialMatrix) : matrix{ initialMatrix } {
 		inverseIsCached = false;
-		return *this;
 	}
 
-	inline Transform Transform::Inversion() {
+	inline Transform::Transform(const Affine3x4& matrix, const Affine3x4& inverse) : matrix{ matrix }, cachedInverse{ inverse } {
+		inverseIsCached = true;
+	}
 
-		//Return cached inverse if available
-		if (inverseIsCached) {
-			return cachedInverse;
-		}
 
+	inline Transform Transform::Invert() {
+		//The old matrix is the inverse of the new one
+		Affine3x4 inverse = GetInverseAffine();
+		cachedInverse = matrix;
+		matrix = inverse;
+		return *this;
+	}
+
+	inline const Affine3x4& Transform::GetInverseAffine() {
 		//Only calculate the inverse if needed
-		cachedInverse = matrix.Inversion();
-		inverseIsCached = true;
+		if (!inverseIsCached) {
+			cachedInverse = matrix.Inversion();
+			inverseIsCached = true;
+		}
 
 		return cachedInverse;
 	}
 
+	inline Transform Transform::Inversion() {
+		const Affine3x4& inverse = GetInverseAffine();
+
+		//The inverse of the inverse is already known
+		return Transform(inverse, matrix);
+	}
+
 	//Creation of transforms
 
-	inline Transform Transform::CreateTranslation(double x, double y, double z) {
+	inline Transform Transform::CreateTranslation(Real x, Real y, Real z) {
 		Matrix4x4 matrix = Matrix::IndentityMatrix4x4();
 
 		matrix.elements[0][3] = x;
@@ -89,7 +109,7 @@ namespace RayTracer {
 		return Transform(matrix);
 	}
 
-	inline Transform Transform::CreateScale(double x, double y, double z) {
+	inline Transform Transform::CreateScale(Real x, Real y, Real z) {
 		Matrix4x4 matrix = Matrix::IndentityMatrix4x4();
 
 		matrix.elements[0][0] = x;
@@ -99,7 +119,7 @@ namespace RayTracer {
 		return Transform(matrix);
 	}
 
-	inline Transform Transform::CreateRotationX(double angle) {
+	inline Transform Transform::CreateRotationX(Real angle) {
 		Matrix4x4 matrix = Matrix::IndentityMatrix4x4();
 
 		matrix.elements[1][1] = cos(angle);
@@ -110,7 +130,7 @@ namespace RayTracer {
 		return Transform(matrix);
 	}
 
-	inline Transform Transform::CreateRotationY(double angle) {
+	inline Transform Transform::CreateRotationY(Real angle) {
 		Matrix4x4 matrix = Matrix::IndentityMatrix4x4();
 
 		matrix.elements[0][0] = cos(angle);
@@ -121,7 +141,7 @@ namespace RayTracer {
 		return Transform(matrix);
 	}
 
-	inline Transform Transform::CreateRotationZ(double angle) {
+	inline Transform Transform::CreateRotationZ(Real angle) {
 		Matrix4x4 matrix = Matrix::IndentityMatrix4x4();
 
 		matrix.elements[0][0] = cos(angle);
@@ -132,7 +152,7 @@ namespace RayTracer {
 		return Transform(matrix);
 	}
 
-	inline Transform Transform::CreateShear(double xy, double xz, double yx, double yz, double zx, double zy) {
+	inline Transform Transform::CreateShear(Real xy, Real xz, Real yx, Real yz, Real zx, Real zy) {
 		Matrix4x4 matrix = Matrix::IndentityMatrix4x4();
 
 		matrix.elements[0][1] = xy;
@@ -147,69 +167,69 @@ namespace RayTracer {
 		return Transform(matrix);
 	}
 
-	inline bool operator==(Transform transform1, Transform transform2) {
-		return transform1.GetMatrix() == transform2.GetMatrix();
+	inline bool operator==(const Transform& transform1, const Transform& transform2) {
+		return transform1.GetAffine() == transform2.GetAffine();
 	}
 
-	inline bool operator!=(Transform transform1, Transform transform2) {
+	inline bool operator!=(const Transform& transform1, const Transform& transform2) {
 		return !(transform1 == transform2);
 	}
 
 	//Multiplication of transforms with matrices and tuples
-	inline Tuple operator*(Tuple tuple, Transform transform) {
-		return tuple * transform.GetMatrix();
+	inline Tuple operator*(const Tuple& tuple, const Transform& transform) {
+		return transform.GetAffine() * tuple;
 	}
 
-	inline Tuple operator*(Transform transform, Tuple tuple) {
-		return transform.GetMatrix()* tuple;
+	inline Tuple operator*(const Transform& transform, const Tuple& tuple) {
+		return transform.GetAffine() * tuple;
 	}
 
-	inline Matrix4x4 operator*(Transform transform, Matrix4x4 matrix) {
-		return transform.GetMatrix()* matrix;
+	inline Matrix4x4 operator*(const Transform& transform, Matrix4x4 matrix) {
+		return transform.GetMatrix() * matrix;
 	}
 
-	inline Matrix4x4 operator*(Matrix4x4 matrix, Transform transform) {
+	inline Matrix4x4 operator*(Matrix4x4 matrix, const Transform& transform) {
 		return matrix * transform.GetMatrix();
 	}
 
-	inline Transform operator*(Transform transform1, Transform transform2) {
-		return Transform(transform1.GetMatrix() * transform2.GetMatrix());
+	inline Transform operator*(const Transform& transform1, const Transform& transform2) {
+		return Transform(transform1.GetAffine() * transform2.GetAffine());
 	}
 
 	//Applying transformations to an existing transform
 
-	inline Transform& Transform::Translate(double x, double y, double z) {
-		matrix = Transform::CreateTranslation(x, y, z) * matrix;
+	inline Transform& Transform::Translate(Real x, Real y, Real z) {
+		matrix = Transform::CreateTranslation(x, y, z).GetAffine() * matrix;
 		inverseIsCached = false;
 		return *this;
 	}
 
-	inline Transform& Transform::Scale(double x, double y, double z) {
-		matrix = Transform::CreateScale(x, y, z) * matrix;
+	inline Transform& Transform::Scale(Real x, Real y, Real z) {
+		matrix = Transform::CreateScale(x, y, z).GetAffine() * matrix;
 		inverseIsCached = false;
 		return *this;
 	}
 
-	inline Transform& Transform::RotateX(double angle) {
-		matrix = Transform::CreateRotationX(angle) * matrix;
+	inline Transform& Transform::RotateX(Real angle) {
+		matrix = Transform::CreateRotationX(angle).GetAffine() * matrix;
 		inverseIsCached = false;
 		return *this;
 	}
 
-	inline Transform& Transform::RotateY(double angle) {
-		matrix = Transform::CreateRotationY(angle) * matrix;
+	inline Transform& Transform::RotateY(Real angle) {
+		matrix = Transform::CreateRotationY(angle).GetAffine() * matrix;
 		inverseIsCached = false;
 		return *this;
 	}
 
-	inline Transform& Transform::RotateZ(double angle) {
-		matrix = Transform::CreateRotationZ(angle) * matrix;
+	inline Transform& Transform::RotateZ(Real angle) {
+		matrix = Transform::CreateRotationZ(angle).GetAffine() * matrix;
 		inverseIsCached = false;
 		return *this;
 	}
 
-	inline Transform& Transform::Shear(double xy, double xz, double yx, double yz, double zx, double zy) {
-		matrix = Transform::CreateShear(xy, xz, yx, yz, zx, zy) * matrix;
+	inline Transform& Transform::Shear(Real xy, Real xz, Real yx, Real yz, Real zx, Real zy) {
+		matrix = Transform::CreateShear(xy, xz, yx, yz, zx, zy).GetAffine() * matrix;
 		inverseIsCached = false;
 		return *this;
 	}
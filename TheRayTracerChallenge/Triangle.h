@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Shape.h"
+#include "Vector3.h"
+#include "TriangleIntersection.h"
 
 namespace RayTracer {
 	class Triangle : public Shape {
@@ -24,16 +26,21 @@ namespace RayTracer {
 
 		Vector GetNormal(size_t nr);
 
-		void SetNormals(Vector normal0, Vector normal1, Vector normal2) { n0 = normal0; n1 = normal1; n2 = normal2; }
+		void SetNormals(Vector normal0, Vector normal1, Vector normal2) { n0 = Vec3(normal0); n1 = Vec3(normal1); n2 = Vec3(normal2); }
+
+		TriangleIntersectionMode GetIntersectionMode() const { return intersectionMode; }
+		void SetIntersectionMode(TriangleIntersectionMode mode) { intersectionMode = mode; }
 
 	private:
-		Point p0, p1, p2;
-		Vector e0, e1, normal;
+		Point3 p0, p1, p2;
+		Vec3 e0, e1, normal;
 
 		//Normal vectors for smooth triangles
-		Vector n0, n1, n2;
+		Vec3 n0, n1, n2;
 		bool isSmoothTriangle;
 
+		TriangleIntersectionMode intersectionMode = TriangleIntersectionMode::Watertight;
+
 		void CalculateAttributes();
 
 		std::shared_ptr<Shape> ShapeSpecificCopy() override {
@@ -42,21 +49,21 @@ namespace RayTracer {
 	};
 
 	inline Triangle::Triangle(Point point0, Point point1, Point point2) {
-		p0 = point0;
-		p1 = point1;
-		p2 = point2;
+		p0 = Point3(point0);
+		p1 = Point3(point1);
+		p2 = Point3(point2);
 		isSmoothTriangle = false;
 		CalculateAttributes();
 	}
 
 	inline Triangle::Triangle(Point point0, Point point1, Point point2, Vector normal0, Vector normal1, Vector normal2) {
-		p0 = point0;
-		p1 = point1;
-		p2 = point2;
+		p0 = Point3(point0);
+		p1 = Point3(point1);
+		p2 = Point3(point2);
 
-		n0 = normal0;
-		n1 = normal1;
-		n2 = normal2;
+		n0 = Vec3(normal0);
+		n1 = Vec3(normal1);
+		n2 = Vec3(normal2);
 
 		isSmoothTriangle = true;
 
@@ -65,18 +72,18 @@ namespace RayTracer {
 
 	inline Point Triangle::GetPoint(size_t nr) {
 		switch (nr) {
-		case 0: return p0;
-		case 1: return p1;
-		case 2: return p2;
-		default: return p0;
+		case 0: return p0.ToTuple();
+		case 1: return p1.ToTuple();
+		case 2: return p2.ToTuple();
+		default: return p0.ToTuple();
 		}
 	}
 
 	inline Vector Triangle::GetEdge(size_t nr) {
 		switch (nr) {
-		case 0: return e0;
-		case 1: return e1;
-		default: return e0;
+		case 0: return e0.ToTuple();
+		case 1: return e1.ToTuple();
+		default: return e0.ToTuple();
 		}
 	}
 
@@ -84,7 +91,7 @@ namespace RayTracer {
 		e0 = p1 - p0;
 		e1 = p2 - p0;
 
-		normal = Vector::CrossProduct(e1, e0).Normalize();
+		normal = Vec3::CrossProduct(e1, e0).Normalize();
 	}
 
 	inline BoundingBox Triangle::GetObjectSpaceBounds() {
@@ -100,46 +107,57 @@ namespace RayTracer {
 	inline Vector Triangle::GetNormal(size_t nr) {
 		if (isSmoothTriangle) {
 			switch (nr) {
-			case 0: return n0;
-			case 1: return n1;
-			case 2: return n2;
+			case 0: return n0.ToTuple();
+			case 1: return n1.ToTuple();
+			case 2: return n2.ToTuple();
 			}
 		}
 
-		return normal;
+		return normal.ToTuple();
 	}
 
 	inline void Triangle::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) {
-		auto dirCrossE1 = Vector::CrossProduct(ray.direction, e1);
-		double det = Vector::DotProduct(e0, dirCrossE1);
+		if (intersectionMode == TriangleIntersectionMode::Watertight) {
+			Real t, u, v;
+			if (WatertightRay(ray).Intersect(p0, p1, p2, t, u, v)) {
+				buffer.Add(Intersection(t, this, u, v));
+			}
+			return;
+		}
+
+		Vec3 direction(ray.direction);
+
+		Vec3 dirCrossE1 = Vec3::CrossProduct(direction, e1);
+		Real det = Vec3::DotProduct(e0, dirCrossE1);
 		//No intersection
 		if (fabs(det) < Constants::EPSILON) return;
 
-		double f = 1.0 / det;
-		Vector p0ToOrigin = ray.origin - p0;
-		double u = f * Vector::DotProduct(p0ToOrigin, dirCrossE1);
+		Real f = 1.0 / det;
+		Vec3 p0ToOrigin = Point3(ray.origin) - p0;
+		Real u = f * Vec3::DotProduct(p0ToOrigin, dirCrossE1);
 		//No intersection
 		if (u < 0.0 || u > 1.0) return;
 
-		auto originCrossE0 = Vector::CrossProduct(p0ToOrigin, e0);
-		double v = f * Vector::DotProduct(ray.direction, originCrossE0);
+		Vec3 originCrossE0 = Vec3::CrossProduct(p0ToOrigin, e0);
+		Real v = f * Vec3::DotProduct(direction, originCrossE0);
 		//No intersection
 		if (v < 0.0 || u + v > 1.0) return;
 
-		double t = f * Vector::DotProduct(e1, originCrossE0);
+		Real t = f * Vec3::DotProduct(e1, originCrossE0);
 
 		//Ray intersects triangle
-		buffer.Add(Intersection(t, GetPointer(), u, v));
+		buffer.Add(Intersection(t, this, u, v));
 	}
 
 	inline Vector Triangle::FindObjectSpaceNormal(Point p, const Intersection & globalIntersection) {
 		if (isSmoothTriangle) {
-			return
+			return (
 				(n1 * globalIntersection.u)
 				+ (n2 * globalIntersection.v)
-				+ (n0 * (1.0 - globalIntersection.u - globalIntersection.v));
+				+ (n0 * (1.0 - globalIntersection.u - globalIntersection.v))
+				).ToTuple();
 		}
 
-		return normal;
+		return normal.ToTuple();
 	}
 }
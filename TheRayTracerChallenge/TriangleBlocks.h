@@ -0,0 +1,284 @@
+#pragma once
+
+#include "Constants.h"
+#include "Vector3.h"
+#include "LinearBVH.h"
+#include "TriangleIntersection.h"
+#include "SIMDLanes.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+namespace RayTracer {
+	//Triangles of one leaf stored as structure of arrays, so one ray can be tested against all of them at once
+	//The corners are stored instead of edges, so the watertight test sees exactly the vertices that neighbouring triangles share
+	//Unused lanes have NaN corners, so none of their comparisons is true and they never hit
+	struct alignas(32) TriangleBlock {
+		static constexpr size_t Width = 4;
+
+		Real p0[3][Width];
+		Real p1[3][Width];
+		Real p2[3][Width];
+	};
+
+	//Results of intersecting a ray with one block (Only valid for the lanes that are reported as hits)
+	struct TriangleBlockHits {
+		alignas(32) Real t[TriangleBlock::Width];
+		alignas(32) Real u[TriangleBlock::Width];
+		alignas(32) Real v[TriangleBlock::Width];
+	};
+
+	//Copy of a mesh's triangles in the order of its hierarchy's leaves
+	//Every leaf owns ceil(primitiveCount / Width) consecutive blocks
+	class TriangleBlocks {
+	public:
+		static constexpr size_t Width = TriangleBlock::Width;
+		static constexpr uint32_t NoTriangle = UINT32_MAX;
+
+		TriangleBlocks() = default;
+		~TriangleBlocks() = default;
+
+		//positions: x, y, z per vertex, vertexIndices: 3 per triangle (Same layout as MeshData)
+		void Build(const std::vector<Real>& positions, const std::vector<uint32_t>& vertexIndices, const LinearBVH& hierarchy);
+		void Clear();
+		bool IsEmpty() const { return blocks.empty(); }
+
+		size_t GetBlockCount() const { return blocks.size(); }
+		const TriangleBlock& GetBlock(size_t block) const { return blocks[block]; }
+
+		//Blocks of a leaf of the hierarchy the blocks were built for
+		uint32_t GetFirstBlock(uint32_t leafIndex) const { return firstBlocks[leafIndex]; }
+		static uint32_t GetBlockCount(const LinearBVHNode& leaf) { return static_cast<uint32_t>((leaf.primitiveCount + Width - 1) / Width); }
+
+		//Index of the mesh triangle in a lane (NoTriangle for unused lanes)
+		uint32_t GetTriangle(size_t block, size_t lane) const { return triangles[block * Width + lane]; }
+
+		//Möller-Trumbore test of the ray against all triangles of a block (Same algorithm as TriangleMesh::IntersectTriangle, the last bits can differ where the compiler contracts into FMA)
+		//Returns a bit mask of the lanes that are hit at a t in [tMin, tMax)
+		int Intersect(size_t block, const Point3& origin, const Vec3& direction, Real tMin, Real tMax, TriangleBlockHits& hits) const;
+		//Same for the watertight test (Same rounded operations as WatertightRay::Intersect, so the results are identical)
+		int IntersectWatertight(size_t block, const WatertightRay& ray, Real tMin, Real tMax, TriangleBlockHits& hits) const;
+
+	private:
+		std::vector<TriangleBlock> blocks;
+		std::vector<uint32_t> triangles;
+
+		//Indexed by node, only set for leaves
+		std::vector<uint32_t> firstBlocks;
+	};
+
+
+	//Kernels for the lane wrappers in SIMDLanes.h, each call tests Lanes::Count triangles of a block
+	namespace TriangleBlockLanes {
+		//Intersect the lanes [first, first + Lanes::Count) of a block
+		template<typename Lanes>
+		inline int Intersect(const TriangleBlock& block, size_t first, const Point3& origin, const Vec3& direction, Real tMin, Real tMax, TriangleBlockHits& hits) {
+			using Value = typename Lanes::Value;
+			using Mask = typename Lanes::Mask;
+
+			Value dx = Lanes::Broadcast(direction.x), dy = Lanes::Broadcast(direction.y), dz = Lanes::Broadcast(direction.z);
+			Value p0x = Lanes::Load(block.p0[0] + first), p0y = Lanes::Load(block.p0[1] + first), p0z = Lanes::Load(block.p0[2] + first);
+
+			Value e0x = Lanes::Sub(Lanes::Load(block.p1[0] + first), p0x);
+			Value e0y = Lanes::Sub(Lanes::Load(block.p1[1] + first), p0y);
+			Value e0z = Lanes::Sub(Lanes::Load(block.p1[2] + first), p0z);
+			Value e1x = Lanes::Sub(Lanes::Load(block.p2[0] + first), p0x);
+			Value e1y = Lanes::Sub(Lanes::Load(block.p2[1] + first), p0y);
+			Value e1z = Lanes::Sub(Lanes::Load(block.p2[2] + first), p0z);
+
+			//dirCrossE1 = direction x e1
+			Value cx = Lanes::Sub(Lanes::Mul(dy, e1z), Lanes::Mul(dz, e1y));
+			Value cy = Lanes::Sub(Lanes::Mul(dz, e1x), Lanes::Mul(dx, e1z));
+			Value cz = Lanes::Sub(Lanes::Mul(dx, e1y), Lanes::Mul(dy, e1x));
+
+			Value det = Lanes::Add(Lanes::Add(Lanes::Mul(e0x, cx), Lanes::Mul(e0y, cy)), Lanes::Mul(e0z, cz));
+			Mask hit = Lanes::AbsGreaterEqual(det, Lanes::Broadcast(Constants::EPSILON));
+
+			Value f = Lanes::Div(Lanes::Broadcast(1.0), det);
+
+			//p0ToOrigin
+			Value sx = Lanes::Sub(Lanes::Broadcast(origin.x), p0x);
+			Value sy = Lanes::Sub(Lanes::Broadcast(origin.y), p0y);
+			Value sz = Lanes::Sub(Lanes::Broadcast(origin.z), p0z);
+
+			Value u = Lanes::Mul(f, Lanes::Add(Lanes::Add(Lanes::Mul(sx, cx), Lanes::Mul(sy, cy)), Lanes::Mul(sz, cz)));
+			hit = Lanes::And(hit, Lanes::And(Lanes::GreaterEqual(u, Lanes::Broadcast(0.0)), Lanes::LessEqual(u, Lanes::Broadcast(1.0))));
+
+			//originCrossE0 = p0ToOrigin x e0
+			Value qx = Lanes::Sub(Lanes::Mul(sy, e0z), Lanes::Mul(sz, e0y));
+			Value qy = Lanes::Sub(Lanes::Mul(sz, e0x), Lanes::Mul(sx, e0z));
+			Value qz = Lanes::Sub(Lanes::Mul(sx, e0y), Lanes::Mul(sy, e0x));
+
+			Value v = Lanes::Mul(f, Lanes::Add(Lanes::Add(Lanes::Mul(dx, qx), Lanes::Mul(dy, qy)), Lanes::Mul(dz, qz)));
+			hit = Lanes::And(hit, Lanes::And(Lanes::GreaterEqual(v, Lanes::Broadcast(0.0)), Lanes::LessEqual(Lanes::Add(u, v), Lanes::Broadcast(1.0))));
+
+			Value t = Lanes::Mul(f, Lanes::Add(Lanes::Add(Lanes::Mul(e1x, qx), Lanes::Mul(e1y, qy)), Lanes::Mul(e1z, qz)));
+			hit = Lanes::And(hit, Lanes::And(Lanes::GreaterEqual(t, Lanes::Broadcast(tMin)), Lanes::Less(t, Lanes::Broadcast(tMax))));
+
+			Lanes::Store(hits.t + first, t);
+			Lanes::Store(hits.u + first, u);
+			Lanes::Store(hits.v + first, v);
+
+			return Lanes::ToBits(hit) << first;
+		}
+
+		RAYTRACER_CONTRACT_OFF
+
+		//Watertight test of the lanes [first, first + Lanes::Count) of a block
+		template<typename Lanes>
+		inline int IntersectWatertight(const TriangleBlock& block, size_t first, const WatertightRay& ray, Real tMin, Real tMax, TriangleBlockHits& hits) {
+			using Value = typename Lanes::Value;
+			using Mask = typename Lanes::Mask;
+
+			//The axes are permuted by picking the rows of the block
+			Value originX = Lanes::Broadcast(ray.origin[ray.kx]), originY = Lanes::Broadcast(ray.origin[ray.ky]), originZ = Lanes::Broadcast(ray.origin[ray.kz]);
+			Value shearX = Lanes::Broadcast(ray.shearX), shearY = Lanes::Broadcast(ray.shearY), shearZ = Lanes::Broadcast(ray.shearZ);
+
+			Value az = Lanes::Sub(Lanes::Load(block.p0[ray.kz] + first), originZ);
+			Value bz = Lanes::Sub(Lanes::Load(block.p1[ray.kz] + first), originZ);
+			Value cz = Lanes::Sub(Lanes::Load(block.p2[ray.kz] + first), originZ);
+
+			Value ax = Lanes::Sub(Lanes::Sub(Lanes::Load(block.p0[ray.kx] + first), originX), Lanes::MulRounded(shearX, az));
+			Value ay = Lanes::Sub(Lanes::Sub(Lanes::Load(block.p0[ray.ky] + first), originY), Lanes::MulRounded(shearY, az));
+			Value bx = Lanes::Sub(Lanes::Sub(Lanes::Load(block.p1[ray.kx] + first), originX), Lanes::MulRounded(shearX, bz));
+			Value by = Lanes::Sub(Lanes::Sub(Lanes::Load(block.p1[ray.ky] + first), originY), Lanes::MulRounded(shearY, bz));
+			Value cx = Lanes::Sub(Lanes::Sub(Lanes::Load(block.p2[ray.kx] + first), originX), Lanes::MulRounded(shearX, cz));
+			Value cy = Lanes::Sub(Lanes::Sub(Lanes::Load(block.p2[ray.ky] + first), originY), Lanes::MulRounded(shearY, cz));
+
+			Value edge0 = Lanes::Sub(Lanes::MulRounded(cx, by), Lanes::MulRounded(cy, bx));
+			Value edge1 = Lanes::Sub(Lanes::MulRounded(ax, cy), Lanes::MulRounded(ay, cx));
+			Value edge2 = Lanes::Sub(Lanes::MulRounded(bx, ay), Lanes::MulRounded(by, ax));
+
+			//All edge functions have the same sign (or are 0.0)
+			Value zero = Lanes::Broadcast(0.0);
+			Mask nonNegative = Lanes::And(Lanes::And(Lanes::GreaterEqual(edge0, zero), Lanes::GreaterEqual(edge1, zero)), Lanes::GreaterEqual(edge2, zero));
+			Mask nonPositive = Lanes::And(Lanes::And(Lanes::LessEqual(edge0, zero), Lanes::LessEqual(edge1, zero)), Lanes::LessEqual(edge2, zero));
+			Mask hit = Lanes::Or(nonNegative, nonPositive);
+
+			Value det = Lanes::Add(Lanes::Add(edge0, edge1), edge2);
+			hit = Lanes::And(hit, Lanes::NotEqual(det, zero));
+
+#if defined(RAYTRACER_USE_FLOAT)
+			//Lanes with an edge function of 0.0 need the double recompute of WatertightRay::Intersect
+			int edgeLanes = Lanes::ToBits(Lanes::Or(Lanes::Or(Lanes::Equal(edge0, zero), Lanes::Equal(edge1, zero)), Lanes::Equal(edge2, zero)));
+#endif
+
+			Value scaledT = Lanes::Add(Lanes::Add(
+				Lanes::MulRounded(edge0, Lanes::MulRounded(shearZ, az)),
+				Lanes::MulRounded(edge1, Lanes::MulRounded(shearZ, bz))),
+				Lanes::MulRounded(edge2, Lanes::MulRounded(shearZ, cz)));
+
+			Value inverseDet = Lanes::Div(Lanes::Broadcast(1.0), det);
+			Value t = Lanes::MulRounded(scaledT, inverseDet);
+			hit = Lanes::And(hit, Lanes::And(Lanes::GreaterEqual(t, Lanes::Broadcast(tMin)), Lanes::Less(t, Lanes::Broadcast(tMax))));
+
+			Lanes::Store(hits.t + first, t);
+			Lanes::Store(hits.u + first, Lanes::MulRounded(edge1, inverseDet));
+			Lanes::Store(hits.v + first, Lanes::MulRounded(edge2, inverseDet));
+
+			int hitLanes = Lanes::ToBits(hit);
+
+#if defined(RAYTRACER_USE_FLOAT)
+			for (size_t lane = 0; lane < Lanes::Count; lane++) {
+				if (!(edgeLanes & (1 << lane))) continue;
+
+				size_t index = first + lane;
+				Point3 p0(block.p0[0][index], block.p0[1][index], block.p0[2][index]);
+				Point3 p1(block.p1[0][index], block.p1[1][index], block.p1[2][index]);
+				Point3 p2(block.p2[0][index], block.p2[1][index], block.p2[2][index]);
+
+				Real t, u, v;
+				if (ray.Intersect(p0, p1, p2, t, u, v) && t >= tMin && t < tMax) {
+					hits.t[index] = t;
+					hits.u[index] = u;
+					hits.v[index] = v;
+					hitLanes |= 1 << lane;
+				}
+				else {
+					hitLanes &= ~(1 << lane);
+				}
+			}
+#endif
+
+			return hitLanes << first;
+		}
+
+		RAYTRACER_CONTRACT_ON
+	}
+
+
+	inline void TriangleBlocks::Build(const std::vector<Real>& positions, const std::vector<uint32_t>& vertexIndices, const LinearBVH& hierarchy) {
+		Clear();
+
+		const auto& nodes = hierarchy.GetNodes();
+		const auto& primitiveOrder = hierarchy.GetPrimitiveOrder();
+
+		firstBlocks.resize(nodes.size(), 0);
+
+		auto corner = [&](uint32_t triangle, size_t corner, size_t axis) {
+			return positions[3 * vertexIndices[3 * triangle + corner] + axis];
+		};
+
+		for (size_t nodeIndex = 0; nodeIndex < nodes.size(); nodeIndex++) {
+			const LinearBVHNode& node = nodes[nodeIndex];
+			if (!node.IsLeaf()) continue;
+
+			firstBlocks[nodeIndex] = static_cast<uint32_t>(blocks.size());
+
+			for (uint32_t first = 0; first < node.primitiveCount; first += Width) {
+				TriangleBlock block = {};
+
+				for (size_t lane = 0; lane < Width; lane++) {
+					if (first + lane >= node.primitiveCount) {
+						triangles.push_back(NoTriangle);
+
+						for (size_t axis = 0; axis < 3; axis++) {
+							block.p0[axis][lane] = block.p1[axis][lane] = block.p2[axis][lane] = std::numeric_limits<Real>::quiet_NaN();
+						}
+						continue;
+					}
+
+					uint32_t triangle = primitiveOrder[node.offset + first + lane];
+					triangles.push_back(triangle);
+
+					for (size_t axis = 0; axis < 3; axis++) {
+						block.p0[axis][lane] = corner(triangle, 0, axis);
+						block.p1[axis][lane] = corner(triangle, 1, axis);
+						block.p2[axis][lane] = corner(triangle, 2, axis);
+					}
+				}
+
+				blocks.push_back(block);
+			}
+		}
+	}
+
+	inline void TriangleBlocks::Clear() {
+		blocks.clear();
+		triangles.clear();
+		firstBlocks.clear();
+	}
+
+	inline int TriangleBlocks::Intersect(size_t block, const Point3& origin, const Vec3& direction, Real tMin, Real tMax, TriangleBlockHits& hits) const {
+		using Lanes = SIMDLanes::Default;
+
+		int hitLanes = 0;
+		for (size_t first = 0; first < Width; first += Lanes::Count) {
+			hitLanes |= TriangleBlockLanes::Intersect<Lanes>(blocks[block], first, origin, direction, tMin, tMax, hits);
+		}
+
+		return hitLanes;
+	}
+
+	inline int TriangleBlocks::IntersectWatertight(size_t block, const WatertightRay& ray, Real tMin, Real tMax, TriangleBlockHits& hits) const {
+		using Lanes = SIMDLanes::Default;
+
+		int hitLanes = 0;
+		for (size_t first = 0; first < Width; first += Lanes::Count) {
+			hitLanes |= TriangleBlockLanes::IntersectWatertight<Lanes>(blocks[block], first, ray, tMin, tMax, hits);
+		}
+
+		return hitLanes;
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Constants.h"
+#include "Vector3.h"
+#include "Ray.h"
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace RayTracer {
+	//Algorithm used to intersect rays with triangles
+	enum class TriangleIntersectionMode {
+		//Rejects rays that are (almost) parallel to the triangle, rays can slip through edges that are shared by two triangles
+		MollerTrumbore,
+		//Woop, Benthin and Wald: "Watertight Ray/Triangle Intersection" (2013)
+		//Rays that hit a shared edge or vertex always hit at least one of the triangles
+		Watertight
+	};
+
+	//Constants of the watertight test that only depend on the ray, so they are computed once per ray instead of once per triangle
+	//The ray is moved to the origin and sheared, so it points along the z axis. Hits are then found in 2D with edge functions
+	class WatertightRay {
+	public:
+		WatertightRay() = default;
+		explicit WatertightRay(const Ray& ray);
+
+		Point3 origin;
+
+		//kz: axis of the largest direction component, kx and ky the other two (Swapped to keep the winding of the triangles)
+		size_t kx = 0, ky = 1, kz = 2;
+		Real shearX = 0.0, shearY = 0.0, shearZ = 1.0;
+
+		//Same outputs as Möller-Trumbore (u: weight of p1, v: weight of p2). t isn't checked against any range
+		bool Intersect(const Point3& p0, const Point3& p1, const Point3& p2, Real& t, Real& u, Real& v) const;
+	};
+
+
+	inline WatertightRay::WatertightRay(const Ray& ray) : origin{ ray.origin } {
+		Vec3 direction(ray.direction);
+
+		kz = 0;
+		if (std::fabs(direction.y) > std::fabs(direction[kz])) kz = 1;
+		if (std::fabs(direction.z) > std::fabs(direction[kz])) kz = 2;
+
+		kx = (kz + 1) % 3;
+		ky = (kx + 1) % 3;
+		if (direction[kz] < 0.0) std::swap(kx, ky);
+
+		shearX = direction[kx] / direction[kz];
+		shearY = direction[ky] / direction[kz];
+		shearZ = 1.0 / direction[kz];
+	}
+
+	RAYTRACER_CONTRACT_OFF
+
+	inline bool WatertightRay::Intersect(const Point3& p0, const Point3& p1, const Point3& p2, Real& t, Real& u, Real& v) const {
+		//Every product is rounded before it is added, even if the compiler could use FMA instructions
+		//Otherwise the edge functions of neighbouring triangles are no exact negations, and TriangleBlocks finds different values
+		using Constants::MulRounded;
+
+		Vec3 a = p0 - origin;
+		Vec3 b = p1 - origin;
+		Vec3 c = p2 - origin;
+
+		Real ax = a[kx] - MulRounded(shearX, a[kz]);
+		Real ay = a[ky] - MulRounded(shearY, a[kz]);
+		Real bx = b[kx] - MulRounded(shearX, b[kz]);
+		Real by = b[ky] - MulRounded(shearY, b[kz]);
+		Real cx = c[kx] - MulRounded(shearX, c[kz]);
+		Real cy = c[ky] - MulRounded(shearY, c[kz]);
+
+		//Scaled barycentric coordinates (Exactly 0.0 on an edge, with the same value for both triangles that share it)
+		Real edge0 = MulRounded(cx, by) - MulRounded(cy, bx);
+		Real edge1 = MulRounded(ax, cy) - MulRounded(ay, cx);
+		Real edge2 = MulRounded(bx, ay) - MulRounded(by, ax);
+
+#if defined(RAYTRACER_USE_FLOAT)
+		//In single precision, edge functions that are 0.0 are recomputed with double products (Exact for float inputs, so contraction can't change them)
+		if (edge0 == 0.0f || edge1 == 0.0f || edge2 == 0.0f) {
+			edge0 = static_cast<Real>(static_cast<double>(cx) * by - static_cast<double>(cy) * bx);
+			edge1 = static_cast<Real>(static_cast<double>(ax) * cy - static_cast<double>(ay) * cx);
+			edge2 = static_cast<Real>(static_cast<double>(bx) * ay - static_cast<double>(by) * ax);
+		}
+#endif
+
+		//Ray passes outside of an edge (Both windings are hit)
+		bool anyNegative = edge0 < 0.0 || edge1 < 0.0 || edge2 < 0.0;
+		bool anyPositive = edge0 > 0.0 || edge1 > 0.0 || edge2 > 0.0;
+		if (anyNegative && anyPositive) return false;
+
+		//Ray is parallel to the triangle (or the triangle is degenerate)
+		Real det = edge0 + edge1 + edge2;
+		if (det == 0.0) return false;
+
+		Real scaledT = MulRounded(edge0, MulRounded(shearZ, a[kz])) + MulRounded(edge1, MulRounded(shearZ, b[kz])) + MulRounded(edge2, MulRounded(shearZ, c[kz]));
+
+		Real inverseDet = 1.0 / det;
+		t = MulRounded(scaledT, inverseDet);
+		u = MulRounded(edge1, inverseDet);
+		v = MulRounded(edge2, inverseDet);
+		return true;
+	}
+
+	RAYTRACER_CONTRACT_ON
+}
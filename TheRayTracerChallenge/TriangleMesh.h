@@ -0,0 +1,414 @@
+#pragma once
+
+#include "Shape.h"
+#include "LinearBVH.h"
+#include "TriangleBlocks.h"
+#include "TriangleIntersection.h"
+#include "Vector3.h"
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+namespace RayTracer {
+	//Vertices, normals and triangles of a mesh stored in flat arrays
+	struct MeshData {
+		//Marks triangle corners without a normal vector
+		static constexpr uint32_t NoNormal = std::numeric_limits<uint32_t>::max();
+
+		//x, y, z of every vertex / normal vector
+		std::vector<Real> positions;
+		std::vector<Real> normals;
+
+		//Three indices per triangle (Starting at 0)
+		std::vector<uint32_t> vertexIndices;
+		//Either empty or three indices per triangle (NoNormal for triangles without normal vectors)
+		std::vector<uint32_t> normalIndices;
+
+		size_t GetVertexCount() const { return positions.size() / 3; }
+		size_t GetNormalCount() const { return normals.size() / 3; }
+		size_t GetTriangleCount() const { return vertexIndices.size() / 3; }
+
+		//Append a triangle (Normal indices are only stored once the first triangle with normal vectors is added)
+		void AddTriangle(uint32_t vertex0, uint32_t vertex1, uint32_t vertex2,
+			uint32_t normal0 = NoNormal, uint32_t normal1 = NoNormal, uint32_t normal2 = NoNormal);
+
+		//Memory used by the arrays in bytes
+		size_t GetMemoryUsage() const {
+			return (positions.capacity() + normals.capacity()) * sizeof(Real)
+				+ (vertexIndices.capacity() + normalIndices.capacity()) * sizeof(uint32_t);
+		}
+	};
+
+	//A single shape that consists of many triangles
+	//The triangles share their vertices, normals and material, and are only addressed by their index
+	class TriangleMesh : public Shape {
+	public:
+		TriangleMesh() = default;
+		TriangleMesh(MeshData meshData);
+		~TriangleMesh() = default;
+
+		//Returns the index of the new vertex / normal
+		uint32_t AddVertex(Point p);
+		uint32_t AddNormal(Vector normal);
+
+		//Add a triangle using the indices of previously added vertices (and normals for smooth triangles)
+		void AddTriangle(uint32_t vertex0, uint32_t vertex1, uint32_t vertex2);
+		void AddTriangle(uint32_t vertex0, uint32_t vertex1, uint32_t vertex2, uint32_t normal0, uint32_t normal1, uint32_t normal2);
+
+		const MeshData& GetData() const { return data; }
+		size_t GetTriangleCount() const { return data.GetTriangleCount(); }
+
+		//Corner of a triangle (corner: 0 - 2)
+		Point GetPoint(size_t triangle, size_t corner) const { return GetCorner(triangle, corner).ToTuple(); }
+		bool IsSmoothTriangle(size_t triangle) const;
+
+		void FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) override;
+		bool FindObjectSpaceAnyHit(Ray ray, Real maximumT, RenderContext& context) override;
+		bool FindObjectSpaceClosestHit(Ray ray, Intersection& closestHit, RenderContext& context) override;
+
+		Vector FindObjectSpaceNormal(Point p, const Intersection& globalIntersection) override;
+
+		BoundingBox GetObjectSpaceBounds() override { return bounds; }
+
+		void PartitionChildren(size_t /*maximumShapeCount*/) override {}
+
+		//Build a hierarchy over the triangles (Without it every triangle is tested whenever the mesh's bounds are hit)
+		void BuildAccelerationStructure(const BVHBuildSettings& settings = BVHBuildSettings()) override;
+		void InvalidateAccelerationStructure() override;
+		bool HasAccelerationStructure() const { return hierarchyIsValid; }
+
+		//Hierarchy over the triangle indices (Empty until BuildAccelerationStructure was called)
+		const LinearBVH& GetAccelerationStructure() const { return hierarchy; }
+		//Use a hierarchy that was built before (Returns false if it doesn't match the triangles)
+		bool SetAccelerationStructure(std::vector<LinearBVHNode> nodes, std::vector<uint32_t> primitiveOrder);
+
+		//Test all triangles of a leaf at once (Default) or one after another (Only used to compare both)
+		//With blocks the hierarchy is built with larger leaves, so call this before BuildAccelerationStructure
+		void SetUseTriangleBlocks(bool useBlocks) { useTriangleBlocks = useBlocks; }
+
+		TriangleIntersectionMode GetIntersectionMode() const { return intersectionMode; }
+		void SetIntersectionMode(TriangleIntersectionMode mode) { intersectionMode = mode; }
+
+	private:
+		MeshData data;
+		BoundingBox bounds;
+
+		LinearBVH hierarchy;
+		bool hierarchyIsValid = false;
+
+		//Copy of the triangles in the order of the hierarchy's leaves (Built together with the hierarchy)
+		TriangleBlocks blocks;
+		bool useTriangleBlocks = true;
+
+		TriangleIntersectionMode intersectionMode = TriangleIntersectionMode::Watertight;
+
+		Point3 GetPosition(uint32_t vertex) const {
+			return Point3(data.positions[3 * vertex], data.positions[3 * vertex + 1], data.positions[3 * vertex + 2]);
+		}
+		Vec3 GetNormalVector(uint32_t normal) const {
+			return Vec3(data.normals[3 * normal], data.normals[3 * normal + 1], data.normals[3 * normal + 2]);
+		}
+		Point3 GetCorner(size_t triangle, size_t corner) const { return GetPosition(data.vertexIndices[3 * triangle + corner]); }
+
+		//Same algorithm as Triangle (Möller-Trumbore)
+		bool IntersectTriangle(uint32_t triangle, const Ray& ray, Real& t, Real& u, Real& v) const;
+
+		//Call visitTriangle(index) for every triangle that may be hit within [tMin, tMax] (Stops when it returns true)
+		template<typename TriangleFunction>
+		void ForEachCandidate(const Ray& ray, Real tMin, const Real& tMax, TriangleFunction&& visitTriangle);
+
+		//Call visitHit(triangle, t, u, v) for every triangle that is hit at a t in [tMin, tMax) (Stops when it returns true)
+		//tMax is read again after every leaf, so visitors can shrink it
+		template<typename HitFunction>
+		void ForEachHit(const Ray& ray, Real tMin, const Real& tMax, HitFunction&& visitHit);
+		//intersectTriangle(triangle, t, u, v) and intersectBlock(block, hits) implement the test of the intersection mode
+		template<typename HitFunction, typename TriangleTest, typename BlockTest>
+		void ForEachHit(const Ray& ray, Real tMin, const Real& tMax, HitFunction&& visitHit, TriangleTest&& intersectTriangle, BlockTest&& intersectBlock);
+
+		std::shared_ptr<Shape> ShapeSpecificCopy() override {
+			return Shape::MakeShared<TriangleMesh>(*this);
+		}
+	};
+
+
+	inline void MeshData::AddTriangle(uint32_t vertex0, uint32_t vertex1, uint32_t vertex2, uint32_t normal0, uint32_t normal1, uint32_t normal2) {
+		bool hasNormals = normal0 != NoNormal && normal1 != NoNormal && normal2 != NoNormal;
+
+		bool storeNormals = hasNormals || !normalIndices.empty();
+
+		//Previous triangles don't have normal vectors
+		if (storeNormals) {
+			normalIndices.resize(vertexIndices.size(), NoNormal);
+		}
+
+		vertexIndices.push_back(vertex0);
+		vertexIndices.push_back(vertex1);
+		vertexIndices.push_back(vertex2);
+
+		if (storeNormals) {
+			normalIndices.push_back(hasNormals ? normal0 : NoNormal);
+			normalIndices.push_back(hasNormals ? normal1 : NoNormal);
+			normalIndices.push_back(hasNormals ? normal2 : NoNormal);
+		}
+	}
+
+
+	inline TriangleMesh::TriangleMesh(MeshData meshData) : data{ std::move(meshData) } {
+		for (uint32_t index : data.vertexIndices) {
+			bounds.Add(GetPosition(index));
+		}
+	}
+
+	inline uint32_t TriangleMesh::AddVertex(Point p) {
+		data.positions.push_back(p.x);
+		data.positions.push_back(p.y);
+		data.positions.push_back(p.z);
+
+		return static_cast<uint32_t>(data.GetVertexCount() - 1);
+	}
+
+	inline uint32_t TriangleMesh::AddNormal(Vector normal) {
+		data.normals.push_back(normal.x);
+		data.normals.push_back(normal.y);
+		data.normals.push_back(normal.z);
+
+		return static_cast<uint32_t>(data.GetNormalCount() - 1);
+	}
+
+	inline void TriangleMesh::AddTriangle(uint32_t vertex0, uint32_t vertex1, uint32_t vertex2) {
+		AddTriangle(vertex0, vertex1, vertex2, MeshData::NoNormal, MeshData::NoNormal, MeshData::NoNormal);
+	}
+
+	inline void TriangleMesh::AddTriangle(uint32_t vertex0, uint32_t vertex1, uint32_t vertex2, uint32_t normal0, uint32_t normal1, uint32_t normal2) {
+		data.AddTriangle(vertex0, vertex1, vertex2, normal0, normal1, normal2);
+
+		bounds.Add(GetPosition(vertex0));
+		bounds.Add(GetPosition(vertex1));
+		bounds.Add(GetPosition(vertex2));
+
+		InvalidateAccelerationStructure();
+	}
+
+	inline bool TriangleMesh::IsSmoothTriangle(size_t triangle) const {
+		return !data.normalIndices.empty() && data.normalIndices[3 * triangle] != MeshData::NoNormal;
+	}
+
+	inline bool TriangleMesh::IntersectTriangle(uint32_t triangle, const Ray& ray, Real& t, Real& u, Real& v) const {
+		Point3 p0 = GetPosition(data.vertexIndices[3 * triangle]);
+		Vec3 e0 = GetPosition(data.vertexIndices[3 * triangle + 1]) - p0;
+		Vec3 e1 = GetPosition(data.vertexIndices[3 * triangle + 2]) - p0;
+		Vec3 direction(ray.direction);
+
+		Vec3 dirCrossE1 = Vec3::CrossProduct(direction, e1);
+		Real det = Vec3::DotProduct(e0, dirCrossE1);
+		//No intersection
+		if (fabs(det) < Constants::EPSILON) return false;
+
+		Real f = 1.0 / det;
+		Vec3 p0ToOrigin = Point3(ray.origin) - p0;
+		u = f * Vec3::DotProduct(p0ToOrigin, dirCrossE1);
+		//No intersection
+		if (u < 0.0 || u > 1.0) return false;
+
+		Vec3 originCrossE0 = Vec3::CrossProduct(p0ToOrigin, e0);
+		v = f * Vec3::DotProduct(direction, originCrossE0);
+		//No intersection
+		if (v < 0.0 || u + v > 1.0) return false;
+
+		t = f * Vec3::DotProduct(e1, originCrossE0);
+		return true;
+	}
+
+	template<typename TriangleFunction>
+	inline void TriangleMesh::ForEachCandidate(const Ray& ray, Real tMin, const Real& tMax, TriangleFunction&& visitTriangle) {
+		if (hierarchyIsValid) {
+			hierarchy.Traverse(ray, tMin, tMax, visitTriangle);
+			return;
+		}
+
+		if (!bounds.CheckIntersection(ray, tMin, tMax)) return;
+
+		uint32_t triangleCount = static_cast<uint32_t>(GetTriangleCount());
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+			if (visitTriangle(triangle)) return;
+		}
+	}
+
+	template<typename HitFunction>
+	inline void TriangleMesh::ForEachHit(const Ray& ray, Real tMin, const Real& tMax, HitFunction&& visitHit) {
+		if (intersectionMode == TriangleIntersectionMode::Watertight) {
+			//The shear constants are computed once and used for every triangle of the mesh
+			WatertightRay watertightRay(ray);
+
+			ForEachHit(ray, tMin, tMax, visitHit,
+				[&](uint32_t triangle, Real& t, Real& u, Real& v) {
+					return watertightRay.Intersect(GetCorner(triangle, 0), GetCorner(triangle, 1), GetCorner(triangle, 2), t, u, v);
+				},
+				[&](uint32_t block, TriangleBlockHits& hits) {
+					return blocks.IntersectWatertight(block, watertightRay, tMin, tMax, hits);
+				});
+			return;
+		}
+
+		Point3 origin(ray.origin);
+		Vec3 direction(ray.direction);
+
+		ForEachHit(ray, tMin, tMax, visitHit,
+			[&](uint32_t triangle, Real& t, Real& u, Real& v) {
+				return IntersectTriangle(triangle, ray, t, u, v);
+			},
+			[&](uint32_t block, TriangleBlockHits& hits) {
+				return blocks.Intersect(block, origin, direction, tMin, tMax, hits);
+			});
+	}
+
+	template<typename HitFunction, typename TriangleTest, typename BlockTest>
+	inline void TriangleMesh::ForEachHit(const Ray& ray, Real tMin, const Real& tMax, HitFunction&& visitHit, TriangleTest&& intersectTriangle, BlockTest&& intersectBlock) {
+		if (!hierarchyIsValid || !useTriangleBlocks || blocks.IsEmpty()) {
+			ForEachCandidate(ray, tMin, tMax, [&](uint32_t triangle) {
+				Real t, u, v;
+				return intersectTriangle(triangle, t, u, v) && t >= tMin && t < tMax && visitHit(triangle, t, u, v);
+			});
+			return;
+		}
+
+		TriangleBlockHits hits;
+
+		hierarchy.TraverseLeaves(ray, tMin, tMax, [&](uint32_t nodeIndex, const LinearBVHNode& leaf) {
+			uint32_t firstBlock = blocks.GetFirstBlock(nodeIndex);
+			uint32_t lastBlock = firstBlock + TriangleBlocks::GetBlockCount(leaf);
+
+			for (uint32_t block = firstBlock; block < lastBlock; block++) {
+				int hitLanes = intersectBlock(block, hits);
+
+				//Lanes are reported in the same order as ForEachCandidate visits the triangles
+				for (size_t lane = 0; hitLanes != 0; lane++, hitLanes >>= 1) {
+					if ((hitLanes & 1) && visitHit(blocks.GetTriangle(block, lane), hits.t[lane], hits.u[lane], hits.v[lane])) return true;
+				}
+			}
+			return false;
+		});
+	}
+
+	inline void TriangleMesh::FindObjectSpaceIntersections(Ray ray, IntersectionBuffer& buffer) {
+		const Real maximumT = std::numeric_limits<Real>::infinity();
+
+		ForEachHit(ray, -maximumT, maximumT, [&](uint32_t triangle, Real t, Real u, Real v) {
+			buffer.Add(Intersection(t, this, u, v, triangle));
+			return false;
+		});
+	}
+
+	inline bool TriangleMesh::FindObjectSpaceAnyHit(Ray ray, Real maximumT, RenderContext& /*context*/) {
+		bool hit = false;
+
+		ForEachHit(ray, 0.0, maximumT, [&](uint32_t, Real, Real, Real) {
+			hit = true;
+			return true;
+		});
+
+		return hit;
+	}
+
+	inline bool TriangleMesh::FindObjectSpaceClosestHit(Ray ray, Intersection& closestHit, RenderContext& /*context*/) {
+		Real maximumT = closestHit.t;
+		Real closestU = 0.0, closestV = 0.0;
+		uint32_t closestTriangle = 0;
+		bool found = false;
+
+		//Every hit shortens the search range for the remaining triangles
+		ForEachHit(ray, 0.0, maximumT, [&](uint32_t triangle, Real t, Real u, Real v) {
+			//Hits of the same leaf are found before maximumT shrinks
+			if (t < maximumT) {
+				maximumT = t;
+				closestU = u;
+				closestV = v;
+				closestTriangle = triangle;
+				found = true;
+			}
+			return false;
+		});
+
+		//The intersection is only created for the final hit
+		if (found) {
+			closestHit = Intersection(maximumT, this, closestU, closestV, closestTriangle);
+		}
+
+		return found;
+	}
+
+	inline Vector TriangleMesh::FindObjectSpaceNormal(Point /*p*/, const Intersection& globalIntersection) {
+		size_t triangle = globalIntersection.primitiveIndex;
+
+		if (IsSmoothTriangle(triangle)) {
+			Vec3 n0 = GetNormalVector(data.normalIndices[3 * triangle]);
+			Vec3 n1 = GetNormalVector(data.normalIndices[3 * triangle + 1]);
+			Vec3 n2 = GetNormalVector(data.normalIndices[3 * triangle + 2]);
+
+			return (
+				(n1 * globalIntersection.u)
+				+ (n2 * globalIntersection.v)
+				+ (n0 * (1.0 - globalIntersection.u - globalIntersection.v))
+				).ToTuple();
+		}
+
+		Point3 p0 = GetCorner(triangle, 0);
+		Vec3 e0 = GetCorner(triangle, 1) - p0;
+		Vec3 e1 = GetCorner(triangle, 2) - p0;
+
+		return Vec3::CrossProduct(e1, e0).Normalize().ToTuple();
+	}
+
+	inline void TriangleMesh::BuildAccelerationStructure(const BVHBuildSettings& settings) {
+		if (hierarchyIsValid) return;
+
+		std::vector<BoundingBox> triangleBounds;
+		triangleBounds.reserve(GetTriangleCount());
+
+		for (size_t triangle = 0; triangle < GetTriangleCount(); triangle++) {
+			BoundingBox box;
+			box.Add(GetCorner(triangle, 0));
+			box.Add(GetCorner(triangle, 1));
+			box.Add(GetCorner(triangle, 2));
+			triangleBounds.push_back(box);
+		}
+
+		if (!useTriangleBlocks) {
+			hierarchy.Build(triangleBounds, settings);
+			hierarchyIsValid = true;
+			return;
+		}
+
+		//A block costs about as much as a single triangle, so leaves should fill their blocks
+		BVHBuildSettings blockSettings = settings;
+		blockSettings.primitiveBlockSize = TriangleBlocks::Width;
+		blockSettings.maximumLeafSize = std::max(settings.maximumLeafSize, 2 * TriangleBlocks::Width);
+
+		hierarchy.Build(triangleBounds, blockSettings);
+		hierarchyIsValid = true;
+
+		blocks.Build(data.positions, data.vertexIndices, hierarchy);
+	}
+
+	inline bool TriangleMesh::SetAccelerationStructure(std::vector<LinearBVHNode> nodes, std::vector<uint32_t> primitiveOrder) {
+		InvalidateAccelerationStructure();
+
+		hierarchyIsValid = hierarchy.SetNodes(std::move(nodes), std::move(primitiveOrder), GetTriangleCount());
+
+		if (hierarchyIsValid && useTriangleBlocks) {
+			blocks.Build(data.positions, data.vertexIndices, hierarchy);
+		}
+		return hierarchyIsValid;
+	}
+
+	inline void TriangleMesh::InvalidateAccelerationStructure() {
+		if (hierarchyIsValid) {
+			hierarchyIsValid = false;
+			hierarchy.Clear();
+			blocks.Clear();
+		}
+
+		Shape::InvalidateAccelerationStructure();
+	}
+}
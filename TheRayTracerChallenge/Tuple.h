@@ -7,22 +7,22 @@ namespace RayTracer {
 	class Tuple
 	{
 	public:
-		double x, y, z, w;
+		Real x, y, z, w;
 
 		Tuple();
-		Tuple(double x, double y, double z, double w);
+		Tuple(Real x, Real y, Real z, Real w);
 		~Tuple() = default;
 
 		//Creates a point (w = 1.0f)
-		static Tuple CreatePoint(double x, double y, double z);
+		static Tuple CreatePoint(Real x, Real y, Real z);
 		//Creates a vector (w = 0.0f)
-		static Tuple CreateVector(double x, double y, double z);
+		static Tuple CreateVector(Real x, Real y, Real z);
 		//Calculating the dot product
-		static double DotProduct(Tuple t1, Tuple t2);
+		static Real DotProduct(Tuple t1, Tuple t2);
 		//Calculating the cross product
 		static Tuple CrossProduct(Tuple t1, Tuple t2);
 		//Calculate a vector's magnitude
-		double Magnitude();
+		Real Magnitude();
 		//Normalize a vector (-> Magnitude = 1.0)
 		Tuple Normalize();
 
@@ -39,8 +39,8 @@ namespace RayTracer {
 		Tuple operator+ (const Tuple t) const;
 		Tuple operator- (const Tuple t) const;
 		Tuple operator- () const;
-		Tuple operator* (const double t) const;
-		Tuple operator/ (const double t) const;
+		Tuple operator* (const Real t) const;
+		Tuple operator/ (const Real t) const;
 	};
 
 	//Aliases of the Tuple class
@@ -53,7 +53,7 @@ namespace RayTracer {
 		x = y = z = w = 0.0;
 	}
 
-	inline Tuple::Tuple(double x, double y, double z, double w)
+	inline Tuple::Tuple(Real x, Real y, Real z, Real w)
 	{
 		this->x = x;
 		this->y = y;
@@ -61,17 +61,17 @@ namespace RayTracer {
 		this->w = w;
 	}
 
-	inline Tuple Tuple::CreatePoint(double x, double y, double z)
+	inline Tuple Tuple::CreatePoint(Real x, Real y, Real z)
 	{
 		return Tuple(x, y, z, 1.0);
 	}
 
-	inline Tuple Tuple::CreateVector(double x, double y, double z)
+	inline Tuple Tuple::CreateVector(Real x, Real y, Real z)
 	{
 		return Tuple(x, y, z, 0.0);
 	}
 
-	inline double Tuple::DotProduct(Tuple t1, Tuple t2)
+	inline Real Tuple::DotProduct(Tuple t1, Tuple t2)
 	{
 		return
 			(t1.x * t2.x) +
@@ -89,7 +89,7 @@ namespace RayTracer {
 		);
 	}
 
-	inline double Tuple::Magnitude()
+	inline Real Tuple::Magnitude()
 	{
 		return sqrt(
 			(x * x) +
@@ -101,7 +101,7 @@ namespace RayTracer {
 
 	inline Tuple Tuple::Normalize()
 	{
-		double magnitude = Magnitude();
+		Real magnitude = Magnitude();
 
 		//Works with any number that is not exactly = 0.0
 		if (magnitude != 0.0) {
@@ -159,12 +159,12 @@ namespace RayTracer {
 		return Tuple(-x, -y, -z, -w);
 	}
 
-	inline Tuple Tuple::operator*(const double t) const
+	inline Tuple Tuple::operator*(const Real t) const
 	{
 		return Tuple(x * t, y * t, z * t, w * t);
 	}
 
-	inline Tuple Tuple::operator/(const double t) const
+	inline Tuple Tuple::operator/(const Real t) const
 	{
 		return Tuple(x / t, y / t, z / t, w / t);
 	}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Constants.h"
+#include "Tuple.h"
+#include <cmath>
+#include <cstddef>
+
+namespace RayTracer {
+	//Points and vectors with three components (Tuple additionally stores w, which costs memory in meshes and hierarchies)
+	//The types are kept apart, so e.g. adding two points doesn't compile
+	class Vec3 {
+	public:
+		Real x, y, z;
+
+		Vec3() : x{ 0.0 }, y{ 0.0 }, z{ 0.0 } {}
+		Vec3(Real x, Real y, Real z) : x{ x }, y{ y }, z{ z } {}
+		//w is ignored
+		explicit Vec3(const Tuple& vector) : x{ vector.x }, y{ vector.y }, z{ vector.z } {}
+
+		//Adapter for code that still works with tuples (w = 0.0)
+		Tuple ToTuple() const { return Tuple::CreateVector(x, y, z); }
+
+		static Real DotProduct(const Vec3& v1, const Vec3& v2) { return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z; }
+		static Vec3 CrossProduct(const Vec3& v1, const Vec3& v2);
+
+		Real Magnitude() const { return std::sqrt(DotProduct(*this, *this)); }
+		Vec3 Normalize() const;
+
+		Real operator[](size_t axis) const { return (&x)[axis]; }
+		Real& operator[](size_t axis) { return (&x)[axis]; }
+
+		bool operator==(const Vec3& v) const;
+		bool operator!=(const Vec3& v) const { return !(*this == v); }
+		Vec3 operator+(const Vec3& v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+		Vec3 operator-(const Vec3& v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+		Vec3 operator-() const { return Vec3(-x, -y, -z); }
+		Vec3 operator*(Real factor) const { return Vec3(x * factor, y * factor, z * factor); }
+		Vec3 operator/(Real divisor) const { return Vec3(x / divisor, y / divisor, z / divisor); }
+	};
+
+	class Point3 {
+	public:
+		Real x, y, z;
+
+		Point3() : x{ 0.0 }, y{ 0.0 }, z{ 0.0 } {}
+		Point3(Real x, Real y, Real z) : x{ x }, y{ y }, z{ z } {}
+		//w is ignored
+		explicit Point3(const Tuple& point) : x{ point.x }, y{ point.y }, z{ point.z } {}
+
+		//Adapter for code that still works with tuples (w = 1.0)
+		Tuple ToTuple() const { return Tuple::CreatePoint(x, y, z); }
+
+		//Smallest / largest components of both points
+		static Point3 Min(const Point3& p1, const Point3& p2);
+		static Point3 Max(const Point3& p1, const Point3& p2);
+
+		Real operator[](size_t axis) const { return (&x)[axis]; }
+		Real& operator[](size_t axis) { return (&x)[axis]; }
+
+		bool operator==(const Point3& p) const;
+		bool operator!=(const Point3& p) const { return !(*this == p); }
+		//Only the operations that are meaningful for points
+		Vec3 operator-(const Point3& p) const { return Vec3(x - p.x, y - p.y, z - p.z); }
+		Point3 operator+(const Vec3& v) const { return Point3(x + v.x, y + v.y, z + v.z); }
+		Point3 operator-(const Vec3& v) const { return Point3(x - v.x, y - v.y, z - v.z); }
+	};
+
+
+	inline Vec3 Vec3::CrossProduct(const Vec3& v1, const Vec3& v2) {
+		return Vec3(
+			v1.y * v2.z - v1.z * v2.y,
+			v1.z * v2.x - v1.x * v2.z,
+			v1.x * v2.y - v1.y * v2.x
+		);
+	}
+
+	inline Vec3 Vec3::Normalize() const {
+		return *this / Magnitude();
+	}
+
+	inline bool Vec3::operator==(const Vec3& v) const {
+		return
+			Constants::DoubleEqual(x, v.x)
+			&& Constants::DoubleEqual(y, v.y)
+			&& Constants::DoubleEqual(z, v.z);
+	}
+
+	inline Point3 Point3::Min(const Point3& p1, const Point3& p2) {
+		return Point3(
+			(p1.x < p2.x) ? p1.x : p2.x,
+			(p1.y < p2.y) ? p1.y : p2.y,
+			(p1.z < p2.z) ? p1.z : p2.z
+		);
+	}
+
+	inline Point3 Point3::Max(const Point3& p1, const Point3& p2) {
+		return Point3(
+			(p1.x > p2.x) ? p1.x : p2.x,
+			(p1.y > p2.y) ? p1.y : p2.y,
+			(p1.z > p2.z) ? p1.z : p2.z
+		);
+	}
+
+	inline bool Point3::operator==(const Point3& p) const {
+		return
+			Constants::DoubleEqual(x, p.x)
+			&& Constants::DoubleEqual(y, p.y)
+			&& Constants::DoubleEqual(z, p.z);
+	}
+}
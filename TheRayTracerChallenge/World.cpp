@@ -4,6 +4,8 @@
 RayTracer::World::World()
 {
 	numberOfRaysCast = 0;
+	accelerationStructureIsValid = false;
+	compiledChangeCount = 0;
 }
 
 
@@ -15,6 +17,7 @@ void RayTracer::World::LoadDefaultWorld()
 {
 	lightSources.clear();
 	shapes.clear();
+	accelerationStructureIsValid = false;
 
 	//Create default light source    
 	LightSource l(Point::CreatePoint(-10.0, 10.0, -10.0), Color(1.0, 1.0, 1.0));
@@ -39,33 +42,79 @@ void RayTracer::World::LoadDefaultWorld()
 }
 
 
-void RayTracer::World::IntersectRay(Ray ray, IntersectionBuffer& buffer)
+void RayTracer::World::IntersectRay(Ray ray, IntersectionBuffer& buffer, RenderContext& context)
 {
-	numberOfRaysCast++;
+	context.GetStatistics().raysCast++;
+	FindAllIntersections(ray, buffer, context);
+}
 
-    for (auto currentShape : shapes) {
-		currentShape->FindIntersections(ray, buffer);
+bool RayTracer::World::FindClosestHit(Ray ray, Intersection& closestHit, RenderContext& context)
+{
+	context.GetStatistics().raysCast++;
+	return FindClosestIntersection(ray, closestHit, context);
+}
+
+void RayTracer::World::FindAllIntersections(const Ray& ray, IntersectionBuffer& buffer, RenderContext& context)
+{
+	//Only shapes whose bounding boxes are hit need to be tested
+	if (HasAccelerationStructure()) {
+		accelerationStructure.FindIntersections(ray, buffer, context);
+		return;
+	}
+
+    for (auto& currentShape : shapes) {
+		currentShape->FindIntersections(ray, buffer, context);
     }
 }
 
-RayTracer::Color RayTracer::World::ShadeHit(const HitCalculations& hitInfo, size_t remainingReflections)
+bool RayTracer::World::FindClosestIntersection(const Ray& ray, Intersection& closestHit, RenderContext& context)
+{
+	if (HasAccelerationStructure()) {
+		return accelerationStructure.FindClosestHit(ray, closestHit, context);
+	}
+
+	bool found = false;
+
+	for (auto& currentShape : shapes) {
+		if (currentShape->FindClosestHit(ray, closestHit, context)) found = true;
+	}
+
+	return found;
+}
+
+bool RayTracer::World::FindAnyHit(Ray ray, Real maximumT, RenderContext& context)
+{
+	context.GetStatistics().raysCast++;
+
+	if (HasAccelerationStructure()) {
+		return accelerationStructure.FindAnyHit(ray, maximumT, context);
+	}
+
+	for (auto& currentShape : shapes) {
+		if (currentShape->FindAnyHit(ray, maximumT, context)) return true;
+	}
+
+	return false;
+}
+
+RayTracer::Color RayTracer::World::ShadeHit(const HitCalculations& hitInfo, RenderContext& context, size_t remainingReflections)
 {
 	Color lightingColor(0.0, 0.0, 0.0);
 	
 	for (auto& lightSource : lightSources) {
-		bool inShadow = PointIsInShadow(lightSource, hitInfo.overPoint);
+		bool inShadow = PointIsInShadow(lightSource, hitInfo.overPoint, context);
 		lightingColor = lightingColor + lightSource->Lighting(hitInfo.shape, hitInfo.overPoint, hitInfo.eyeVector, hitInfo.normalVector, inShadow);
 	}
 
 
-	Color reflectedColor = FindReflectedColor(hitInfo, remainingReflections);
-	Color refractedColor = FindRefractedColor(hitInfo, remainingReflections);
+	Color reflectedColor = FindReflectedColor(hitInfo, context, remainingReflections);
+	Color refractedColor = FindRefractedColor(hitInfo, context, remainingReflections);
 
 	Material shapeMaterial = hitInfo.shape->GetMaterial();
 
 	//Material is both reflective and transparent -> use Schlick Approximation
 	if (shapeMaterial.reflective > 0.0 && shapeMaterial.transparency > 0.0) {
-		double reflectance = hitInfo.SchlickApproximation();
+		Real reflectance = hitInfo.SchlickApproximation();
 
 		return lightingColor
 			+ (reflectedColor * reflectance)
@@ -76,7 +125,7 @@ RayTracer::Color RayTracer::World::ShadeHit(const HitCalculations& hitInfo, size
 	return lightingColor + reflectedColor + refractedColor;
 }
 
-RayTracer::Color RayTracer::World::FindReflectedColor(const HitCalculations& hitInfo, size_t remainingReflections)
+RayTracer::Color RayTracer::World::FindReflectedColor(const HitCalculations& hitInfo, RenderContext& context, size_t remainingReflections)
 {
 	Material material = hitInfo.shape->GetMaterial();
 
@@ -92,12 +141,12 @@ RayTracer::Color RayTracer::World::FindReflectedColor(const HitCalculations& hit
 
 	Ray reflectedRay(hitInfo.overPoint, hitInfo.reflectionVector);
 
-	Color hitColor = FindRayColor(reflectedRay, remainingReflections - 1);
+	Color hitColor = FindRayColor(reflectedRay, context, remainingReflections - 1);
 
 	return hitColor * material.reflective;
 }
 
-RayTracer::Color RayTracer::World::FindRefractedColor(const HitCalculations& hitInfo, size_t remainingRefractions)
+RayTracer::Color RayTracer::World::FindRefractedColor(const HitCalculations& hitInfo, RenderContext& context, size_t remainingRefractions)
 {
 	//Maximum number of refractions reached
 	if (remainingRefractions == 0) {
@@ -112,20 +161,20 @@ RayTracer::Color RayTracer::World::FindRefractedColor(const HitCalculations& hit
 	}
 
 	//Ratio between refraction indices
-	double refractionRatio = hitInfo.refractiveIndex1 / hitInfo.refractiveIndex2;
+	Real refractionRatio = hitInfo.refractiveIndex1 / hitInfo.refractiveIndex2;
 
 	//Cos(theta_i) is the same as the dot product of these vectors (Derived from Snell's Law)
-	double cos_i = Vector::DotProduct(hitInfo.eyeVector, hitInfo.normalVector);
+	Real cos_i = Vector::DotProduct(hitInfo.eyeVector, hitInfo.normalVector);
 	
 	//Find sin(theta_t)^2
-	double sin2_t = (refractionRatio * refractionRatio) * (1.0 - (cos_i * cos_i));
+	Real sin2_t = (refractionRatio * refractionRatio) * (1.0 - (cos_i * cos_i));
 
 	//Total internal reflection?
 	if (sin2_t > 1.0) {
 		return Color(0.0, 0.0, 0.0);
 	}
 
-	double cos_t = sqrt(1.0 - sin2_t);
+	Real cos_t = sqrt(1.0 - sin2_t);
 
 	//Compute the direction of the refracted ray
 	Vector refractedDirection = hitInfo.normalVector * (refractionRatio * cos_i - cos_t)
@@ -133,61 +182,190 @@ RayTracer::Color RayTracer::World::FindRefractedColor(const HitCalculations& hit
 
 	Ray refractedRay(hitInfo.underPoint, refractedDirection);
 
-	Color color = FindRayColor(refractedRay, remainingRefractions - 1) * m.transparency;
+	Color color = FindRayColor(refractedRay, context, remainingRefractions - 1) * m.transparency;
 
 	return color;
 }
 
-bool RayTracer::World::PointIsInShadow(std::shared_ptr<LightSource> lightSource, Point point)
+bool RayTracer::World::PointIsInShadow(std::shared_ptr<LightSource> lightSource, Point point, RenderContext& context)
 {
-	//Static buffer for memory reuse
-	static IntersectionBuffer intersections;
+	context.GetStatistics().shadowRaysCast++;
 
 	Vector vectorToLightSource = lightSource->GetPosition() - point;
-	double distanceToLightSource = vectorToLightSource.Magnitude();
+	Real distanceToLightSource = vectorToLightSource.Magnitude();
 
 	//Ray from the point to the light source
 	Ray ray(point, vectorToLightSource.Normalize());
 
-	IntersectRay(ray, intersections);
+	//Is anything blocking the light from reaching the point (-> object between point and light source)?
+	return FindAnyHit(ray, distanceToLightSource, context);
+}
 
+RayTracer::Color RayTracer::World::FindRayColor(Ray ray, RenderContext& context, size_t remainingReflections)
+{
+	context.GetStatistics().raysCast++;
 
-	size_t cnt = intersections.GetCount();
+	Intersection closestHit(std::numeric_limits<Real>::infinity(), nullptr);
 
-	for (size_t index = 0; index < cnt; index++) {
-		Intersection i = intersections[index];
-		
-		//Is anything blocking the light from reaching the point (-> object between point and light source)?
-		if (i.t >= 0.0 && i.t < distanceToLightSource) {
-			//Prepare the buffer for reuse
-			intersections.Reset();
-			return true;
+	//Nothing was hit
+	if (!FindClosestIntersection(ray, closestHit, context)) {
+		return Color(0.0, 0.0, 0.0);
+	}
+
+	return ShadeClosestHit(ray, closestHit, context, remainingReflections);
+}
+
+void RayTracer::World::FindRayColors(const RayPacket& packet, Color colors[], RenderContext& context, size_t remainingReflections)
+{
+	context.GetStatistics().raysCast += RayPacket::CountLanes(packet.activeLanes);
+
+	Intersection closestHits[RayPacket::Size];
+	RayPacket::LaneMask hitLanes = 0;
+
+	for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+		closestHits[lane] = Intersection(std::numeric_limits<Real>::infinity(), nullptr);
+	}
+
+	if (HasAccelerationStructure()) {
+		hitLanes = accelerationStructure.FindClosestHits(packet, closestHits, context);
+	}
+	else {
+		for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+			if (RayPacket::IsActive(packet.activeLanes, lane) && FindClosestIntersection(packet.rays[lane], closestHits[lane], context)) {
+				hitLanes |= RayPacket::LaneMask(1) << lane;
+			}
 		}
 	}
 
-	//Prepare the buffer for reuse
-	intersections.Reset();
+	//Shading is done ray by ray (Secondary rays are no longer coherent)
+	for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+		if (!RayPacket::IsActive(packet.activeLanes, lane)) continue;
 
-	//Point is illuminated by the light source
-	return false;
+		colors[lane] = RayPacket::IsActive(hitLanes, lane)
+			? ShadeClosestHit(packet.rays[lane], closestHits[lane], context, remainingReflections)
+			: Color(0.0, 0.0, 0.0);
+	}
 }
 
-RayTracer::Color RayTracer::World::FindRayColor(Ray ray, size_t remainingReflections)
+RayTracer::Color RayTracer::World::ShadeClosestHit(const Ray& ray, Intersection closestHit, RenderContext& context, size_t remainingReflections)
 {
-	//Static buffer in order to reuse allocated memory
-	static IntersectionBuffer intersections;
-	
-	IntersectRay(ray, intersections);
+	//Buffer owned by the context in order to reuse allocated memory
+	IntersectionBuffer& intersections = context.AcquireBuffer();
 
-	//Nothing was hit
-	if (intersections.GetCount() == 0 || !intersections.GetFirstHit().IsValid()) return Color(0.0, 0.0, 0.0);
+	//Refractive indices are only needed for transparent materials, but they depend on every intersection along the ray
+	if (closestHit.shape->GetMaterial().transparency > 0.0) {
+		FindAllIntersections(ray, intersections, context);
+		closestHit = intersections.GetFirstHit();
+	}
+	else {
+		intersections.Add(closestHit);
+	}
 
 	//Find the position of the hit
-	auto hit = HitCalculations(intersections.GetFirstHit(), intersections, ray, shapes);
+	auto hit = HitCalculations(closestHit, intersections, ray, context);
 
-	//Prepare the buffer for reuse
-	intersections.Reset();
+	//Return the buffer for reuse (It is not needed for shading)
+	context.ReleaseBuffer();
 
 	//Calculate the ray's color
-	return ShadeHit(hit, remainingReflections);
+	return ShadeHit(hit, context, remainingReflections);
+}
+
+void RayTracer::World::AddStatistics(RenderStatistics& statistics)
+{
+	numberOfRaysCast.fetch_add(statistics.raysCast, std::memory_order_relaxed);
+}
+
+void RayTracer::World::PrepareFrame()
+{
+	//Shapes only rebuild their structures / cached transforms if they were changed since the last frame
+	for (auto& shape : shapes) {
+		shape->UpdateWorldTransform();
+		shape->BuildAccelerationStructure();
+	}
+
+	//Changes of shapes that aren't part of this world (or that didn't move) don't need a new hierarchy
+	if (accelerationStructureIsValid && !ShapesChanged()) {
+		compiledChangeCount = Shape::GetChangeCount();
+		return;
+	}
+
+	compiledShapes.clear();
+	compiledBounds.clear();
+
+	for (auto& shape : shapes) {
+		compiledShapes.push_back(shape.get());
+		compiledBounds.push_back(shape->GetParentSpaceBounds());
+	}
+
+	accelerationStructure.Build(compiledShapes);
+	accelerationStructureIsValid = true;
+	compiledChangeCount = Shape::GetChangeCount();
+}
+
+bool RayTracer::World::ShapesChanged()
+{
+	if (shapes.size() != compiledShapes.size()) return true;
+
+	for (size_t index = 0; index < shapes.size(); index++) {
+		if (shapes[index].get() != compiledShapes[index]) return true;
+
+		//Transforms or contained shapes were changed
+		BoundingBox bounds = shapes[index]->GetParentSpaceBounds();
+		const BoundingBox& compiled = compiledBounds[index];
+
+		if (bounds.GetMin().x != compiled.GetMin().x || bounds.GetMin().y != compiled.GetMin().y || bounds.GetMin().z != compiled.GetMin().z
+			|| bounds.GetMax().x != compiled.GetMax().x || bounds.GetMax().y != compiled.GetMax().y || bounds.GetMax().z != compiled.GetMax().z) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RayTracer::World::IntersectRay(Ray ray, IntersectionBuffer& buffer)
+{
+	RenderContext context;
+	IntersectRay(ray, buffer, context);
+	AddStatistics(context.GetStatistics());
+}
+
+RayTracer::Color RayTracer::World::ShadeHit(const HitCalculations& hitInfo, size_t remainingReflections)
+{
+	RenderContext context;
+	Color color = ShadeHit(hitInfo, context, remainingReflections);
+	AddStatistics(context.GetStatistics());
+	return color;
+}
+
+RayTracer::Color RayTracer::World::FindReflectedColor(const HitCalculations& hitInfo, size_t remainingReflections)
+{
+	RenderContext context;
+	Color color = FindReflectedColor(hitInfo, context, remainingReflections);
+	AddStatistics(context.GetStatistics());
+	return color;
+}
+
+RayTracer::Color RayTracer::World::FindRefractedColor(const HitCalculations& hitInfo, size_t remainingRefractions)
+{
+	RenderContext context;
+	Color color = FindRefractedColor(hitInfo, context, remainingRefractions);
+	AddStatistics(context.GetStatistics());
+	return color;
+}
+
+bool RayTracer::World::PointIsInShadow(std::shared_ptr<LightSource> lightSource, Point point)
+{
+	RenderContext context;
+	bool inShadow = PointIsInShadow(lightSource, point, context);
+	AddStatistics(context.GetStatistics());
+	return inShadow;
+}
+
+RayTracer::Color RayTracer::World::FindRayColor(Ray ray, size_t remainingReflections)
+{
+	RenderContext context;
+	Color color = FindRayColor(ray, context, remainingReflections);
+	AddStatistics(context.GetStatistics());
+	return color;
 }
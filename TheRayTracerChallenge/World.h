@@ -4,42 +4,103 @@
 #include "LightSource.h"
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <algorithm>
 #include "Ray.h"
 #include "HitCalculations.h"
 #include "Pattern.h"
 #include "ColorPattern.h"
+#include "RenderContext.h"
+#include "LinearBVH.h"
+#include "RayPacket.h"
 
 namespace RayTracer {
 	class World
 	{
 	public:
-		std::vector<std::shared_ptr<Shape>> shapes;
 		std::vector<std::shared_ptr<LightSource>> lightSources;
 
-		unsigned long long numberOfRaysCast;
+		//Updated with the statistics of every context that traced this world
+		std::atomic<unsigned long long> numberOfRaysCast;
 
 		World();
 		~World();
 
 
 		void LoadDefaultWorld();
+
+		//Tracing rays (Any number of threads can trace the same world, as long as each one uses its own context)
+		void IntersectRay(Ray ray, IntersectionBuffer& buffer, RenderContext& context);
+		//Check if anything is hit at a t in [0.0, maximumT) (Stops at the first hit, used for shadow rays)
+		bool FindAnyHit(Ray ray, Real maximumT, RenderContext& context);
+		//Find the closest hit in front of closestHit.t (Nothing is sorted, far away shapes are skipped)
+		bool FindClosestHit(Ray ray, Intersection& closestHit, RenderContext& context);
+		Color ShadeHit(const HitCalculations& hitInfo, RenderContext& context, size_t remainingReflections = 5);
+		Color FindReflectedColor(const HitCalculations& hitInfo, RenderContext& context, size_t remainingReflections = 5);
+		Color FindRefractedColor(const HitCalculations& hitInfo, RenderContext& context, size_t remainingRefractions = 5);
+		bool PointIsInShadow(std::shared_ptr<LightSource> lightSource, Point point, RenderContext& context);
+		Color FindRayColor(Ray ray, RenderContext& context, size_t remainingReflections = 5);
+		//FindRayColor for every active ray of a packet (colors is indexed by lane, the closest hits of all rays are found in one traversal)
+		void FindRayColors(const RayPacket& packet, Color colors[], RenderContext& context, size_t remainingReflections = 5);
+
+		//Versions that use a temporary context
 		void IntersectRay(Ray ray, IntersectionBuffer& buffer);
 		Color ShadeHit(const HitCalculations& hitInfo, size_t remainingReflections = 5);
 		Color FindReflectedColor(const HitCalculations& hitInfo, size_t remainingReflections = 5);
 		Color FindRefractedColor(const HitCalculations& hitInfo, size_t remainingRefractions = 5);
 		bool PointIsInShadow(std::shared_ptr<LightSource> lightSource, Point point);
+		Color FindRayColor(Ray ray, size_t remainingReflections = 5);
+
+		//Add the statistics of a context to this world's counters
+		void AddStatistics(RenderStatistics& statistics);
 
+		//Build the acceleration structures of all shapes and the hierarchy over the shapes themselves
+		//(Called before rendering a frame, must not run while rays are traced)
+		void PrepareFrame();
+
+		//True if IntersectRay currently uses the hierarchy over the world's shapes
+		//(Adding or removing shapes, or changing any transform or contained shape, falls back to testing every shape until the next PrepareFrame)
+		bool HasAccelerationStructure() const { return accelerationStructureIsValid && compiledChangeCount == Shape::GetChangeCount(); }
+		const LinearBVH& GetAccelerationStructure() const { return accelerationStructure; }
+
+
+		//Shapes are only changed through these, so the hierarchy never refers to a shape that was removed
+		const std::vector<std::shared_ptr<Shape>>& GetShapes() const { return shapes; }
 
 		void AddShape(std::shared_ptr<Shape> shape) {
 			shapes.push_back(shape);
+			accelerationStructureIsValid = false;
+		}
+
+		void RemoveShape(const std::shared_ptr<Shape>& shape) {
+			shapes.erase(std::remove(shapes.begin(), shapes.end(), shape), shapes.end());
+			accelerationStructureIsValid = false;
 		}
 
 		void AddLightSource(std::shared_ptr<LightSource> lightSource) {
 			lightSources.push_back(lightSource);
 		}
 
-		Color FindRayColor(Ray ray, size_t remainingReflections = 5);
-
 	private:
+		std::vector<std::shared_ptr<Shape>> shapes;
+
+		//Hierarchy over the shapes (Shapes with infinite bounds like planes are tested separately)
+		LinearBVH accelerationStructure;
+		bool accelerationStructureIsValid;
+
+		//Shapes and their bounds at the time the hierarchy was built (Used to skip rebuilding it if nothing moved)
+		std::vector<Shape*> compiledShapes;
+		std::vector<BoundingBox> compiledBounds;
+		//Shape::GetChangeCount() at the end of the last PrepareFrame
+		unsigned long long compiledChangeCount;
+
+		bool ShapesChanged();
+
+		//Queries without updating the statistics
+		void FindAllIntersections(const Ray& ray, IntersectionBuffer& buffer, RenderContext& context);
+		bool FindClosestIntersection(const Ray& ray, Intersection& closestHit, RenderContext& context);
+
+		//Color of a ray whose closest hit is already known
+		Color ShadeClosestHit(const Ray& ray, Intersection closestHit, RenderContext& context, size_t remainingReflections);
 	};
 }
@@ -0,0 +1,108 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Matrix.h>
+#include <Affine3x4.h>
+#include <Transform.h>
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(Affine3x4Tests)
+	{
+	private:
+		static Transform CreateAffineTestTransform() {
+			return Transform::CreateScale(1.0, 2.0, 3.0)
+				.RotateY(Constants::PI / 5.0)
+				.Shear(0.5, 0.0, 0.0, 0.25, 0.0, 0.0)
+				.RotateX(0.3)
+				.Translate(1.0, -2.0, 0.5);
+		}
+
+	public:
+		TEST_METHOD(Identity) {
+			Affine3x4 identity;
+			Assert::IsTrue(identity.ToMatrix() == Matrix::IndentityMatrix4x4());
+
+			Point p = Point::CreatePoint(1.0, -2.0, 3.0);
+			Assert::IsTrue(identity * p == p);
+		}
+
+		TEST_METHOD(MatrixRoundtrip) {
+			Matrix4x4 matrix = CreateAffineTestTransform().GetMatrix();
+			Assert::IsTrue(Affine3x4(matrix).ToMatrix() == matrix);
+		}
+
+		TEST_METHOD(TupleProductMatchesMatrix) {
+			Matrix4x4 matrix = CreateAffineTestTransform().GetMatrix();
+			Affine3x4 affine(matrix);
+
+			Point p = Point::CreatePoint(0.5, -1.5, 4.0);
+			Vector v = Vector::CreateVector(-2.0, 0.25, 1.0);
+
+			Assert::IsTrue(affine * p == matrix * p);
+			Assert::IsTrue(affine * v == matrix * v);
+
+			//w is not changed
+			Assert::IsTrue((affine * p).w == 1.0);
+			Assert::IsTrue((affine * v).w == 0.0);
+		}
+
+		TEST_METHOD(ProductMatchesMatrix) {
+			Matrix4x4 m1 = CreateAffineTestTransform().GetMatrix();
+			Matrix4x4 m2 = Transform::CreateRotationZ(0.7).Translate(3.0, 0.0, -1.0).GetMatrix();
+
+			Assert::IsTrue((Affine3x4(m1) * Affine3x4(m2)).ToMatrix() == m1 * m2);
+		}
+
+		TEST_METHOD(InversionMatchesMatrix) {
+			Matrix4x4 matrix = CreateAffineTestTransform().GetMatrix();
+			Affine3x4 affine(matrix);
+
+			Assert::IsTrue(affine.Inversion().ToMatrix() == matrix.Inversion());
+			Assert::IsTrue(affine * affine.Inversion() == Affine3x4());
+			Assert::IsTrue(affine.Inversion().Inversion() == affine);
+		}
+
+		TEST_METHOD(TransformNormal) {
+			Affine3x4 inverse = CreateAffineTestTransform().GetInverseAffine();
+			Vector n = Vector::CreateVector(0.3, -0.4, 0.5);
+
+			Vector expected = inverse.ToMatrix().Transpose() * n;
+			expected.w = 0.0;
+
+			Assert::IsTrue(inverse.TransformNormal(n) == expected);
+			Assert::IsTrue(inverse.TransposedLinearPart() * n == expected);
+		}
+
+		TEST_METHOD(RayTransform) {
+			Transform transform = CreateAffineTestTransform();
+			Ray ray(Point::CreatePoint(1.0, 2.0, 3.0), Vector::CreateVector(0.0, 1.0, 0.0));
+
+			Ray transformed = ray.Transform(transform.GetAffine());
+
+			Assert::IsTrue(transformed.origin == transform.GetMatrix() * ray.origin);
+			Assert::IsTrue(transformed.direction == transform.GetMatrix() * ray.direction);
+		}
+
+		TEST_METHOD(CachedInverse) {
+			Transform transform = CreateAffineTestTransform();
+			Transform inverse = transform.Inversion();
+
+			//The inverse of an inverse is the original transform
+			Assert::IsTrue(inverse.GetInverseAffine() == transform.GetAffine());
+			Assert::IsTrue(inverse * transform == Transform());
+
+			//Invert swaps both matrices
+			Transform inverted = transform;
+			inverted.Invert();
+			Assert::IsTrue(inverted == inverse);
+			Assert::IsTrue(inverted.GetInverseAffine() == transform.GetAffine());
+		}
+	};
+}
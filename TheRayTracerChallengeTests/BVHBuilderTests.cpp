@@ -0,0 +1,197 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <IntersectionBuffer.h>
+#include <Transform.h>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <BoundingBox.h>
+#include <BVHBuilder.h>
+#include <Shape.h>
+#include <Sphere.h>
+#include <Plane.h>
+#include <ShapeGroup.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(BVHBuilderTests)
+	{
+	private:
+		static BoundingBox UnitBox(double x, double y, double z) {
+			return BoundingBox(Point::CreatePoint(x - 0.5, y - 0.5, z - 0.5), Point::CreatePoint(x + 0.5, y + 0.5, z + 0.5));
+		}
+
+	public:
+		TEST_METHOD(SurfaceArea) {
+			Assert::IsTrue(BoundingBox().SurfaceArea() == 0.0);
+			Assert::IsTrue(Constants::DoubleEqual(UnitBox(0.0, 0.0, 0.0).SurfaceArea(), 6.0));
+			Assert::IsTrue(Constants::DoubleEqual(BoundingBox(Point::CreatePoint(0.0, 0.0, 0.0), Point::CreatePoint(1.0, 2.0, 3.0)).SurfaceArea(), 22.0));
+			Assert::IsTrue(UnitBox(0.0, 0.0, 0.0).GetCenter() == Point::CreatePoint(0.0, 0.0, 0.0));
+
+			//Empty boxes don't change the box they are added to
+			BoundingBox box = UnitBox(0.0, 0.0, 0.0);
+			box.Add(BoundingBox());
+			Assert::IsTrue(box.GetMin() == Point::CreatePoint(-0.5, -0.5, -0.5));
+			Assert::IsTrue(box.GetMax() == Point::CreatePoint(0.5, 0.5, 0.5));
+		}
+
+		TEST_METHOD(SplitsClusters) {
+			std::vector<BoundingBox> boxes;
+			for (int i = 0; i < 4; i++) {
+				boxes.push_back(UnitBox(static_cast<double>(i) * 0.1, 0.0, 0.0));
+				boxes.push_back(UnitBox(100.0 + static_cast<double>(i) * 0.1, 0.0, 0.0));
+			}
+
+			BVHBuildSettings settings;
+			settings.maximumLeafSize = 4;
+			BVHBuilder builder(settings);
+			builder.Build(boxes);
+
+			const auto& nodes = builder.GetNodes();
+			const auto& order = builder.GetPrimitiveOrder();
+
+			//One leaf per cluster
+			Assert::IsTrue(nodes.size() == 3);
+			Assert::IsTrue(!nodes[0].IsLeaf());
+
+			for (size_t child : { nodes[0].leftChild, nodes[0].rightChild }) {
+				Assert::IsTrue(nodes[child].IsLeaf());
+				Assert::IsTrue(nodes[child].primitiveCount == 4);
+
+				bool leftCluster = boxes[order[nodes[child].firstPrimitive]].GetCenter().x < 50.0;
+				for (size_t i = nodes[child].firstPrimitive; i < nodes[child].firstPrimitive + nodes[child].primitiveCount; i++) {
+					Assert::IsTrue((boxes[order[i]].GetCenter().x < 50.0) == leftCluster);
+				}
+			}
+
+			//Every primitive is referenced exactly once
+			std::vector<size_t> sortedOrder = order;
+			std::sort(sortedOrder.begin(), sortedOrder.end());
+			for (size_t i = 0; i < sortedOrder.size(); i++) {
+				Assert::IsTrue(sortedOrder[i] == i);
+			}
+		}
+
+		TEST_METHOD(LeafSize) {
+			std::vector<BoundingBox> boxes;
+			for (int x = 0; x < 10; x++) {
+				for (int y = 0; y < 10; y++) {
+					boxes.push_back(UnitBox(static_cast<double>(x) * 2.0, static_cast<double>(y) * 2.0, 0.0));
+				}
+			}
+
+			BVHBuildSettings settings;
+			settings.maximumLeafSize = 2;
+			settings.binCount = 8;
+			BVHBuilder builder(settings);
+			builder.Build(boxes);
+
+			const auto& statistics = builder.GetStatistics();
+
+			Assert::IsTrue(statistics.primitiveCount == 100);
+			Assert::IsTrue(statistics.leafCount == statistics.interiorNodeCount + 1);
+			Assert::IsTrue(statistics.leafSizeHistogram.size() <= 3);
+			Assert::IsTrue(statistics.depth >= 7);
+			Assert::IsTrue(statistics.sahCost > 0.0);
+
+			for (const auto& node : builder.GetNodes()) {
+				if (node.IsLeaf()) Assert::IsTrue(node.primitiveCount <= 2);
+			}
+		}
+
+		TEST_METHOD(PrimitiveBlocks) {
+			BVHBuildSettings settings;
+			settings.maximumLeafSize = 8;
+			Assert::IsTrue(settings.GetIntersectionCount(5) == 5.0);
+
+			settings.primitiveBlockSize = 4;
+			Assert::IsTrue(settings.GetIntersectionCount(0) == 0.0);
+			Assert::IsTrue(settings.GetIntersectionCount(4) == 1.0);
+			Assert::IsTrue(settings.GetIntersectionCount(5) == 2.0);
+
+			//Four boxes in a row are split one by one, but fit into a single block
+			std::vector<BoundingBox> boxes;
+			for (int x = 0; x < 4; x++) {
+				boxes.push_back(UnitBox(static_cast<double>(x), 0.0, 0.0));
+			}
+
+			BVHBuilder blockBuilder(settings);
+			blockBuilder.Build(boxes);
+			Assert::IsTrue(blockBuilder.GetStatistics().leafCount == 1);
+
+			settings.primitiveBlockSize = 1;
+			BVHBuilder builder(settings);
+			builder.Build(boxes);
+			Assert::IsTrue(builder.GetStatistics().leafCount > 1);
+		}
+
+		TEST_METHOD(IdenticalBoxes) {
+			//No split reduces the cost -> halves instead of one large leaf
+			std::vector<BoundingBox> boxes(9, UnitBox(1.0, 1.0, 1.0));
+
+			BVHBuildSettings settings;
+			settings.maximumLeafSize = 4;
+			BVHBuilder builder(settings);
+			builder.Build(boxes);
+
+			for (const auto& node : builder.GetNodes()) {
+				if (node.IsLeaf()) Assert::IsTrue(node.primitiveCount <= 4);
+			}
+			Assert::IsTrue(builder.GetStatistics().primitiveCount == 9);
+		}
+
+		TEST_METHOD(GroupHierarchy) {
+			auto group = Shape::MakeShared<ShapeGroup>();
+
+			for (int i = 0; i < 20; i++) {
+				auto sphere = Shape::MakeShared<Sphere>();
+				sphere->SetTransform(Transform::CreateTranslation(static_cast<double>(i) * 3.0, 0.0, 0.0));
+				group->AddShape(sphere);
+			}
+			//A large shape that straddles every midpoint split
+			auto large = Shape::MakeShared<Sphere>();
+			large->SetTransform(Transform::CreateScale(40.0, 2.0, 2.0).Translate(30.0, 0.0, 0.0));
+			group->AddShape(large);
+
+			auto floor = Shape::MakeShared<Plane>();
+			floor->SetTransform(Transform::CreateTranslation(0.0, -5.0, 0.0));
+			group->AddShape(floor);
+
+			Ray ray(Point::CreatePoint(30.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			Ray floorRay(Point::CreatePoint(-30.0, 0.0, 0.0), Vector::CreateVector(0.0, -1.0, 0.0));
+
+			IntersectionBuffer before;
+			group->FindIntersections(ray, before);
+
+			BVHBuildSettings settings;
+			settings.maximumLeafSize = 2;
+			group->BuildHierarchy(settings);
+
+			//Plane + two children
+			Assert::IsTrue(group->GetShapeCount() == 3);
+			Assert::IsTrue(group->ContainsShape(floor.get()));
+
+			auto statistics = group->GetHierarchyStatistics(settings);
+			Assert::IsTrue(statistics.primitiveCount == 22);
+			Assert::IsTrue(statistics.depth > 2);
+
+			//Intersections don't change
+			IntersectionBuffer after;
+			group->FindIntersections(ray, after);
+			Assert::IsTrue(after.GetCount() == before.GetCount());
+			for (size_t i = 0; i < after.GetCount(); i++) {
+				Assert::IsTrue(Constants::DoubleEqual(after[i].t, before[i].t));
+			}
+
+			IntersectionBuffer floorIntersections;
+			group->FindIntersections(floorRay, floorIntersections);
+			Assert::IsTrue(floorIntersections.GetCount() == 1);
+		}
+	};
+}
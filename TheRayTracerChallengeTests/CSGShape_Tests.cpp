@@ -155,8 +155,27 @@ namespace TheRayTracesChallengeTests
 			Assert::IsTrue(xs.GetCount() == 2);
 			Assert::IsTrue(Constants::DoubleEqual(xs[0].t, 4.0));
 			Assert::IsTrue(Constants::DoubleEqual(xs[1].t, 6.5));
-			Assert::IsTrue(xs[0].shape == s1);
-			Assert::IsTrue(xs[1].shape == s2);
+			Assert::IsTrue(xs[0].shape == s1.get());
+			Assert::IsTrue(xs[1].shape == s2.get());
+		}
+
+		TEST_METHOD(AnyHit) {
+			auto s1 = Shape::MakeShared<Sphere>();
+			auto s2 = Shape::MakeShared<Sphere>();
+			auto c = Shape::MakeShared<CSGShape>();
+
+			s2->SetTransform(Transform::CreateTranslation(0.0, 0.0, -0.5));
+
+			c->SetLeft(s1);
+			c->SetRight(s2);
+			c->SetOperation(CSGShape::Operation::Difference);
+
+			RenderContext context;
+			Ray ray(Point::CreatePoint(0.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+
+			//The hits of both spheres in front of t = 5 are removed by the difference
+			Assert::IsTrue(!c->FindAnyHit(ray, 5.0, context));
+			Assert::IsTrue(c->FindAnyHit(ray, 5.6, context));
 		}
 	};
 }
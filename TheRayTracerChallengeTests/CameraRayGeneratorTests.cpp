@@ -0,0 +1,83 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <Transform.h>
+#include <RayPacket.h>
+#include <CameraRayGenerator.h>
+#include <Camera.h>
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(CameraRayGeneratorTests)
+	{
+	public:
+		TEST_METHOD(SameRaysAsTransformedPixels) {
+			Camera camera(201, 101, Constants::PI / 2.0, Transform::CreateTranslation(0.0, -2.0, 5.0).RotateY(Constants::PI / 4.0));
+			CameraRayGenerator generator = camera.CreateRayGenerator();
+
+			//Pixel positions transformed one by one
+			Affine3x4 inverse = camera.GetTransform().GetInverseAffine();
+			Point origin = inverse * Point::CreatePoint(0.0, 0.0, 0.0);
+			Assert::IsTrue(generator.GetOrigin().ToTuple() == origin);
+
+			for (size_t y = 0; y < camera.GetYSize(); y += 10) {
+				for (size_t x = 0; x < camera.GetXSize(); x += 10) {
+					Real worldX = camera.GetPixelSize() * camera.GetXSize() / 2.0 - (x + 0.5) * camera.GetPixelSize();
+					Real worldY = camera.GetPixelSize() * camera.GetYSize() / 2.0 - (y + 0.5) * camera.GetPixelSize();
+					Point pixel = inverse * Point::CreatePoint(worldX, worldY, -1.0);
+
+					Ray ray = generator.CreateRay(x, y);
+					Assert::IsTrue(ray.origin == origin);
+					Assert::IsTrue(ray.direction == (pixel - origin).Normalize());
+				}
+			}
+		}
+
+		TEST_METHOD(Steps) {
+			Camera camera(10, 10, Constants::PI / 2.0);
+			CameraRayGenerator generator = camera.CreateRayGenerator();
+
+			//Without a transform x goes to the left and y goes down
+			Assert::IsTrue(generator.GetXStep().ToTuple() == Vector::CreateVector(-camera.GetPixelSize(), 0.0, 0.0));
+			Assert::IsTrue(generator.GetYStep().ToTuple() == Vector::CreateVector(0.0, -camera.GetPixelSize(), 0.0));
+
+			//Rays through the corners of the image
+			Ray topLeft = generator.CreateRay(0, 0, 0.0, 0.0);
+			Ray bottomRight = generator.CreateRay(9, 9, 1.0, 1.0);
+			Assert::IsTrue(topLeft.direction == Vector::CreateVector(1.0, 1.0, -1.0).Normalize());
+			Assert::IsTrue(bottomRight.direction == Vector::CreateVector(-1.0, -1.0, -1.0).Normalize());
+		}
+
+		TEST_METHOD(Jitter) {
+			Camera camera(40, 30, Constants::PI / 3.0, Transform::CreateRotationX(0.3));
+			CameraRayGenerator generator = camera.CreateRayGenerator();
+
+			//The right edge of a pixel is the left edge of the next one
+			Assert::IsTrue(generator.CreateRay(4, 7, 1.0, 0.25).direction == generator.CreateRay(5, 7, 0.0, 0.25).direction);
+			Assert::IsTrue(generator.CreateRay(4, 7, 0.5, 1.5).direction == generator.CreateRay(4, 8).direction);
+			Assert::IsTrue(!(generator.CreateRay(4, 7, 0.1, 0.9).direction == generator.CreateRay(4, 7).direction));
+		}
+
+		TEST_METHOD(Packets) {
+			Camera camera(13, 9, Constants::PI / 3.0, Transform::CreateTranslation(1.0, 0.0, 3.0));
+			CameraRayGenerator generator = camera.CreateRayGenerator();
+
+			RayPacket packet;
+			generator.CreatePacket(12, 4, 100, 6, packet);
+			Assert::IsTrue(packet.activeLanes == 0x11);
+
+			for (size_t lane : { 0, 4 }) {
+				Ray ray = generator.CreateRay(12, 4 + lane / RayPacket::Width);
+				Assert::IsTrue(packet.rays[lane].direction.x == ray.direction.x);
+				Assert::IsTrue(packet.rays[lane].direction.y == ray.direction.y);
+				Assert::IsTrue(packet.rays[lane].direction.z == ray.direction.z);
+			}
+		}
+	};
+}
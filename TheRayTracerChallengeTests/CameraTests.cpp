@@ -14,6 +14,10 @@
 #include <HitCalculations.h>
 #include <Camera.h>
 #include <World.h>
+#include <CameraRayGenerator.h>
+#include <CancellationToken.h>
+#include <vector>
+#include <algorithm>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace RayTracer;
@@ -132,5 +136,257 @@ namespace TheRayTracesChallengeTests
 			);
 
 		}
+
+		TEST_METHOD(RenderFrameMultithreaded) {
+			World w;
+			w.LoadDefaultWorld();
+
+			Camera c(37, 23, Constants::PI / 2.0f,
+					Camera::CreateViewTransform(
+						Point::CreatePoint(0.0f, 0.0f, -5.0f),
+						Point::CreatePoint(0.0f, 0.0f, 0.0f),
+						Vector::CreateVector(0.0f, 1.0f, 0.0f)
+					)
+				);
+			//Tiles don't evenly divide the image
+			c.SetTileSize(8);
+
+			Canvas serialImage = c.RenderFrame(w);
+			Canvas parallelImage = c.RenderFrameMultithreaded(w, 4);
+
+			//Both render modes produce the same image
+			for (size_t y = 0; y < c.GetYSize(); y++) {
+				for (size_t x = 0; x < c.GetXSize(); x++) {
+					Assert::IsTrue(serialImage.ReadPixel(x, y) == parallelImage.ReadPixel(x, y));
+				}
+			}
+		}
+
+		TEST_METHOD(MortonOrderRendering) {
+			World w;
+			w.LoadDefaultWorld();
+
+			Camera c(37, 29, Constants::PI / 2.0f,
+					Camera::CreateViewTransform(
+						Point::CreatePoint(0.0f, 0.0f, -5.0f),
+						Point::CreatePoint(0.0f, 0.0f, 0.0f),
+						Vector::CreateVector(0.0f, 1.0f, 0.0f)
+					)
+				);
+			c.SetTileSize(8);
+			Assert::IsTrue(c.GetUseMortonOrder());
+
+			//The order of the tiles and pixels doesn't change the image
+			for (bool usePackets : { true, false }) {
+				c.SetUsePacketTracing(usePackets);
+
+				c.SetUseMortonOrder(false);
+				Canvas rowImage = c.RenderFrame(w);
+				c.SetUseMortonOrder(true);
+				Canvas serialImage = c.RenderFrame(w);
+				Canvas parallelImage = c.RenderFrameMultithreaded(w, 3);
+
+				for (size_t y = 0; y < c.GetYSize(); y++) {
+					for (size_t x = 0; x < c.GetXSize(); x++) {
+						Assert::IsTrue(serialImage.ReadPixel(x, y) == rowImage.ReadPixel(x, y));
+						Assert::IsTrue(parallelImage.ReadPixel(x, y) == rowImage.ReadPixel(x, y));
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(SampleOffsets) {
+			//The first sample is the center, the first four fall into different quarters of the pixel
+			Real xOffset, yOffset;
+			CameraRayGenerator::GetSampleOffset(0, xOffset, yOffset);
+			Assert::IsTrue(xOffset == 0.5 && yOffset == 0.5);
+
+			int quarters[4] = {};
+			for (size_t sample = 0; sample < 64; sample++) {
+				CameraRayGenerator::GetSampleOffset(sample, xOffset, yOffset);
+				Assert::IsTrue(xOffset >= 0.0 && xOffset < 1.0 && yOffset >= 0.0 && yOffset < 1.0);
+
+				if (sample < 4) quarters[(xOffset >= 0.5 ? 1 : 0) + (yOffset >= 0.5 ? 2 : 0)]++;
+			}
+
+			for (int count : quarters) {
+				Assert::IsTrue(count == 1);
+			}
+		}
+
+		TEST_METHOD(AdaptiveAntialiasing) {
+			World w;
+			w.LoadDefaultWorld();
+
+			Camera c(21, 21, Constants::PI / 2.0f,
+					Camera::CreateViewTransform(
+						Point::CreatePoint(0.0f, 0.0f, -5.0f),
+						Point::CreatePoint(0.0f, 0.0f, 0.0f),
+						Vector::CreateVector(0.0f, 1.0f, 0.0f)
+					)
+				);
+
+			Canvas aliasedImage = c.RenderFrameMultithreaded(w, 2);
+			Assert::IsTrue(c.GetAverageSamplesPerPixel() == 1.0);
+
+			AntialiasingSettings settings;
+			settings.initialSamples = 4;
+			settings.maximumSamples = 32;
+			settings.threshold = 0.01;
+			c.SetAntialiasing(settings);
+
+			Canvas serialImage = c.RenderFrame(w);
+			Canvas parallelImage = c.RenderFrameMultithreaded(w, 2);
+
+			//Every pixel gets two batches, only the pixels on the sphere's edge are refined further
+			Assert::IsTrue(c.GetAverageSamplesPerPixel() > 8.0);
+			Assert::IsTrue(c.GetAverageSamplesPerPixel() < 12.0);
+
+			//The samples don't depend on the thread that renders a pixel
+			for (size_t y = 0; y < c.GetYSize(); y++) {
+				for (size_t x = 0; x < c.GetXSize(); x++) {
+					Assert::IsTrue(serialImage.ReadPixel(x, y) == parallelImage.ReadPixel(x, y));
+				}
+			}
+
+			//Background and the smooth center of the sphere are (almost) unchanged (The pixels are large, so the shading changes a bit inside of them)
+			Assert::IsTrue(parallelImage.ReadPixel(0, 0) == Color(0.0, 0.0, 0.0));
+			Color difference = parallelImage.ReadPixel(10, 10) - aliasedImage.ReadPixel(10, 10);
+			Assert::IsTrue(std::fabs(difference.r) < 0.05 && std::fabs(difference.g) < 0.05 && std::fabs(difference.b) < 0.05);
+
+			//Pixels on the edge are a mix of the sphere and the background
+			Color edge = parallelImage.ReadPixel(10, 8);
+			Color inside = parallelImage.ReadPixel(10, 10);
+			Assert::IsTrue(edge.g > 0.0 && edge.g < inside.g);
+		}
+
+		TEST_METHOD(ProgressivePasses) {
+			//Every pixel of an 8 x 8 block is traced by exactly one pass and only filled by coarser passes before that
+			int traced[8][8] = {};
+			int lastFilled[8][8];
+			for (auto& row : lastFilled) std::fill(row, row + 8, -1);
+
+			const auto& passes = Camera::GetProgressivePasses();
+			for (int passIndex = 0; passIndex < static_cast<int>(passes.size()); passIndex++) {
+				const ProgressivePass& pass = passes[passIndex];
+
+				for (size_t y = pass.yOffset; y < 8; y += pass.yStep) {
+					for (size_t x = pass.xOffset; x < 8; x += pass.xStep) {
+						Assert::IsTrue(lastFilled[y][x] < passIndex);
+						traced[y][x]++;
+
+						for (size_t yFill = y; yFill < y + pass.fillHeight; yFill++) {
+							for (size_t xFill = x; xFill < x + pass.fillWidth; xFill++) {
+								//A block never covers a pixel that was already traced
+								Assert::IsTrue((yFill == y && xFill == x) || traced[yFill][xFill] == 0);
+								lastFilled[yFill][xFill] = passIndex;
+							}
+						}
+					}
+				}
+			}
+
+			for (auto& row : traced) {
+				for (int count : row) {
+					Assert::IsTrue(count == 1);
+				}
+			}
+		}
+
+		TEST_METHOD(ProgressiveRendering) {
+			World w;
+			w.LoadDefaultWorld();
+
+			//Not a multiple of 8, so the blocks at the borders are cut off
+			Camera c(23, 13, Constants::PI / 2.0f,
+					Camera::CreateViewTransform(
+						Point::CreatePoint(0.0f, 0.0f, -5.0f),
+						Point::CreatePoint(0.0f, 0.0f, 0.0f),
+						Vector::CreateVector(0.0f, 1.0f, 0.0f)
+					)
+				);
+
+			AntialiasingSettings settings;
+			settings.maximumSamples = 8;
+
+			for (int mode = 0; mode < 3; mode++) {
+				c.SetUsePacketTracing(mode != 1);
+				c.SetAntialiasing(mode == 2 ? settings : AntialiasingSettings());
+
+				Canvas expected = c.RenderFrame(w);
+
+				std::vector<size_t> reportedPasses;
+				Canvas image = c.RenderFrameProgressive(w, [&](const Canvas& snapshot, size_t passIndex, size_t passCount) {
+					Assert::IsTrue(passCount == Camera::GetProgressivePasses().size());
+					reportedPasses.push_back(passIndex);
+
+					//The first preview repeats every 8th pixel
+					if (passIndex == 0) {
+						Assert::IsTrue(snapshot.ReadPixel(13, 4) == expected.ReadPixel(8, 0));
+						Assert::IsTrue(snapshot.ReadPixel(22, 12) == expected.ReadPixel(16, 8));
+					}
+				}, nullptr, 2);
+
+				Assert::IsTrue(reportedPasses.size() == Camera::GetProgressivePasses().size());
+				Assert::IsTrue(reportedPasses.back() == reportedPasses.size() - 1);
+
+				//The last pass is the same image as RenderFrame
+
+				for (size_t y = 0; y < c.GetYSize(); y++) {
+					for (size_t x = 0; x < c.GetXSize(); x++) {
+						Assert::IsTrue(image.ReadPixel(x, y) == expected.ReadPixel(x, y));
+					}
+				}
+
+				Assert::IsTrue(mode == 2 ? c.GetAverageSamplesPerPixel() > 1.0 : c.GetAverageSamplesPerPixel() == 1.0);
+			}
+		}
+
+		TEST_METHOD(ProgressiveCancellation) {
+			World w;
+			w.LoadDefaultWorld();
+
+			Camera c(40, 24, Constants::PI / 3.0f,
+					Camera::CreateViewTransform(
+						Point::CreatePoint(0.0f, 0.0f, -5.0f),
+						Point::CreatePoint(0.0f, 0.0f, 0.0f),
+						Vector::CreateVector(0.0f, 1.0f, 0.0f)
+					)
+				);
+			CancellationToken token;
+
+			//Only the 8 x 8 blocks of the first pass
+			auto isFirstPass = [&](const Canvas& image) {
+				for (size_t y = 0; y < c.GetYSize(); y++) {
+					for (size_t x = 0; x < c.GetXSize(); x++) {
+						if (!(image.ReadPixel(x, y) == image.ReadPixel(x - x % 8, y - y % 8))) return false;
+					}
+				}
+				return true;
+			};
+
+			//Cancel after the first preview
+			size_t passes = 0;
+			Canvas image = c.RenderFrameProgressive(w, [&](const Canvas& snapshot, size_t, size_t) {
+				passes++;
+				Assert::IsTrue(isFirstPass(snapshot));
+				token.Cancel();
+			}, &token, 2);
+
+			Assert::IsTrue(passes == 1);
+			Assert::IsTrue(c.GetAverageSamplesPerPixel() == 1.0);
+			Assert::IsTrue(isFirstPass(image));
+			//Background in the corner, the sphere in the middle
+			Assert::IsTrue(!(image.ReadPixel(0, 0) == image.ReadPixel(16, 8)));
+
+			//Nothing is traced with a token that was cancelled before the render
+			unsigned long long rays = w.numberOfRaysCast;
+			c.RenderFrameProgressive(w, [&](const Canvas&, size_t, size_t) { passes++; }, &token);
+			Assert::IsTrue(passes == 1);
+			Assert::IsTrue(w.numberOfRaysCast == rays);
+
+			token.Reset();
+			Assert::IsTrue(!token.IsCancelled());
+		}
 	};
 }
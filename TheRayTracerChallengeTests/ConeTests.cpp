@@ -8,6 +8,7 @@
 #include <Transform.h>
 #include <memory>
 #include <string>
+#include <iterator>
 #include <Shape.h>
 #include <Cone.h>
 #include <type_traits>
@@ -89,7 +90,7 @@ namespace TheRayTracesChallengeTests
 			};
 
 			//Expected results of the intersection tests
-			std::vector<IntersectionBuffer> expected = {
+			IntersectionBuffer expected[] = {
 				//Untruncated cones
 				//Rays that hit the cone
 				IntersectionBuffer(Intersection(5.0, cones[0]), Intersection(5.0, cones[0])),
@@ -117,9 +118,9 @@ namespace TheRayTracesChallengeTests
 			};
 
 			//Simulate each test case
-			for (size_t testNr = 0; testNr < expected.size(); testNr++) {
+			for (size_t testNr = 0; testNr < std::size(expected); testNr++) {
 				Ray testRay = rays[testNr];
-				IntersectionBuffer expectedIntersections = expected[testNr];
+				IntersectionBuffer& expectedIntersections = expected[testNr];
 				auto testCone = cones[testNr];
 				IntersectionBuffer intersections;
 				testCone->FindIntersections(testRay, intersections);
@@ -7,6 +7,7 @@
 #include <IntersectionBuffer.h>
 #include <Transform.h>
 #include <memory>
+#include <iterator>
 #include <Shape.h>
 #include <Cube.h>
 #include <type_traits>
@@ -70,7 +71,7 @@ namespace TheRayTracesChallengeTests
 				Ray(Point::CreatePoint(2.0, 2.0, 0.0), Vector::CreateVector(-1.0, 0.0, 0.0))
 			};
 
-			std::vector<IntersectionBuffer> expected = {
+			IntersectionBuffer expected[] = {
 				//Expected results for rays hitting the cube
 				IntersectionBuffer(Intersection(4.0, cube), Intersection(6.0, cube)),
 				IntersectionBuffer(Intersection(4.0, cube), Intersection(6.0, cube)),
@@ -89,9 +90,9 @@ namespace TheRayTracesChallengeTests
 				IntersectionBuffer()
 			};
 
-			for (size_t testNr = 0; testNr < expected.size(); testNr++) {
+			for (size_t testNr = 0; testNr < std::size(expected); testNr++) {
 				Ray testRay = rays[testNr];
-				IntersectionBuffer expectedIntersections = expected[testNr];
+				IntersectionBuffer& expectedIntersections = expected[testNr];
 				IntersectionBuffer intersections;
 				cube->FindIntersections(testRay, intersections);
 
@@ -8,6 +8,7 @@
 #include <Transform.h>
 #include <memory>
 #include <string>
+#include <iterator>
 #include <Shape.h>
 #include <Cylinder.h>
 #include <type_traits>
@@ -118,7 +119,7 @@ namespace TheRayTracesChallengeTests
 			};
 
 			//Expected results of the intersection tests
-			std::vector<IntersectionBuffer> expected = {
+			IntersectionBuffer expected[] = {
 				//Untruncated cylinders
 				//Results for rays that miss the cylinder
 				IntersectionBuffer(),
@@ -162,9 +163,9 @@ namespace TheRayTracesChallengeTests
 			};
 
 			//Simulate each test case
-			for (size_t testNr = 0; testNr < expected.size(); testNr++) {
+			for (size_t testNr = 0; testNr < std::size(expected); testNr++) {
 				Ray testRay = rays[testNr];
-				IntersectionBuffer expectedIntersections = expected[testNr];
+				IntersectionBuffer& expectedIntersections = expected[testNr];
 				auto testCylinder = cylinders[testNr];
 
 				IntersectionBuffer intersections;
@@ -36,7 +36,7 @@ namespace TheRayTracesChallengeTests
 			HitCalculations comps(i.GetFirstHit(), i, r, shapes);
 
 			Assert::IsTrue(Constants::DoubleEqual(comps.t, i.GetFirstHit().t));
-			Assert::IsTrue(comps.shape == shape);
+			Assert::IsTrue(comps.shape == shape.get());
 			Assert::IsTrue(comps.point == Point::CreatePoint(0.0f, 0.0f, -1.0f));
 			Assert::IsTrue(comps.eyeVector == Vector::CreateVector(0.0f, 0.0f, -1.0f));
 			Assert::IsTrue(comps.normalVector == Vector::CreateVector(0.0f, 0.0f, -1.0f));
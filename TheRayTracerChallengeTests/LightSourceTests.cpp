@@ -41,7 +41,7 @@ namespace TheRayTracesChallengeTests
             normal = Vector::CreateVector(0.0f, 0.0f, -1.0f);
 
             Assert::IsTrue(
-                l.Lighting(shape, position, eye, normal, false)
+                l.Lighting(shape.get(), position, eye, normal, false)
                 == Color(1.9f, 1.9f, 1.9f)
             );
 
@@ -50,7 +50,7 @@ namespace TheRayTracesChallengeTests
             eye = Vector::CreateVector(0.0f, sqrtf(2.0f) / 2.0f, -sqrtf(2.0f)/2.0f);
             normal = Vector::CreateVector(0.0f, 0.0f, -1.0f);
             Assert::IsTrue(
-                l.Lighting(shape, position, eye, normal, false)
+                l.Lighting(shape.get(), position, eye, normal, false)
                 == Color(1.0f, 1.0f, 1.0f)
             );
 
@@ -59,7 +59,7 @@ namespace TheRayTracesChallengeTests
             eye = Vector::CreateVector(0.0f, 0.0f, -1.0f);
             normal = Vector::CreateVector(0.0f, 0.0f, -1.0f);
             Assert::IsTrue(
-                l.Lighting(shape, position, eye, normal, false)
+                l.Lighting(shape.get(), position, eye, normal, false)
                 == Color(0.7364f, 0.7364f, 0.7364f)
             );
 
@@ -69,7 +69,7 @@ namespace TheRayTracesChallengeTests
             normal = Vector::CreateVector(0.0f, 0.0f, -1.0f);
 
             Assert::IsTrue(
-                l.Lighting(shape, position, eye, normal, false)
+                l.Lighting(shape.get(), position, eye, normal, false)
                 == Color(1.6364f, 1.6364f, 1.6364f)
             );
 
@@ -79,7 +79,7 @@ namespace TheRayTracesChallengeTests
             eye = Vector::CreateVector(0.0f, 0.0f, -1.0f);
             normal = Vector::CreateVector(0.0f, 0.0f, -1.0f);
             Assert::IsTrue(
-                l.Lighting(shape, position, eye, normal, false)
+                l.Lighting(shape.get(), position, eye, normal, false)
                 == Color(0.1f, 0.1f, 0.1f)
             );
         }
@@ -93,7 +93,7 @@ namespace TheRayTracesChallengeTests
 
 			Assert::IsTrue(
 				l.Lighting(
-					std::make_shared<Sphere>(),
+					std::make_shared<Sphere>().get(),
 					Point::CreatePoint(0.0f, 0.0f, 0.0f),
 					Vector::CreateVector(0.0f, 0.0f, -1.0f),
 					Vector::CreateVector(0.0f, 0.0f, -1.0f),
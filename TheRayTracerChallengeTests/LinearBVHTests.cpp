@@ -0,0 +1,190 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <IntersectionBuffer.h>
+#include <Transform.h>
+#include <memory>
+#include <limits>
+#include <vector>
+#include <Shape.h>
+#include <Sphere.h>
+#include <Plane.h>
+#include <ShapeGroup.h>
+#include <LinearBVH.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(LinearBVHTests)
+	{
+	private:
+		//Group with a grid of small spheres and a nested group without a transform
+		static std::shared_ptr<ShapeGroup> CreateGrid(std::shared_ptr<ShapeGroup>& nested) {
+			auto group = Shape::MakeShared<ShapeGroup>();
+			nested = Shape::MakeShared<ShapeGroup>();
+
+			for (int x = 0; x < 6; x++) {
+				for (int y = 0; y < 6; y++) {
+					auto sphere = Shape::MakeShared<Sphere>();
+					sphere->SetTransform(Transform::CreateScale(0.4, 0.4, 0.4).Translate(static_cast<double>(x), static_cast<double>(y), 0.0));
+
+					if (x == 0) nested->AddShape(sphere);
+					else group->AddShape(sphere);
+				}
+			}
+
+			group->AddShape(nested);
+			return group;
+		}
+
+	public:
+		TEST_METHOD(NodeSize) {
+			Assert::IsTrue(sizeof(LinearBVHNode) == 32);
+		}
+
+		TEST_METHOD(BuildFromGroup) {
+			std::shared_ptr<ShapeGroup> nested;
+			auto group = CreateGrid(nested);
+
+			auto plane = Shape::MakeShared<Plane>();
+			group->AddShape(plane);
+
+			//A nested group with a transform is treated as a single primitive
+			auto transformed = Shape::MakeShared<ShapeGroup>();
+			transformed->AddShape(Shape::MakeShared<Sphere>());
+			transformed->SetTransform(Transform::CreateTranslation(10.0, 0.0, 0.0));
+			group->AddShape(transformed);
+
+			group->BuildAccelerationStructure();
+			Assert::IsTrue(group->HasAccelerationStructure());
+			Assert::IsTrue(transformed->HasAccelerationStructure());
+
+			const auto& bvh = group->GetAccelerationStructure();
+			Assert::IsTrue(bvh.GetPrimitiveCount() == 37);
+			Assert::IsTrue(bvh.GetUnboundedPrimitiveCount() == 1);
+
+			//Depth first order: The second child of every interior node comes after its first child
+			const auto& nodes = bvh.GetNodes();
+			for (size_t index = 0; index < nodes.size(); index++) {
+				if (!nodes[index].IsLeaf()) {
+					Assert::IsTrue(nodes[index].offset > index + 1);
+					Assert::IsTrue(nodes[index].offset < nodes.size());
+				}
+			}
+		}
+
+		TEST_METHOD(SameIntersectionsAsGroup) {
+			std::shared_ptr<ShapeGroup> nested;
+			auto group = CreateGrid(nested);
+			auto reference = CreateGrid(nested);
+			group->BuildAccelerationStructure();
+
+			for (int i = 0; i < 50; i++) {
+				double x = static_cast<double>(i % 7) - 0.5;
+				double y = static_cast<double>(i / 7) - 0.3;
+
+				//Rays along the grid and at an angle
+				Ray ray(Point::CreatePoint(x, y, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+				Ray angledRay(Point::CreatePoint(-3.0, y, -3.0), Vector::CreateVector(1.0, 0.05 * x, 0.7).Normalize());
+
+				for (auto& r : { ray, angledRay }) {
+					IntersectionBuffer expected, actual;
+					reference->FindIntersections(r, expected);
+					group->FindIntersections(r, actual);
+
+					//Shapes are shared, so compare the hit times and count
+					Assert::IsTrue(expected.GetCount() == actual.GetCount());
+					expected.Sort();
+					actual.Sort();
+					for (size_t index = 0; index < actual.GetCount(); index++) {
+						Assert::IsTrue(Constants::DoubleEqual(expected[index].t, actual[index].t));
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(Invalidation) {
+			std::shared_ptr<ShapeGroup> nested;
+			auto group = CreateGrid(nested);
+			group->BuildAccelerationStructure();
+
+			//Adding a shape to a flattened group invalidates the parent's structure
+			auto sphere = Shape::MakeShared<Sphere>();
+			sphere->SetTransform(Transform::CreateTranslation(0.0, 20.0, 0.0));
+			nested->AddShape(sphere);
+			Assert::IsTrue(!group->HasAccelerationStructure());
+
+			group->BuildAccelerationStructure();
+			Ray ray(Point::CreatePoint(0.0, 20.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			IntersectionBuffer xs;
+			group->FindIntersections(ray, xs);
+			Assert::IsTrue(xs.GetCount() == 2);
+			Assert::IsTrue(xs[0].shape == sphere.get());
+		}
+
+		TEST_METHOD(RaysStartingOnBounds) {
+			std::vector<Shape*> shapes;
+			auto sphere = Shape::MakeShared<Sphere>();
+			shapes.push_back(sphere.get());
+
+			LinearBVH bvh;
+			bvh.Build(shapes);
+
+			//Parallel to the x axis on the face of the bounding box
+			Ray ray(Point::CreatePoint(-5.0, 1.0, 0.0), Vector::CreateVector(1.0, 0.0, 0.0));
+			size_t visited = 0;
+			bvh.Traverse(ray, 0.0, 100.0, [&](uint32_t) { visited++; return false; });
+			Assert::IsTrue(visited == 1);
+
+			//Box is behind the ray
+			Ray away(Point::CreatePoint(-5.0, 0.0, 0.0), Vector::CreateVector(-1.0, 0.0, 0.0));
+			visited = 0;
+			bvh.Traverse(away, 0.0, 100.0, [&](uint32_t) { visited++; return false; });
+			Assert::IsTrue(visited == 0);
+		}
+
+		TEST_METHOD(ClosestHitFrontToBack) {
+			//Row of spheres along the ray, added back to front
+			std::vector<std::shared_ptr<Shape>> spheres;
+			std::vector<Shape*> shapes;
+			for (int i = 63; i >= 0; i--) {
+				auto sphere = Shape::MakeShared<Sphere>();
+				sphere->SetTransform(Transform::CreateTranslation(0.0, 0.0, static_cast<double>(i) * 3.0));
+				spheres.push_back(sphere);
+				shapes.push_back(sphere.get());
+			}
+
+			BVHBuildSettings settings;
+			settings.maximumLeafSize = 1;
+			LinearBVH bvh;
+			bvh.Build(shapes, settings);
+
+			Ray ray(Point::CreatePoint(0.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			RenderContext context;
+
+			Intersection closestHit(std::numeric_limits<Real>::infinity(), nullptr);
+			Assert::IsTrue(bvh.FindClosestHit(ray, closestHit, context));
+			Assert::IsTrue(Constants::DoubleEqual(closestHit.t, 4.0));
+			Assert::IsTrue(closestHit.shape == spheres.back().get());
+
+			//Nodes behind the closest hit are skipped
+			Real maximumT = std::numeric_limits<Real>::infinity();
+			size_t visited = 0;
+			bvh.Traverse(ray, 0.0, maximumT, [&](uint32_t primitiveId) {
+				visited++;
+				Intersection hit(maximumT, nullptr);
+				if (bvh.GetPrimitive(primitiveId)->FindClosestHit(ray, hit, context)) maximumT = hit.t;
+				return false;
+			});
+			Assert::IsTrue(visited < 4);
+
+			//Only hits in front of the initial t are reported
+			Intersection limitedHit(4.0, nullptr);
+			Assert::IsTrue(!bvh.FindClosestHit(ray, limitedHit, context));
+		}
+	};
+}
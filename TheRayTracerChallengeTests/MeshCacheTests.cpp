@@ -0,0 +1,171 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Tuple.h>
+#include <Ray.h>
+#include <Intersection.h>
+#include <RenderContext.h>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <TriangleMesh.h>
+#include <OBJLoader.h>
+#include <MeshCache.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(MeshCacheTests)
+	{
+	public:
+
+		TEST_METHOD(Checksum) {
+			std::string text = "v 0 1 0\nv -1 0 0\nv 1 0 0\nf 1 2 3\n";
+			std::string changed = "v 0 1 0\nv -1 0 0\nv 1 0 0\nf 1 3 2\n";
+
+			uint64_t checksum = MeshCache::ComputeChecksum(text.data(), text.size());
+			Assert::IsTrue(checksum == MeshCache::ComputeChecksum(text.data(), text.size()));
+			Assert::IsTrue(checksum != MeshCache::ComputeChecksum(changed.data(), changed.size()));
+			//Bytes after the last full word are included
+			Assert::IsTrue(checksum != MeshCache::ComputeChecksum(text.data(), text.size() - 1));
+		}
+
+		TEST_METHOD(WriteAndRead) {
+			std::string fileName = "MeshCacheTests_WriteAndRead.meshcache";
+
+			//Random smooth and flat triangles
+			RenderContext random;
+			auto mesh = Shape::MakeShared<TriangleMesh>();
+			uint32_t normal = mesh->AddNormal(Vector::CreateVector(0.0, 0.0, -1.0));
+
+			for (size_t index = 0; index < 200; index++) {
+				uint32_t v0 = mesh->AddVertex(Point::CreatePoint(random.NextRandom() * 10.0, random.NextRandom() * 10.0, random.NextRandom()));
+				uint32_t v1 = mesh->AddVertex(Point::CreatePoint(random.NextRandom() * 10.0, random.NextRandom() * 10.0, random.NextRandom()));
+				uint32_t v2 = mesh->AddVertex(Point::CreatePoint(random.NextRandom() * 10.0, random.NextRandom() * 10.0, random.NextRandom()));
+
+				if (index % 2 == 0) mesh->AddTriangle(v0, v1, v2);
+				else mesh->AddTriangle(v0, v1, v2, normal, normal, normal);
+			}
+
+			Assert::IsTrue(MeshCache::Write(fileName, *mesh, 42, 100));
+			Assert::IsTrue(mesh->HasAccelerationStructure());
+
+			auto cached = MeshCache::Read(fileName, 42, 100);
+			Assert::IsTrue(cached != nullptr);
+			Assert::IsTrue(cached->HasAccelerationStructure());
+
+			Assert::IsTrue(cached->GetData().positions == mesh->GetData().positions);
+			Assert::IsTrue(cached->GetData().normals == mesh->GetData().normals);
+			Assert::IsTrue(cached->GetData().vertexIndices == mesh->GetData().vertexIndices);
+			Assert::IsTrue(cached->GetData().normalIndices == mesh->GetData().normalIndices);
+			Assert::IsTrue(cached->GetAccelerationStructure().GetNodes().size() == mesh->GetAccelerationStructure().GetNodes().size());
+			Assert::IsTrue(cached->GetAccelerationStructure().GetPrimitiveOrder() == mesh->GetAccelerationStructure().GetPrimitiveOrder());
+
+			RenderContext context;
+			for (size_t index = 0; index < 100; index++) {
+				Ray ray(Point::CreatePoint(random.NextRandom() * 10.0, random.NextRandom() * 10.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+
+				Intersection expected, hit;
+				bool expectedFound = mesh->FindClosestHit(ray, expected, context);
+				bool found = cached->FindClosestHit(ray, hit, context);
+
+				Assert::IsTrue(found == expectedFound);
+				if (found) {
+					Assert::IsTrue(hit.t == expected.t);
+					Assert::IsTrue(hit.primitiveIndex == expected.primitiveIndex);
+				}
+			}
+
+			//Different source file
+			Assert::IsTrue(MeshCache::Read(fileName, 43, 100) == nullptr);
+			Assert::IsTrue(MeshCache::Read(fileName, 42, 101) == nullptr);
+
+			std::remove(fileName.c_str());
+			Assert::IsTrue(MeshCache::Read(fileName, 42, 100) == nullptr);
+		}
+
+		TEST_METHOD(DamagedFile) {
+			std::string fileName = "MeshCacheTests_DamagedFile.meshcache";
+
+			auto mesh = Shape::MakeShared<TriangleMesh>();
+			uint32_t v0 = mesh->AddVertex(Point::CreatePoint(0.0, 1.0, 0.0));
+			uint32_t v1 = mesh->AddVertex(Point::CreatePoint(-1.0, 0.0, 0.0));
+			uint32_t v2 = mesh->AddVertex(Point::CreatePoint(1.0, 0.0, 0.0));
+			mesh->AddTriangle(v0, v1, v2);
+			Assert::IsTrue(MeshCache::Write(fileName, *mesh, 1, 1));
+
+			std::string content;
+			{
+				std::ifstream file(fileName, std::ios::binary);
+				content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			}
+
+			//Truncated
+			{
+				std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+				file.write(content.data(), content.size() - 4);
+			}
+			Assert::IsTrue(MeshCache::Read(fileName, 1, 1) == nullptr);
+
+			//Vertex index out of range (The vertex indices follow the header and the padded positions)
+			{
+				std::string damaged = content;
+				damaged[sizeof(MeshCache::Header) + (9 * sizeof(Real) + 7) / 8 * 8] = 3;
+
+				std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+				file.write(damaged.data(), damaged.size());
+			}
+			Assert::IsTrue(MeshCache::Read(fileName, 1, 1) == nullptr);
+
+			//Wrong version
+			{
+				std::string damaged = content;
+				damaged[8] = static_cast<char>(MeshCache::Version + 1);
+
+				std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+				file.write(damaged.data(), damaged.size());
+			}
+			Assert::IsTrue(MeshCache::Read(fileName, 1, 1) == nullptr);
+
+			std::remove(fileName.c_str());
+		}
+
+		TEST_METHOD(LoaderUsesCache) {
+			std::string fileName = "MeshCacheTests_LoaderUsesCache.obj";
+			std::string cacheFileName = MeshCache::GetCacheFileName(fileName);
+			{
+				std::ofstream file(fileName, std::ios::binary);
+				file << "v 0 1 0\nv -1 0 0\nv 1 0 0\nv 0 -1 0\nf 1 2 3 4\n";
+			}
+
+			OBJLoader loader;
+			auto mesh = loader.LoadMesh(fileName);
+			Assert::IsTrue(mesh != nullptr);
+			Assert::IsTrue(!loader.GetStatistics().loadedFromCache);
+			Assert::IsTrue(mesh->HasAccelerationStructure());
+
+			auto cached = loader.LoadMesh(fileName);
+			Assert::IsTrue(cached != nullptr);
+			Assert::IsTrue(loader.GetStatistics().loadedFromCache);
+			Assert::IsTrue(cached->GetTriangleCount() == 2);
+			Assert::IsTrue(cached->GetData().vertexIndices == mesh->GetData().vertexIndices);
+
+			//Changing the source file invalidates the cache
+			{
+				std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+				file << "v 0 1 0\nv -1 0 0\nv 1 0 0\nf 1 2 3\n";
+			}
+
+			auto changed = loader.LoadMesh(fileName);
+			Assert::IsTrue(!loader.GetStatistics().loadedFromCache);
+			Assert::IsTrue(changed->GetTriangleCount() == 1);
+
+			std::remove(fileName.c_str());
+			std::remove(cacheFileName.c_str());
+			Assert::IsTrue(loader.LoadMesh(fileName) == nullptr);
+		}
+	};
+}
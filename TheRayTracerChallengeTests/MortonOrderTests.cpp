@@ -0,0 +1,53 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <MortonOrder.h>
+#include <vector>
+#include <utility>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(MortonOrderTests)
+	{
+	public:
+		TEST_METHOD(EncodeDecode) {
+			//x = 011, y = 101 -> 100111
+			Assert::IsTrue(MortonOrder::Encode(3, 5) == 39);
+			Assert::IsTrue(MortonOrder::Encode(0xFFFF, 0) == 0x55555555);
+			Assert::IsTrue(MortonOrder::Encode(0, 0xFFFF) == 0xAAAAAAAA);
+
+			for (uint32_t x : { 0u, 1u, 7u, 300u, 65535u }) {
+				for (uint32_t y : { 0u, 2u, 9u, 1234u, 65535u }) {
+					uint32_t decodedX, decodedY;
+					MortonOrder::Decode(MortonOrder::Encode(x, y), decodedX, decodedY);
+					Assert::IsTrue(decodedX == x && decodedY == y);
+				}
+			}
+		}
+
+		TEST_METHOD(ForEachCell) {
+			std::vector<std::pair<size_t, size_t>> cells;
+			MortonOrder::ForEachCell(5, 3, [&](size_t x, size_t y) { cells.push_back({ x, y }); });
+
+			//Every cell exactly once
+			Assert::IsTrue(cells.size() == 15);
+			int visits[3][5] = {};
+			for (auto& cell : cells) visits[cell.second][cell.first]++;
+			for (auto& row : visits) {
+				for (int count : row) {
+					Assert::IsTrue(count == 1);
+				}
+			}
+
+			//Z shape inside of each 2 x 2 block, then the next block
+			std::vector<std::pair<size_t, size_t>> start = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { 2, 0 }, { 3, 0 }, { 2, 1 }, { 3, 1 }, { 0, 2 } };
+			Assert::IsTrue(std::vector<std::pair<size_t, size_t>>(cells.begin(), cells.begin() + start.size()) == start);
+
+			size_t count = 0;
+			MortonOrder::ForEachCell(0, 4, [&](size_t, size_t) { count++; });
+			Assert::IsTrue(count == 0);
+		}
+	};
+}
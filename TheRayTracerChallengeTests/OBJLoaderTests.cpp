@@ -0,0 +1,269 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Tuple.h>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <OBJParser.h>
+#include <OBJLoader.h>
+#include <TriangleMesh.h>
+#include <RenderContext.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(OBJLoaderTests)
+	{
+	public:
+		TEST_METHOD(VerticesAndNormals) {
+			std::string text =
+				"v -1 1 0\n"
+				"v -1.0000 0.5000 0.0000\n"
+				"v\t1e0 +0 0 1\n"
+				"vn 0.707 0 -0.707\n";
+
+			OBJLoader loader;
+			loader.Load(text.data(), text.size());
+			const MeshData& data = loader.GetData();
+
+			Assert::IsTrue(loader.GetStatistics().ignoredLines == 0);
+			Assert::IsTrue(data.GetVertexCount() == 3);
+			Assert::IsTrue(data.GetNormalCount() == 1);
+			Assert::IsTrue(data.positions[4] == 0.5);
+			Assert::IsTrue(data.positions[6] == 1.0);
+			Assert::IsTrue(Constants::DoubleEqual(data.normals[2], -0.707));
+		}
+
+		TEST_METHOD(IgnoredLines) {
+			std::string text =
+				"# comment\n"
+				"\n"
+				"vt 0.5 0.5\n"
+				"v 1 2\n"
+				"v 1 2 x\n"
+				"usemtl Material\n"
+				"v 1 2 3";
+
+			OBJLoader loader;
+			loader.Load(text.data(), text.size());
+
+			Assert::IsTrue(loader.GetStatistics().lines == 7);
+			Assert::IsTrue(loader.GetStatistics().ignoredLines == 6);
+			Assert::IsTrue(loader.GetStatistics().bytes == text.size());
+			Assert::IsTrue(loader.GetData().GetVertexCount() == 1);
+		}
+
+		TEST_METHOD(SameTrianglesAsParser) {
+			std::string lines[] = {
+				"v -1 1 0",
+				"v -1 0 0",
+				"v 1 0 0",
+				"v 1 1 0",
+				"v 0 2 0",
+				"vn 0 0 -1",
+				"vn 0 1 0",
+				"f 1 2 3 4 5",
+				"f 1//1 2//2 3//1",
+				"f 1/0/2 3/14/1 4/2/2"
+			};
+
+			OBJParser parser;
+			std::string text;
+			for (auto& line : lines) {
+				std::string copy = line;
+				parser.ParseLine(copy);
+				//Windows line endings
+				text += line + "\r\n";
+			}
+
+			OBJLoader loader;
+			loader.Load(text.data(), text.size());
+			Assert::IsTrue(loader.GetStatistics().ignoredLines == 0);
+
+			auto expected = parser.MakeMesh();
+			auto mesh = loader.MakeMesh();
+
+			Assert::IsTrue(mesh->GetTriangleCount() == 5);
+			Assert::IsTrue(mesh->GetData().vertexIndices == expected->GetData().vertexIndices);
+			Assert::IsTrue(mesh->GetData().normalIndices == expected->GetData().normalIndices);
+			Assert::IsTrue(mesh->GetData().positions == expected->GetData().positions);
+			Assert::IsTrue(mesh->GetData().normals == expected->GetData().normals);
+		}
+
+		TEST_METHOD(Groups) {
+			std::string text =
+				"v -1 1 0\n"
+				"v -1 0 0\n"
+				"v 1 0 0\n"
+				"v 1 1 0\n"
+				"g Empty\n"
+				"g FirstGroup  \n"
+				"f 1 2 3 4\n"
+				"g SecondGroup\n"
+				"f 1 3 4\n";
+
+			OBJLoader loader;
+			loader.Load(text.data(), text.size());
+			auto& groups = loader.GetGroups();
+
+			//Groups without triangles are not kept
+			Assert::IsTrue(groups.size() == 2);
+			Assert::IsTrue(groups[0].name == "FirstGroup");
+			Assert::IsTrue(groups[0].firstTriangle == 0);
+			Assert::IsTrue(groups[0].triangleCount == 2);
+			Assert::IsTrue(groups[1].name == "SecondGroup");
+			Assert::IsTrue(groups[1].firstTriangle == 2);
+			Assert::IsTrue(groups[1].triangleCount == 1);
+		}
+
+		TEST_METHOD(InvalidFaces) {
+			std::string text =
+				"v 0 1 0\n"
+				"v -1 0 0\n"
+				"vn 0 1 0\n"
+				//Vertex 3 is defined after the face
+				"f 1 2 3\n"
+				"v 1 0 0\n"
+				"f 0 1 2\n"
+				"f 1 2\n"
+				"f 1//1 2//1 3//2\n"
+				"f 1 2 3x\n"
+				"f 1 2 3\n"
+				//Only some corners have normal vectors -> flat triangle
+				"f 1//1 2 3\n";
+
+			OBJLoader loader;
+			loader.Load(text.data(), text.size());
+
+			Assert::IsTrue(loader.GetStatistics().ignoredLines == 5);
+			Assert::IsTrue(loader.GetData().GetTriangleCount() == 2);
+			Assert::IsTrue(loader.GetData().normalIndices.empty());
+		}
+
+		TEST_METHOD(LoadFile) {
+			std::string fileName = "OBJLoaderTests_LoadFile.obj";
+			{
+				std::ofstream file(fileName, std::ios::binary);
+				file << "v 0 1 0\nv -1 0 0\nv 1 0 0\nf 1 2 3\n";
+			}
+
+			OBJLoader loader;
+			Assert::IsTrue(loader.LoadFile(fileName));
+			std::remove(fileName.c_str());
+
+			Assert::IsTrue(loader.GetStatistics().lines == 4);
+			auto mesh = loader.MakeMesh();
+			Assert::IsTrue(mesh->GetTriangleCount() == 1);
+			Assert::IsTrue(mesh->GetPoint(0, 1) == Point::CreatePoint(-1.0, 0.0, 0.0));
+
+			//The data was moved into the mesh
+			Assert::IsTrue(loader.GetData().GetTriangleCount() == 0);
+			Assert::IsTrue(!loader.LoadFile("does_not_exist.obj"));
+		}
+
+		TEST_METHOD(NegativeIndices) {
+			std::string text =
+				"v 0 1 0\n"
+				"v -1 0 0\n"
+				"v 1 0 0\n"
+				"vn 0 0 -1\n"
+				"f -3 -2 -1\n"
+				"v 0 -1 0\n"
+				"f -3//-1 -1//-1 -2//1\n"
+				//Only 4 vertices exist
+				"f -5 -2 -1\n";
+
+			OBJLoader loader;
+			loader.Load(text.data(), text.size());
+			const MeshData& data = loader.GetData();
+
+			Assert::IsTrue(loader.GetStatistics().ignoredLines == 1);
+			Assert::IsTrue(data.vertexIndices == std::vector<uint32_t>({ 0, 1, 2, 1, 3, 2 }));
+			Assert::IsTrue(data.normalIndices == std::vector<uint32_t>({ MeshData::NoNormal, MeshData::NoNormal, MeshData::NoNormal, 0, 0, 0 }));
+		}
+
+		TEST_METHOD(ChunksMatchSingleChunk) {
+			//Quads, absolute and relative indices, normals, groups and invalid lines in random order
+			std::string text;
+			RenderContext random;
+			size_t vertexCount = 0, normalCount = 0;
+
+			for (size_t line = 0; line < 2000; line++) {
+				double r = random.NextRandom();
+
+				if (r < 0.3 || vertexCount < 4) {
+					text += "v " + std::to_string(random.NextRandom()) + " " + std::to_string(line) + " 0.5\r\n";
+					vertexCount++;
+				}
+				else if (r < 0.4) {
+					text += "vn 0 " + std::to_string(random.NextRandom()) + " 1\n";
+					normalCount++;
+				}
+				else if (r < 0.6) {
+					text += "f " + std::to_string(vertexCount) + " -2 -3 " + std::to_string(1 + line % vertexCount) + "\n";
+				}
+				else if (r < 0.7 && normalCount > 0) {
+					text += "f -1//-1 -2//" + std::to_string(normalCount) + " -4//1\n";
+				}
+				else if (r < 0.75) {
+					text += "g Group" + std::to_string(line % 7) + "\n";
+				}
+				else if (r < 0.8) {
+					//References vertices that are defined later
+					text += "f 1 2 " + std::to_string(vertexCount + 1) + "\n";
+				}
+				else if (r < 0.85) {
+					text += "f -1 -2 -" + std::to_string(vertexCount + 1) + "\n";
+				}
+				else {
+					text += "# comment\n";
+				}
+			}
+
+			OBJLoader expected(1);
+			expected.Load(text.data(), text.size());
+			Assert::IsTrue(expected.GetStatistics().chunks == 1);
+
+			for (size_t chunkSize : { 1, 17, 100, 1000 }) {
+				OBJLoader loader(4);
+				loader.SetChunkSize(chunkSize);
+				loader.Load(text.data(), text.size());
+
+				Assert::IsTrue(loader.GetStatistics().chunks > 1);
+				Assert::IsTrue(loader.GetStatistics().lines == expected.GetStatistics().lines);
+				Assert::IsTrue(loader.GetStatistics().ignoredLines == expected.GetStatistics().ignoredLines);
+
+				Assert::IsTrue(loader.GetData().positions == expected.GetData().positions);
+				Assert::IsTrue(loader.GetData().normals == expected.GetData().normals);
+				Assert::IsTrue(loader.GetData().vertexIndices == expected.GetData().vertexIndices);
+				Assert::IsTrue(loader.GetData().normalIndices == expected.GetData().normalIndices);
+
+				Assert::IsTrue(loader.GetGroups().size() == expected.GetGroups().size());
+				for (size_t group = 0; group < loader.GetGroups().size(); group++) {
+					Assert::IsTrue(loader.GetGroups()[group].name == expected.GetGroups()[group].name);
+					Assert::IsTrue(loader.GetGroups()[group].firstTriangle == expected.GetGroups()[group].firstTriangle);
+					Assert::IsTrue(loader.GetGroups()[group].triangleCount == expected.GetGroups()[group].triangleCount);
+				}
+			}
+		}
+
+		TEST_METHOD(AppendToLoadedData) {
+			std::string first = "v 0 1 0\nv -1 0 0\nv 1 0 0\nf 1 2 3\n";
+			std::string second = "vn 0 0 1\nv 0 -1 0\nf -3//1 -2//1 -1//1\nf 2 4 3\n";
+
+			OBJLoader loader(2);
+			loader.SetChunkSize(8);
+			loader.Load(first.data(), first.size());
+			loader.Load(second.data(), second.size());
+
+			const MeshData& data = loader.GetData();
+			Assert::IsTrue(data.GetVertexCount() == 4);
+			Assert::IsTrue(data.vertexIndices == std::vector<uint32_t>({ 0, 1, 2, 1, 2, 3, 1, 3, 2 }));
+			//Triangles loaded before the first normal vector get NoNormal
+			Assert::IsTrue(data.normalIndices == std::vector<uint32_t>({ MeshData::NoNormal, MeshData::NoNormal, MeshData::NoNormal, 0, 0, 0, MeshData::NoNormal, MeshData::NoNormal, MeshData::NoNormal }));
+		}
+	};
+}
@@ -153,5 +153,54 @@ namespace TheRayTracesChallengeTests
 			Assert::IsTrue(t2->GetPoint(1) == p.GetVertex(2));
 			Assert::IsTrue(t2->GetPoint(2) == p.GetVertex(3));
 		}
+
+		TEST_METHOD(InvalidFaceIndices) {
+			OBJParser p;
+			p.ParseLine(std::string("v 0 1 0"));
+			p.ParseLine(std::string("v -1 0 0"));
+			p.ParseLine(std::string("v 1 0 0"));
+			p.ParseLine(std::string("vn 0 1 0"));
+
+			//Vertex 4 and normal 2 don't exist
+			p.ParseLine(std::string("f 1 2 4"));
+			p.ParseLine(std::string("f 1//1 2//1 3//2"));
+
+			Assert::IsTrue(p.GetIgnoredLineCount() == 2);
+			Assert::IsTrue(p.GetTriangleCount() == 0);
+		}
+
+		TEST_METHOD(Mesh) {
+			OBJParser p;
+			p.ParseLine(std::string("v -1 1 0"));
+			p.ParseLine(std::string("v -1 0 0"));
+			p.ParseLine(std::string("v 1 0 0"));
+			p.ParseLine(std::string("v 1 1 0"));
+			p.ParseLine(std::string("vn 0 0 -1"));
+
+			p.ParseLine(std::string("g FirstGroup"));
+			p.ParseLine(std::string("f 1 2 3 4"));
+
+			p.ParseLine(std::string("g SecondGroup"));
+			p.ParseLine(std::string("f 1//1 3//1 4//1"));
+
+			auto mesh = p.MakeMesh();
+			const MeshData& data = mesh->GetData();
+
+			//Vertices are shared instead of copied per triangle
+			Assert::IsTrue(mesh->GetTriangleCount() == 3);
+			Assert::IsTrue(data.GetVertexCount() == 4);
+			Assert::IsTrue(data.GetNormalCount() == 1);
+
+			//Same triangles as the parser's groups
+			for (size_t triangle = 0; triangle < 2; triangle++) {
+				for (size_t corner = 0; corner < 3; corner++) {
+					Assert::IsTrue(mesh->GetPoint(triangle, corner) == p.GetTriangle(triangle + 1, "FirstGroup")->GetPoint(corner));
+				}
+			}
+			Assert::IsTrue(mesh->GetPoint(2, 1) == p.GetVertex(3));
+
+			Assert::IsTrue(!mesh->IsSmoothTriangle(0));
+			Assert::IsTrue(mesh->IsSmoothTriangle(2));
+		}
 	};
 }
@@ -90,13 +90,13 @@ namespace TheRayTracesChallengeTests
 			shape->SetMaterial(m);
 
 			Assert::IsTrue(
-				l.Lighting(shape, Point::CreatePoint(0.9, 0.0, 0.0), eye, normal, false)
+				l.Lighting(shape.get(), Point::CreatePoint(0.9, 0.0, 0.0), eye, normal, false)
 				==
 				Color(1.0, 1.0, 1.0)
 			);
 
 			Assert::IsTrue(
-				l.Lighting(shape, Point::CreatePoint(1.1, 0.0, 0.0), eye, normal, false)
+				l.Lighting(shape.get(), Point::CreatePoint(1.1, 0.0, 0.0), eye, normal, false)
 				==
 				Color(0.0, 0.0, 0.0)
 			);
@@ -71,7 +71,7 @@ namespace TheRayTracesChallengeTests
 			p->FindObjectSpaceIntersections(r, xs);
 			Assert::IsTrue(xs.GetCount() == 1);
 			Assert::IsTrue(Constants::DoubleEqual(xs[0].t, 1.0));
-			Assert::IsTrue(xs[0].shape == p);
+			Assert::IsTrue(xs[0].shape == p.get());
 		}
 		TEST_METHOD(PlaneIntersection4) {
 			//Ray hits plane from below
@@ -82,7 +82,7 @@ namespace TheRayTracesChallengeTests
 			p->FindObjectSpaceIntersections(r, xs);
 			Assert::IsTrue(xs.GetCount() == 1);
 			Assert::IsTrue(Constants::DoubleEqual(xs[0].t, 1.0));
-			Assert::IsTrue(xs[0].shape == p);
+			Assert::IsTrue(xs[0].shape == p.get());
 		}
 
 		TEST_METHOD(Bounds) {
@@ -0,0 +1,178 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <Transform.h>
+#include <RenderContext.h>
+#include <BoundingBox.h>
+#include <LinearBVH.h>
+#include <RayPacket.h>
+#include <Sphere.h>
+#include <Plane.h>
+#include <Camera.h>
+#include <World.h>
+#include <memory>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(RayPacketTests)
+	{
+	private:
+		//World with a grid of spheres in front of a plane, so it uses a hierarchy over its shapes
+		static void CreatePacketTestWorld(World& world) {
+			for (int x = -5; x <= 5; x++) {
+				for (int y = -5; y <= 5; y++) {
+					auto sphere = Shape::MakeShared<Sphere>();
+					sphere->SetTransform(Transform::CreateScale(0.3, 0.3, 0.3).Translate(static_cast<double>(x), static_cast<double>(y), 0.0));
+					world.AddShape(sphere);
+				}
+			}
+
+			auto plane = Shape::MakeShared<Plane>();
+			plane->SetTransform(Transform::CreateRotationX(Constants::PI / 2.0).Translate(0.0, 0.0, 2.0));
+			world.AddShape(plane);
+
+			world.AddLightSource(std::make_shared<LightSource>(Point::CreatePoint(-10.0, 10.0, -10.0), Color(1.0, 1.0, 1.0)));
+			world.PrepareFrame();
+		}
+
+	public:
+		TEST_METHOD(CountLanes) {
+			Assert::IsTrue(RayPacket::CountLanes(0) == 0);
+			Assert::IsTrue(RayPacket::CountLanes(RayPacket::AllLanes) == RayPacket::Size);
+			Assert::IsTrue(RayPacket::CountLanes(0x8421) == 4);
+			Assert::IsTrue(RayPacket::IsActive(0x8421, 15) && !RayPacket::IsActive(0x8421, 14));
+		}
+
+		TEST_METHOD(CameraPackets) {
+			Camera camera(10, 7, Constants::PI / 3.0,
+				Camera::CreateViewTransform(Point::CreatePoint(1.0, 2.0, -5.0), Point::CreatePoint(0.0, 0.0, 0.0), Vector::CreateVector(0.0, 1.0, 0.0)));
+
+			RayPacket packet;
+			camera.CreateRayPacket(8, 4, 100, 100, packet);
+
+			//Only the 2 x 3 pixels inside of the image
+			Assert::IsTrue(RayPacket::CountLanes(packet.activeLanes) == 6);
+
+			for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+				size_t x = 8 + lane % RayPacket::Width;
+				size_t y = 4 + lane / RayPacket::Width;
+				Assert::IsTrue(RayPacket::IsActive(packet.activeLanes, lane) == (x < 10 && y < 7));
+
+				if (!RayPacket::IsActive(packet.activeLanes, lane)) continue;
+
+				//Exactly the same rays
+				Ray expected = camera.CreateRayForPixel(x, y);
+				const Ray& actual = packet.rays[lane];
+				Assert::IsTrue(expected.origin.x == actual.origin.x && expected.origin.y == actual.origin.y && expected.origin.z == actual.origin.z);
+				Assert::IsTrue(expected.direction.x == actual.direction.x && expected.direction.y == actual.direction.y && expected.direction.z == actual.direction.z);
+				Assert::IsTrue(packet.origin[1][lane] == actual.origin.y);
+				Assert::IsTrue(packet.inverseDirection[2][lane] == static_cast<Real>(1.0 / actual.direction.z));
+			}
+
+			//The end of a tile
+			camera.CreateRayPacket(0, 0, 3, 1, packet);
+			Assert::IsTrue(packet.activeLanes == 0x7);
+		}
+
+		TEST_METHOD(SameLeavesAsSingleRays) {
+			RenderContext context;
+
+			//Boxes on the faces of a unit grid, so rays can start on faces and run along them
+			std::vector<BoundingBox> bounds;
+			for (int i = 0; i < 300; i++) {
+				Point minimum = Point::CreatePoint(std::floor(context.NextRandom() * 10.0), std::floor(context.NextRandom() * 10.0), std::floor(context.NextRandom() * 10.0));
+				bounds.push_back(BoundingBox(minimum, minimum + Vector::CreateVector(1.0, 1.0, 1.0)));
+			}
+
+			LinearBVH hierarchy;
+			hierarchy.Build(bounds);
+
+			const Real infinity = std::numeric_limits<Real>::infinity();
+			alignas(32) Real tMax[RayPacket::Size];
+			std::fill(tMax, tMax + RayPacket::Size, infinity);
+
+			for (int i = 0; i < 50; i++) {
+				//Coherent and incoherent packets, some rays parallel to an axis
+				bool coherent = (i % 2 == 0);
+				Point origin = Point::CreatePoint(std::floor(context.NextRandom() * 10.0), 5.0, -1.0);
+
+				RayPacket packet;
+				for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+					if (lane % 5 == 4) continue;
+
+					Vector direction = coherent
+						? Vector::CreateVector(0.05 * (lane % RayPacket::Width), 0.05 * (lane / RayPacket::Width), 1.0)
+						: Vector::CreateVector(context.NextRandom() - 0.5, context.NextRandom() - 0.5, context.NextRandom());
+
+					if (lane == 0) direction = Vector::CreateVector(0.0, 0.0, 1.0);
+					packet.SetRay(lane, Ray(origin, direction));
+				}
+
+				std::vector<std::vector<uint32_t>> packetLeaves(RayPacket::Size);
+				hierarchy.TraversePacket(packet, 0.0, tMax, [&](uint32_t nodeIndex, const LinearBVHNode&, RayPacket::LaneMask lanes) {
+					Assert::IsTrue((lanes & ~packet.activeLanes) == 0);
+
+					for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+						if (RayPacket::IsActive(lanes, lane)) packetLeaves[lane].push_back(nodeIndex);
+					}
+				});
+
+				for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+					std::vector<uint32_t> singleLeaves;
+					if (RayPacket::IsActive(packet.activeLanes, lane)) {
+						hierarchy.TraverseLeaves(packet.rays[lane], 0.0, tMax[lane], [&](uint32_t nodeIndex, const LinearBVHNode&) {
+							singleLeaves.push_back(nodeIndex);
+							return false;
+						});
+					}
+
+					//Same leaves (The order may differ)
+					std::sort(singleLeaves.begin(), singleLeaves.end());
+					std::sort(packetLeaves[lane].begin(), packetLeaves[lane].end());
+					Assert::IsTrue(singleLeaves == packetLeaves[lane]);
+				}
+			}
+		}
+
+		TEST_METHOD(SameColorsAsSingleRays) {
+			World world;
+			CreatePacketTestWorld(world);
+			Assert::IsTrue(world.HasAccelerationStructure());
+
+			Camera camera(23, 17, Constants::PI / 2.0,
+				Camera::CreateViewTransform(Point::CreatePoint(0.5, 0.5, -6.0), Point::CreatePoint(0.0, 0.0, 0.0), Vector::CreateVector(0.0, 1.0, 0.0)));
+
+			RenderContext context;
+			RayPacket packet;
+			Color colors[RayPacket::Size];
+
+			camera.CreateRayPacket(8, 8, 23, 17, packet);
+			world.FindRayColors(packet, colors, context);
+			Assert::IsTrue(context.GetStatistics().raysCast >= RayPacket::Size);
+
+			for (size_t lane = 0; lane < RayPacket::Size; lane++) {
+				Assert::IsTrue(colors[lane] == world.FindRayColor(packet.rays[lane], context));
+			}
+
+			//Whole frames, with tiles that don't line up with the packets
+			camera.SetTileSize(6);
+			Canvas packetImage = camera.RenderFrameMultithreaded(world, 2);
+			camera.SetUsePacketTracing(false);
+			Canvas singleImage = camera.RenderFrameMultithreaded(world, 2);
+
+			for (size_t y = 0; y < camera.GetYSize(); y++) {
+				for (size_t x = 0; x < camera.GetXSize(); x++) {
+					Assert::IsTrue(packetImage.ReadPixel(x, y) == singleImage.ReadPixel(x, y));
+				}
+			}
+		}
+	};
+}
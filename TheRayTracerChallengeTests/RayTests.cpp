@@ -58,16 +58,16 @@ namespace TheRayTracesChallengeTests
             Intersection i;
             auto s = Shape::MakeShared<Sphere>();
 
-            i.shape = s;
+            i.shape = s.get();
             i.t = 3.5f;
 
             Assert::IsTrue(Constants::DoubleEqual(i.t, 3.5f));
-            Assert::IsTrue(i.shape == s);
+            Assert::IsTrue(i.shape == s.get());
 
-			i = Intersection(3.5, s, 0.2, 0.4);
+			i = Intersection(3.5, s.get(), 0.2, 0.4);
 
 			Assert::IsTrue(Constants::DoubleEqual(i.t, 3.5));
-			Assert::IsTrue(i.shape == s);
+			Assert::IsTrue(i.shape == s.get());
 			Assert::IsTrue(Constants::DoubleEqual(i.u, 0.2));
 			Assert::IsTrue(Constants::DoubleEqual(i.v, 0.4));
         }
@@ -97,8 +97,8 @@ namespace TheRayTracesChallengeTests
 			s->FindIntersections(ray, xs);
 
             Assert::IsTrue(xs.GetCount() == 2);
-            Assert::IsTrue(xs[0].shape == s);
-            Assert::IsTrue(xs[1].shape == s);
+            Assert::IsTrue(xs[0].shape == s.get());
+            Assert::IsTrue(xs[1].shape == s.get());
         }
 
         TEST_METHOD(Hit1) {
@@ -153,6 +153,55 @@ namespace TheRayTracesChallengeTests
             Assert::IsTrue(i.GetFirstHit() == i4);
         }
 
+        TEST_METHOD(BufferSpillsOver) {
+            auto s = Shape::MakeShared<Sphere>();
+            IntersectionBuffer i;
+
+            //Descending t values, so the buffer has to be sorted
+            size_t count = IntersectionBuffer::InlineCapacity * 3;
+            for (size_t index = 0; index < count; index++) {
+                i.Add(Intersection(static_cast<double>(count - index) - 5.0, s));
+                Assert::IsTrue(i.IsInline() == (index < IntersectionBuffer::InlineCapacity));
+            }
+
+            Assert::IsTrue(i.GetCount() == count);
+            Assert::IsTrue(i.GetFirstHit().t == 0.0);
+
+            i.Sort();
+            for (size_t index = 0; index < count; index++) {
+                Assert::IsTrue(i[index].t == static_cast<double>(index) - 4.0);
+            }
+
+            //Moving keeps the spilled intersections
+            IntersectionBuffer moved(std::move(i));
+            Assert::IsTrue(moved.GetCount() == count);
+            Assert::IsTrue(!moved.IsInline());
+            Assert::IsTrue(i.GetCount() == 0 && i.IsInline());
+
+            moved.Reset();
+            Assert::IsTrue(moved.GetCount() == 0 && moved.IsInline());
+        }
+
+        TEST_METHOD(SortUpTo) {
+            auto s = Shape::MakeShared<Sphere>();
+            IntersectionBuffer i;
+
+            for (double t : { 5.0, 1.0, 7.0, -3.0, 2.0, 9.0, 3.0 }) {
+                i.Add(Intersection(t, s));
+            }
+
+            //Only the intersections up to t = 3 are sorted
+            Assert::IsTrue(i.SortUpTo(3.0) == 4);
+            Assert::IsTrue(i[0].t == -3.0);
+            Assert::IsTrue(i[1].t == 1.0);
+            Assert::IsTrue(i[2].t == 2.0);
+            Assert::IsTrue(i[3].t == 3.0);
+
+            i.Sort();
+            Assert::IsTrue(i.SortUpTo(6.0) == 5);
+            Assert::IsTrue(i[6].t == 9.0);
+        }
+
         TEST_METHOD(RayTranslation) {
             Ray r(
                 Point::CreatePoint(1.0f, 2.0f, 3.0f),
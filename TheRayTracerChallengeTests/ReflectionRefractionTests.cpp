@@ -155,7 +155,7 @@ namespace TheRayTracesChallengeTests
 			);
 
 			IntersectionBuffer intersections(Intersection(sqrt(2.0), plane));
-			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, w.shapes);
+			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, w.GetShapes());
 
 			Color c = w.FindReflectedColor(hit);
 
@@ -183,7 +183,7 @@ namespace TheRayTracesChallengeTests
 			);
 
 			IntersectionBuffer intersections(Intersection(sqrt(2.0), plane));
-			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, w.shapes);
+			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, w.GetShapes());
 
 			Color shadedColor = w.ShadeHit(hit);
 			Assert::IsTrue(shadedColor == Color(0.87676, 0.92435, 0.82917));
@@ -237,7 +237,7 @@ namespace TheRayTracesChallengeTests
 			);
 
 			IntersectionBuffer intersections(Intersection(sqrt(2.0), plane));
-			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, w.shapes);
+			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, w.GetShapes());
 
 			Color reflectedColor = w.FindReflectedColor(hit, 0);
 			//Recursion should stop and return black
@@ -248,7 +248,7 @@ namespace TheRayTracesChallengeTests
 			World w;
 			w.LoadDefaultWorld();
 
-			auto shape = w.shapes[0];
+			auto shape = w.GetShapes()[0];
 
 			Ray ray(
 				Point::CreatePoint(0.0, 0.0, -5.0),
@@ -257,7 +257,7 @@ namespace TheRayTracesChallengeTests
 
 			IntersectionBuffer xs(Intersection(4.0, shape), Intersection(6.0, shape));
 
-			HitCalculations hit(xs[0], xs, ray, w.shapes);
+			HitCalculations hit(xs[0], xs, ray, w.GetShapes());
 
 			Color c = w.FindRefractedColor(hit);
 
@@ -269,7 +269,7 @@ namespace TheRayTracesChallengeTests
 			World w;
 			w.LoadDefaultWorld();
 
-			auto shape = w.shapes[0];
+			auto shape = w.GetShapes()[0];
 			shape->SetMaterial(Material::CreateGlass());
 
 			Ray ray(
@@ -279,7 +279,7 @@ namespace TheRayTracesChallengeTests
 
 			IntersectionBuffer xs(Intersection(4.0, shape), Intersection(6.0, shape));
 
-			HitCalculations hit(xs[0], xs, ray, w.shapes);
+			HitCalculations hit(xs[0], xs, ray, w.GetShapes());
 
 			Color c = w.FindRefractedColor(hit, 0);
 
@@ -291,7 +291,7 @@ namespace TheRayTracesChallengeTests
 			World w;
 			w.LoadDefaultWorld();
 
-			auto shape = w.shapes[0];
+			auto shape = w.GetShapes()[0];
 			shape->SetMaterial(Material::CreateGlass());
 
 			Ray ray(
@@ -301,7 +301,7 @@ namespace TheRayTracesChallengeTests
 
 			IntersectionBuffer xs(Intersection(-sqrt(2.0) / 2.0, shape), Intersection(sqrt(2.0) / 2.0, shape));
 
-			HitCalculations hit(xs[1], xs, ray, w.shapes);
+			HitCalculations hit(xs[1], xs, ray, w.GetShapes());
 
 			Color c = w.FindRefractedColor(hit, 5);
 
@@ -323,13 +323,13 @@ namespace TheRayTracesChallengeTests
 
 			World w;
 			w.LoadDefaultWorld();
-			auto A = w.shapes[0];
+			auto A = w.GetShapes()[0];
 			Material mA;
 			mA.ambient = 1.0;
 			mA.pattern = std::make_shared<TestPattern>();
 			A->SetMaterial(mA);
 
-			auto B = w.shapes[1];
+			auto B = w.GetShapes()[1];
 			B->SetMaterial(Material::CreateGlass());
 
 			Ray ray(
@@ -343,7 +343,7 @@ namespace TheRayTracesChallengeTests
 			xs.Add(Intersection(0.4899, B));
 			xs.Add(Intersection(0.9899, A));
 
-			HitCalculations hit(xs[2], xs, ray, w.shapes);
+			HitCalculations hit(xs[2], xs, ray, w.GetShapes());
 
 			Color c = w.FindRefractedColor(hit);
 
@@ -379,7 +379,7 @@ namespace TheRayTracesChallengeTests
 			);
 
 			IntersectionBuffer xs(Intersection(sqrt(2), floor));
-			HitCalculations hit(xs[0], xs, ray, w.shapes);
+			HitCalculations hit(xs[0], xs, ray, w.GetShapes());
 
 			Color c = w.ShadeHit(hit, 5);
 			Assert::IsTrue(
@@ -0,0 +1,100 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <IntersectionBuffer.h>
+#include <RenderContext.h>
+#include <memory>
+#include <Shape.h>
+#include <Sphere.h>
+#include <Plane.h>
+#include <World.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(RenderContextTests)
+	{
+	public:
+		TEST_METHOD(AcquireBuffers) {
+			RenderContext context;
+
+			IntersectionBuffer& b1 = context.AcquireBuffer();
+			b1.Add(Intersection(1.0, nullptr));
+			IntersectionBuffer& b2 = context.AcquireBuffer();
+
+			//Nested buffers are different
+			Assert::IsTrue(&b1 != &b2);
+			Assert::IsTrue(b2.GetCount() == 0);
+
+			context.ReleaseBuffer();
+			context.ReleaseBuffer();
+
+			//Released buffers are reused and empty
+			IntersectionBuffer& b3 = context.AcquireBuffer();
+			Assert::IsTrue(&b1 == &b3);
+			Assert::IsTrue(b3.GetCount() == 0);
+			context.ReleaseBuffer();
+		}
+
+		TEST_METHOD(RandomNumbers) {
+			RenderContext c1(5), c2(5), c3(6);
+
+			for (size_t i = 0; i < 1000; i++) {
+				double r1 = c1.NextRandom();
+				double r2 = c2.NextRandom();
+				double r3 = c3.NextRandom();
+
+				Assert::IsTrue(r1 >= 0.0 && r1 < 1.0);
+				//Same seed -> same sequence
+				Assert::IsTrue(r1 == r2);
+				Assert::IsTrue(r1 != r3);
+			}
+		}
+
+		TEST_METHOD(Statistics) {
+			World world;
+			world.LoadDefaultWorld();
+			RenderContext context;
+
+			Ray ray(Point::CreatePoint(0.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			world.FindRayColor(ray, context);
+
+			//Camera ray + one shadow ray
+			Assert::IsTrue(context.GetStatistics().raysCast == 2);
+			Assert::IsTrue(context.GetStatistics().shadowRaysCast == 1);
+
+			world.AddStatistics(context.GetStatistics());
+			Assert::IsTrue(world.numberOfRaysCast == 2);
+		}
+
+		TEST_METHOD(MissDoesNotAffectNextRay) {
+			World world;
+			world.AddLightSource(std::make_shared<LightSource>(Point::CreatePoint(-10.0, 10.0, -10.0), Color(1.0, 1.0, 1.0)));
+
+			auto floor = Shape::MakeShared<Plane>();
+			Material floorMaterial;
+			floorMaterial.refractiveIndex = 2.0;
+			floor->SetMaterial(floorMaterial);
+			world.AddShape(floor);
+
+			auto glass = Shape::MakeShared<Sphere>();
+			glass->SetMaterial(Material::CreateGlass());
+			glass->SetTransform(Transform::CreateTranslation(0.0, 3.0, 0.0));
+			world.AddShape(glass);
+
+			Ray miss(Point::CreatePoint(10.0, 1.0, 0.0), Vector::CreateVector(0.0, 1.0, 0.0));
+			Ray hit(Point::CreatePoint(0.0, 3.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+
+			RenderContext context;
+			//Only intersects the floor behind its origin
+			Assert::IsTrue(world.FindRayColor(miss, context) == Color(0.0, 0.0, 0.0));
+
+			//The floor intersection of the previous ray is not used for the refractive indices
+			Assert::IsTrue(world.FindRayColor(hit, context) == world.FindRayColor(hit));
+		}
+	};
+}
@@ -0,0 +1,130 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Camera.h>
+#include <World.h>
+#include <RenderProgress.h>
+#include <CancellationToken.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(RenderProgressTests)
+	{
+	public:
+		TEST_METHOD(Counters) {
+			RenderProgress progress(4);
+			Assert::IsTrue(progress.GetTotalTiles() == 4 && progress.GetCompletedTiles() == 0);
+
+			progress.AddTile(100);
+			progress.AddTile(50);
+			Assert::IsTrue(progress.GetCompletedTiles() == 2);
+			Assert::IsTrue(progress.GetRaysCast() == 150);
+
+			RenderProgressReport report;
+			report.completedTiles = 1;
+			report.totalTiles = 4;
+			Assert::IsTrue(report.GetFraction() == 0.25);
+		}
+
+		TEST_METHOD(Reporter) {
+			RenderProgress progress(5);
+			std::vector<RenderProgressReport> reports;
+
+			ProgressReporter reporter(progress, [&](const RenderProgressReport& report) { reports.push_back(report); }, std::chrono::milliseconds(1));
+
+			for (int tile = 0; tile < 5; tile++) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+				progress.AddTile(10);
+			}
+
+			//The reports are only read after the reporter's thread is done
+			reporter.Stop();
+
+			Assert::IsTrue(reports.size() >= 2);
+			for (size_t index = 0; index < reports.size(); index++) {
+				Assert::IsTrue(reports[index].finished == (index + 1 == reports.size()));
+				Assert::IsTrue(reports[index].totalTiles == 5);
+				if (index > 0) Assert::IsTrue(reports[index].completedTiles >= reports[index - 1].completedTiles);
+			}
+
+			const RenderProgressReport& last = reports.back();
+			Assert::IsTrue(last.completedTiles == 5);
+			Assert::IsTrue(last.remainingSeconds == 0.0);
+			Assert::IsTrue(last.elapsedSeconds >= 0.025);
+			Assert::IsTrue(last.raysPerSecond > 0.0);
+
+			//Stopping again doesn't report again
+			size_t reportCount = reports.size();
+			reporter.Stop();
+			Assert::IsTrue(reports.size() == reportCount);
+		}
+
+		TEST_METHOD(CameraProgress) {
+			World w;
+			w.LoadDefaultWorld();
+
+			Camera c(40, 30, Constants::PI / 2.0f);
+			c.SetTileSize(8);
+
+			//Longer than the render, so only the final report arrives
+			std::vector<RenderProgressReport> reports;
+			c.SetProgressCallback([&](const RenderProgressReport& report) { reports.push_back(report); }, std::chrono::seconds(60));
+
+			c.RenderFrameMultithreaded(w, 2);
+			Assert::IsTrue(reports.size() == 1 && reports[0].finished);
+			Assert::IsTrue(reports[0].totalTiles == 5 * 4 && reports[0].completedTiles == reports[0].totalTiles);
+			Assert::IsTrue(reports[0].raysPerSecond > 0.0);
+
+			//Without Z-order, RenderFrame reports its column strips
+			c.SetUseMortonOrder(false);
+			c.RenderFrame(w);
+			Assert::IsTrue(reports.size() == 2 && reports[1].totalTiles == 40 / RayPacket::Width && reports[1].completedTiles == reports[1].totalTiles);
+
+			c.SetProgressCallback(nullptr);
+			c.RenderFrame(w);
+			Assert::IsTrue(reports.size() == 2);
+		}
+
+		TEST_METHOD(CameraCancellation) {
+			World w;
+			w.LoadDefaultWorld();
+
+			Camera c(40, 30, Constants::PI / 2.0f);
+			std::vector<RenderProgressReport> reports;
+			c.SetProgressCallback([&](const RenderProgressReport& report) { reports.push_back(report); }, std::chrono::seconds(60));
+
+			//No tile is started with a cancelled token, the final report is still delivered
+			CancellationToken token;
+			token.Cancel();
+
+			Canvas serialImage = c.RenderFrame(w, &token);
+			Canvas parallelImage = c.RenderFrameMultithreaded(w, 2, &token);
+			Assert::IsTrue(w.numberOfRaysCast == 0);
+
+			Assert::IsTrue(reports.size() == 2);
+			for (auto& report : reports) {
+				Assert::IsTrue(report.finished && report.completedTiles == 0 && report.totalTiles > 0);
+			}
+
+			for (size_t y = 0; y < c.GetYSize(); y++) {
+				for (size_t x = 0; x < c.GetXSize(); x++) {
+					Assert::IsTrue(serialImage.ReadPixel(x, y) == Color(0.0, 0.0, 0.0));
+					Assert::IsTrue(parallelImage.ReadPixel(x, y) == Color(0.0, 0.0, 0.0));
+				}
+			}
+
+			//Reset tokens don't stop anything
+			token.Reset();
+			c.RenderFrameMultithreaded(w, 2, &token);
+			Assert::IsTrue(reports.back().completedTiles == reports.back().totalTiles);
+			Assert::IsTrue(w.numberOfRaysCast > 0);
+		}
+	};
+}
@@ -7,6 +7,7 @@
 #include <IntersectionBuffer.h>
 #include <Transform.h>
 #include <memory>
+#include <limits>
 #include <Shape.h>
 #include <Sphere.h>
 #include <ShapeGroup.h>
@@ -64,7 +65,7 @@ namespace TheRayTracesChallengeTests
 			group->AddShape(testshape);
 
 			Assert::IsTrue(group->GetShapeCount() == 1);
-			Assert::IsTrue(group->ContainsShape(testshape));
+			Assert::IsTrue(group->ContainsShape(testshape.get()));
 			Assert::IsTrue(testshape->GetParent() == group);
 		}
 
@@ -105,10 +106,10 @@ namespace TheRayTracesChallengeTests
 
 			xs.Sort();
 
-			Assert::IsTrue(xs[0].shape == s2);
-			Assert::IsTrue(xs[1].shape == s2);
-			Assert::IsTrue(xs[2].shape == s1);
-			Assert::IsTrue(xs[3].shape == s1);
+			Assert::IsTrue(xs[0].shape == s2.get());
+			Assert::IsTrue(xs[1].shape == s2.get());
+			Assert::IsTrue(xs[2].shape == s1.get());
+			Assert::IsTrue(xs[3].shape == s1.get());
 		}
 
 		TEST_METHOD(TransformedGroupIntersections) {
@@ -130,5 +131,59 @@ namespace TheRayTracesChallengeTests
 			Assert::IsTrue(xs.GetCount() == 2);
 		}
 
+		TEST_METHOD(AnyHit) {
+			auto group = Shape::MakeShared<ShapeGroup>();
+
+			for (int i = 0; i < 10; i++) {
+				auto sphere = Shape::MakeShared<Sphere>();
+				sphere->SetTransform(Transform::CreateTranslation(0.0, 0.0, static_cast<double>(i) * 3.0));
+				group->AddShape(sphere);
+			}
+			group->SetTransform(Transform::CreateScale(0.5, 0.5, 0.5));
+
+			Ray ray(Point::CreatePoint(0.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			RenderContext context;
+
+			//First hit at t = 4.5, same results with and without a compiled hierarchy
+			for (int compiled = 0; compiled < 2; compiled++) {
+				if (compiled) group->BuildAccelerationStructure();
+
+				Assert::IsTrue(!group->FindAnyHit(ray, 4.5, context));
+				Assert::IsTrue(group->FindAnyHit(ray, 4.6, context));
+				Assert::IsTrue(!group->FindAnyHit(Ray(Point::CreatePoint(2.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0)), 100.0, context));
+			}
+		}
+
+		TEST_METHOD(ClosestHit) {
+			auto group = Shape::MakeShared<ShapeGroup>();
+			std::shared_ptr<Shape> nearest;
+
+			for (int i = 9; i >= 0; i--) {
+				auto sphere = Shape::MakeShared<Sphere>();
+				sphere->SetTransform(Transform::CreateTranslation(0.0, 0.0, static_cast<double>(i) * 3.0));
+				group->AddShape(sphere);
+				nearest = sphere;
+			}
+			group->SetTransform(Transform::CreateScale(0.5, 0.5, 0.5));
+
+			RenderContext context;
+			Ray ray(Point::CreatePoint(0.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+
+			for (int compiled = 0; compiled < 2; compiled++) {
+				if (compiled) group->BuildAccelerationStructure();
+
+				Intersection closestHit(std::numeric_limits<Real>::infinity(), nullptr);
+				Assert::IsTrue(group->FindClosestHit(ray, closestHit, context));
+				Assert::IsTrue(Constants::DoubleEqual(closestHit.t, 4.5));
+				Assert::IsTrue(closestHit.shape == nearest.get());
+
+				//Hits behind the ray's origin are ignored
+				Ray inside(Point::CreatePoint(0.0, 0.0, 0.0), Vector::CreateVector(0.0, 0.0, 1.0));
+				closestHit = Intersection(std::numeric_limits<Real>::infinity(), nullptr);
+				Assert::IsTrue(group->FindClosestHit(inside, closestHit, context));
+				Assert::IsTrue(Constants::DoubleEqual(closestHit.t, 0.5));
+			}
+		}
+
 	};
 }
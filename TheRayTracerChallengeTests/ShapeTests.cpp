@@ -187,5 +187,58 @@ namespace TheRayTracesChallengeTests
 			Vector v = s->SurfaceNormal(Point::CreatePoint(1.7321, 1.1547, -5.5774), i);
 			Assert::IsTrue(v == Vector::CreateVector(0.285703, 0.428543, -0.857160));
 		}
+
+		TEST_METHOD(CachedWorldTransform) {
+			auto g1 = Shape::MakeShared<ShapeGroup>();
+			auto g2 = Shape::MakeShared<ShapeGroup>();
+			auto s = Shape::MakeShared<Sphere>();
+
+			g1->SetTransform(Transform::CreateRotationY(Constants::PI / 2.0));
+			g2->SetTransform(Transform::CreateScale(1.0, 2.0, 3.0));
+			s->SetTransform(Transform::CreateTranslation(5.0, 0.0, 0.0));
+
+			g1->AddShape(g2);
+			g2->AddShape(s);
+
+			Point worldPoint = Point::CreatePoint(1.7321, 1.1547, -5.5774);
+			Vector normal = Vector::CreateVector(sqrt(3.0) / 3.0, sqrt(3.0) / 3.0, sqrt(3.0) / 3.0);
+
+			Point expectedPoint = s->PointToObjectSpace(worldPoint);
+			Vector expectedNormal = s->NormalToWorldSpace(normal);
+
+			//Updating the root updates every contained shape
+			Assert::IsTrue(!s->HasWorldTransform());
+			g1->UpdateWorldTransform();
+			Assert::IsTrue(s->HasWorldTransform());
+
+			Assert::IsTrue(s->PointToObjectSpace(worldPoint) == expectedPoint);
+			Assert::IsTrue(s->NormalToWorldSpace(normal) == expectedNormal);
+
+			//Changing a parent's transform invalidates the cache of every shape below it
+			g2->SetTransform(Transform::CreateScale(2.0, 2.0, 2.0));
+			Assert::IsTrue(!s->HasWorldTransform());
+			Assert::IsTrue(g1->HasWorldTransform());
+
+			g1->UpdateWorldTransform();
+			Point p = s->PointToObjectSpace(Point::CreatePoint(-2.0, 0.0, -10.0));
+			Assert::IsTrue(p == Point::CreatePoint(0.0, 0.0, -1.0));
+		}
+
+		TEST_METHOD(AnyHit) {
+			auto s = Shape::MakeShared<Sphere>();
+			s->SetTransform(Transform::CreateScale(2.0, 2.0, 2.0));
+			RenderContext context;
+
+			Ray ray(Point::CreatePoint(0.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+
+			//Hits at t = 3 and t = 7 (maximumT is not changed by the transform)
+			Assert::IsTrue(!s->FindAnyHit(ray, 3.0, context));
+			Assert::IsTrue(s->FindAnyHit(ray, 3.5, context));
+
+			//Hits behind the origin don't count
+			Ray inside(Point::CreatePoint(0.0, 0.0, 0.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			Assert::IsTrue(!s->FindAnyHit(inside, 1.5, context));
+			Assert::IsTrue(s->FindAnyHit(inside, 2.5, context));
+		}
 	};
 }
@@ -0,0 +1,255 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <IntersectionBuffer.h>
+#include <RenderContext.h>
+#include <Triangle.h>
+#include <TriangleMesh.h>
+#include <TriangleBlocks.h>
+#include <memory>
+#include <limits>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	//Bumpy grid of size x size quads
+	static MeshData CreateBlockTestGrid(int size) {
+		MeshData data;
+
+		for (int y = 0; y <= size; y++) {
+			for (int x = 0; x <= size; x++) {
+				data.positions.push_back(x);
+				data.positions.push_back(y);
+				data.positions.push_back(0.1 * ((x * 7 + y * 3) % 5));
+			}
+		}
+
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				uint32_t i = y * (size + 1) + x;
+				data.vertexIndices.insert(data.vertexIndices.end(), { i, i + 1, i + size + 1 });
+				data.vertexIndices.insert(data.vertexIndices.end(), { i + 1, i + size + 2, i + size + 1 });
+			}
+		}
+
+		return data;
+	}
+
+	TEST_CLASS(TriangleBlocksTests)
+	{
+	public:
+
+		TEST_METHOD(Layout) {
+			static_assert(alignof(TriangleBlock) >= 32, "TriangleBlock needs to be 32 byte aligned");
+
+			MeshData data = CreateBlockTestGrid(10);
+			std::vector<BoundingBox> triangleBounds;
+			for (size_t triangle = 0; triangle < data.GetTriangleCount(); triangle++) {
+				BoundingBox box;
+				for (size_t corner = 0; corner < 3; corner++) {
+					uint32_t vertex = data.vertexIndices[3 * triangle + corner];
+					box.Add(Point3(data.positions[3 * vertex], data.positions[3 * vertex + 1], data.positions[3 * vertex + 2]));
+				}
+				triangleBounds.push_back(box);
+			}
+
+			//Leaves with more triangles than fit into one block
+			BVHBuildSettings settings;
+			settings.maximumLeafSize = 6;
+			LinearBVH hierarchy;
+			hierarchy.Build(triangleBounds, settings);
+
+			TriangleBlocks blocks;
+			blocks.Build(data.positions, data.vertexIndices, hierarchy);
+
+			std::vector<int> timesStored(data.GetTriangleCount(), 0);
+			size_t blockCount = 0;
+			const auto& nodes = hierarchy.GetNodes();
+
+			for (uint32_t nodeIndex = 0; nodeIndex < nodes.size(); nodeIndex++) {
+				if (!nodes[nodeIndex].IsLeaf()) continue;
+
+				uint32_t firstBlock = blocks.GetFirstBlock(nodeIndex);
+				Assert::IsTrue(firstBlock == blockCount);
+				blockCount += TriangleBlocks::GetBlockCount(nodes[nodeIndex]);
+
+				//Same order as the leaf, unused lanes at the end
+				for (uint32_t index = 0; index < TriangleBlocks::GetBlockCount(nodes[nodeIndex]) * TriangleBlocks::Width; index++) {
+					uint32_t triangle = blocks.GetTriangle(firstBlock + index / TriangleBlocks::Width, index % TriangleBlocks::Width);
+
+					if (index < nodes[nodeIndex].primitiveCount) {
+						Assert::IsTrue(triangle == hierarchy.GetPrimitiveOrder()[nodes[nodeIndex].offset + index]);
+						timesStored[triangle]++;
+					}
+					else {
+						Assert::IsTrue(triangle == TriangleBlocks::NoTriangle);
+					}
+				}
+			}
+
+			Assert::IsTrue(blocks.GetBlockCount() == blockCount);
+			for (int count : timesStored) {
+				Assert::IsTrue(count == 1);
+			}
+
+			blocks.Clear();
+			Assert::IsTrue(blocks.IsEmpty());
+		}
+
+		TEST_METHOD(MatchesTriangle) {
+			Point p0 = Point::CreatePoint(0.0, 1.0, 0.0);
+			Point p1 = Point::CreatePoint(-1.0, 0.0, 0.0);
+			Point p2 = Point::CreatePoint(1.0, 0.0, 0.0);
+			auto triangle = Shape::MakeShared<Triangle>(p0, p1, p2);
+			triangle->SetIntersectionMode(TriangleIntersectionMode::MollerTrumbore);
+
+			//The same triangle in every lane but the last one
+			Point3 corner0(p0), corner1(p1), corner2(p2);
+			TriangleBlock block = {};
+			for (size_t lane = 0; lane + 1 < TriangleBlock::Width; lane++) {
+				for (size_t axis = 0; axis < 3; axis++) {
+					block.p0[axis][lane] = corner0[axis];
+					block.p1[axis][lane] = corner1[axis];
+					block.p2[axis][lane] = corner2[axis];
+				}
+			}
+			const int usedLanes = (1 << (TriangleBlock::Width - 1)) - 1;
+
+			RenderContext context;
+			const Real infinity = std::numeric_limits<Real>::infinity();
+
+			for (int i = 0; i < 100; i++) {
+				Ray ray(
+					Point::CreatePoint(context.NextRandom() * 2.0 - 1.0, context.NextRandom() * 2.0 - 0.5, -2.0),
+					Vector::CreateVector(context.NextRandom() * 0.2 - 0.1, context.NextRandom() * 0.2 - 0.1, 1.0)
+				);
+
+				IntersectionBuffer buffer;
+				triangle->FindObjectSpaceIntersections(ray, buffer);
+
+				//All implementations of the kernel find the same hits (The values only match up to rounding, the compiler may contract some of them into FMA)
+				TriangleBlockHits scalarHits, hits;
+				int scalarLanes = 0, lanes = 0;
+				for (size_t first = 0; first < TriangleBlock::Width; first++) {
+					scalarLanes |= TriangleBlockLanes::Intersect<SIMDLanes::Scalar>(block, first, Point3(ray.origin), Vec3(ray.direction), -infinity, infinity, scalarHits);
+				}
+				for (size_t first = 0; first < TriangleBlock::Width; first += SIMDLanes::Default::Count) {
+					lanes |= TriangleBlockLanes::Intersect<SIMDLanes::Default>(block, first, Point3(ray.origin), Vec3(ray.direction), -infinity, infinity, hits);
+				}
+
+				//The watertight kernel matches WatertightRay exactly
+				WatertightRay watertightRay(ray);
+				Real t, u, v;
+				bool watertightHit = watertightRay.Intersect(corner0, corner1, corner2, t, u, v);
+				TriangleBlockHits watertightHits;
+				int watertightLanes = 0;
+				for (size_t first = 0; first < TriangleBlock::Width; first += SIMDLanes::Default::Count) {
+					watertightLanes |= TriangleBlockLanes::IntersectWatertight<SIMDLanes::Default>(block, first, watertightRay, -infinity, infinity, watertightHits);
+				}
+
+				Assert::IsTrue(watertightLanes == (watertightHit ? usedLanes : 0));
+				if (watertightHit) {
+					for (size_t lane = 0; lane + 1 < TriangleBlock::Width; lane++) {
+						Assert::IsTrue(watertightHits.t[lane] == t && watertightHits.u[lane] == u && watertightHits.v[lane] == v);
+					}
+				}
+
+				Assert::IsTrue(scalarLanes == lanes);
+				Assert::IsTrue(lanes == (buffer.GetCount() == 1 ? usedLanes : 0));
+
+				if (lanes != 0) {
+					const Intersection& expected = buffer[0];
+					for (size_t lane = 0; lane + 1 < TriangleBlock::Width; lane++) {
+						Assert::IsTrue(Constants::DoubleEqual(hits.t[lane], expected.t) && Constants::DoubleEqual(hits.u[lane], expected.u) && Constants::DoubleEqual(hits.v[lane], expected.v));
+						Assert::IsTrue(Constants::DoubleEqual(scalarHits.t[lane], hits.t[lane]) && Constants::DoubleEqual(scalarHits.u[lane], hits.u[lane]) && Constants::DoubleEqual(scalarHits.v[lane], hits.v[lane]));
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(RangeOfT) {
+			TriangleBlock block = {};
+			block.p1[0][0] = 1.0;
+			block.p2[1][0] = 1.0;
+
+			Ray ray(Point::CreatePoint(0.25, 0.25, -2.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			WatertightRay watertightRay(ray);
+			TriangleBlockHits hits;
+
+			for (bool watertight : { false, true }) {
+				auto intersect = [&](Real tMin, Real tMax) {
+					int lanes = 0;
+					for (size_t first = 0; first < TriangleBlock::Width; first += SIMDLanes::Default::Count) {
+						lanes |= watertight
+							? TriangleBlockLanes::IntersectWatertight<SIMDLanes::Default>(block, first, watertightRay, tMin, tMax, hits)
+							: TriangleBlockLanes::Intersect<SIMDLanes::Default>(block, first, Point3(ray.origin), Vec3(ray.direction), tMin, tMax, hits);
+					}
+					return lanes;
+				};
+
+				Assert::IsTrue(intersect(0.0, 3.0) == 1);
+				Assert::IsTrue(hits.t[0] == 2.0);
+				Assert::IsTrue(hits.u[0] == 0.25 && hits.v[0] == 0.25);
+				//tMin is inclusive, tMax exclusive
+				Assert::IsTrue(intersect(2.0, 3.0) == 1);
+				Assert::IsTrue(intersect(0.0, 2.0) == 0);
+			}
+		}
+
+		TEST_METHOD(MeshMatchesSingleTriangles) {
+			MeshData data = CreateBlockTestGrid(20);
+
+			auto blockMesh = Shape::MakeShared<TriangleMesh>(data);
+			auto singleMesh = Shape::MakeShared<TriangleMesh>(data);
+			singleMesh->SetUseTriangleBlocks(false);
+			blockMesh->BuildAccelerationStructure();
+			singleMesh->BuildAccelerationStructure();
+
+			RenderContext context;
+
+			for (int i = 0; i < 400; i++) {
+				//Both intersection modes
+				auto mode = (i % 2 == 0) ? TriangleIntersectionMode::MollerTrumbore : TriangleIntersectionMode::Watertight;
+				blockMesh->SetIntersectionMode(mode);
+				singleMesh->SetIntersectionMode(mode);
+
+				Ray ray(
+					Point::CreatePoint(context.NextRandom() * 20.0, context.NextRandom() * 20.0, -5.0),
+					Vector::CreateVector(context.NextRandom() - 0.5, context.NextRandom() - 0.5, 1.0)
+				);
+
+				IntersectionBuffer expected, actual;
+				singleMesh->FindIntersections(ray, expected);
+				blockMesh->FindIntersections(ray, actual);
+				Assert::IsTrue(expected.GetCount() == actual.GetCount());
+
+				Intersection expectedHit(std::numeric_limits<Real>::infinity(), nullptr);
+				Intersection actualHit(std::numeric_limits<Real>::infinity(), nullptr);
+				bool found = singleMesh->FindClosestHit(ray, expectedHit, context);
+				Assert::IsTrue(found == blockMesh->FindClosestHit(ray, actualHit, context));
+
+				if (found) {
+					//The watertight test is identical, including the barycentric coordinates used for smooth normals
+					//Möller-Trumbore only matches up to rounding
+					if (mode == TriangleIntersectionMode::Watertight) {
+						Assert::IsTrue(expectedHit.t == actualHit.t);
+						Assert::IsTrue(expectedHit.u == actualHit.u && expectedHit.v == actualHit.v);
+					}
+					else {
+						Assert::IsTrue(Constants::DoubleEqual(expectedHit.t, actualHit.t));
+						Assert::IsTrue(Constants::DoubleEqual(expectedHit.u, actualHit.u) && Constants::DoubleEqual(expectedHit.v, actualHit.v));
+					}
+					Assert::IsTrue(expectedHit.primitiveIndex == actualHit.primitiveIndex);
+
+					Assert::IsTrue(!blockMesh->FindAnyHit(ray, actualHit.t, context));
+					Assert::IsTrue(blockMesh->FindAnyHit(ray, actualHit.t + 0.01, context));
+				}
+			}
+		}
+	};
+}
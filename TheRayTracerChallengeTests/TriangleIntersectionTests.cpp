@@ -0,0 +1,116 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <Vector3.h>
+#include <IntersectionBuffer.h>
+#include <RenderContext.h>
+#include <Triangle.h>
+#include <TriangleMesh.h>
+#include <TriangleIntersection.h>
+#include <memory>
+#include <limits>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(TriangleIntersectionTests)
+	{
+	public:
+
+		TEST_METHOD(ShearConstants) {
+			WatertightRay ray(Ray(Point::CreatePoint(1.0, 2.0, 3.0), Vector::CreateVector(0.5, -4.0, 1.0)));
+
+			//y is the largest component and negative, so x and z are swapped
+			Assert::IsTrue(ray.kz == 1);
+			Assert::IsTrue(ray.kx == 0 && ray.ky == 2);
+			Assert::IsTrue(Constants::DoubleEqual(ray.shearX, -0.125));
+			Assert::IsTrue(Constants::DoubleEqual(ray.shearY, -0.25));
+			Assert::IsTrue(Constants::DoubleEqual(ray.shearZ, -0.25));
+			Assert::IsTrue(ray.origin == Point3(1.0, 2.0, 3.0));
+		}
+
+		TEST_METHOD(MatchesMollerTrumbore) {
+			Point p0 = Point::CreatePoint(0.0, 1.0, 0.0);
+			Point p1 = Point::CreatePoint(-1.0, 0.0, 0.0);
+			Point p2 = Point::CreatePoint(1.0, 0.0, 0.0);
+
+			auto watertight = Shape::MakeShared<Triangle>(p0, p1, p2);
+			auto mollerTrumbore = Shape::MakeShared<Triangle>(p0, p1, p2);
+			mollerTrumbore->SetIntersectionMode(TriangleIntersectionMode::MollerTrumbore);
+			Assert::IsTrue(watertight->GetIntersectionMode() == TriangleIntersectionMode::Watertight);
+
+			RenderContext context;
+
+			for (int i = 0; i < 200; i++) {
+				Ray ray(
+					Point::CreatePoint(context.NextRandom() * 3.0 - 1.5, context.NextRandom() * 2.0 - 0.5, context.NextRandom() * 4.0 - 2.0),
+					Vector::CreateVector(context.NextRandom() - 0.5, context.NextRandom() - 0.5, context.NextRandom() * 2.0 - 1.0)
+				);
+
+				IntersectionBuffer expected, actual;
+				mollerTrumbore->FindObjectSpaceIntersections(ray, expected);
+				watertight->FindObjectSpaceIntersections(ray, actual);
+
+				//Rays that hit close to an edge may be decided differently
+				if (expected.GetCount() != actual.GetCount()) {
+					const Intersection& hit = expected.GetCount() > 0 ? expected[0] : actual[0];
+					Real w = 1.0 - hit.u - hit.v;
+					Assert::IsTrue(std::fabs(hit.u) < 0.001 || std::fabs(hit.v) < 0.001 || std::fabs(w) < 0.001);
+					continue;
+				}
+
+				if (actual.GetCount() > 0) {
+					Assert::IsTrue(Constants::DoubleEqual(expected[0].t, actual[0].t));
+					Assert::IsTrue(Constants::DoubleEqual(expected[0].u, actual[0].u));
+					Assert::IsTrue(Constants::DoubleEqual(expected[0].v, actual[0].v));
+				}
+			}
+		}
+
+		TEST_METHOD(SharedEdges) {
+			//Fan of triangles around the origin with long, thin triangles, which are the hardest case for Möller-Trumbore
+			const uint32_t triangleCount = 97;
+			auto mesh = Shape::MakeShared<TriangleMesh>();
+			mesh->AddVertex(Point::CreatePoint(0.0, 0.0, 0.0));
+
+			for (uint32_t i = 0; i < triangleCount; i++) {
+				Real angle = 2.0 * Constants::PI * i / triangleCount;
+				mesh->AddVertex(Point::CreatePoint(1000.0 * std::cos(angle), 1000.0 * std::sin(angle), 0.0));
+			}
+			for (uint32_t i = 0; i < triangleCount; i++) {
+				mesh->AddTriangle(0, i + 1, (i + 1) % triangleCount + 1);
+			}
+			mesh->BuildAccelerationStructure();
+
+			RenderContext context;
+
+			//Rays through points on the shared edges (and the shared vertex) always hit
+			for (int i = 0; i < 2000; i++) {
+				uint32_t edge = static_cast<uint32_t>(context.NextRandom() * triangleCount) % triangleCount;
+				Real angle = 2.0 * Constants::PI * edge / triangleCount;
+				Real distance = (i % 100 == 0) ? 0.0 : context.NextRandom() * 900.0;
+
+				Point target = Point::CreatePoint(distance * std::cos(angle), distance * std::sin(angle), 0.0);
+				Point origin = Point::CreatePoint(context.NextRandom() * 10.0 - 5.0, context.NextRandom() * 10.0 - 5.0, -10.0);
+				Ray ray(origin, target - origin);
+
+				Intersection hit(std::numeric_limits<Real>::infinity(), nullptr);
+				Assert::IsTrue(mesh->FindClosestHit(ray, hit, context));
+				Assert::IsTrue(mesh->FindAnyHit(ray, std::numeric_limits<Real>::infinity(), context));
+			}
+		}
+
+		TEST_METHOD(ParallelRay) {
+			WatertightRay ray(Ray(Point::CreatePoint(0.0, 1.0, -2.0), Vector::CreateVector(0.0, 1.0, 0.0)));
+			Real t, u, v;
+
+			Assert::IsTrue(!ray.Intersect(Point3(0.0, 1.0, 0.0), Point3(-1.0, 0.0, 0.0), Point3(1.0, 0.0, 0.0), t, u, v));
+			//Degenerate triangle
+			Assert::IsTrue(!ray.Intersect(Point3(0.0, 0.0, 0.0), Point3(0.0, 0.0, 0.0), Point3(0.0, 0.0, 0.0), t, u, v));
+		}
+	};
+}
@@ -0,0 +1,222 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Constants.h>
+#include <Tuple.h>
+#include <Ray.h>
+#include <IntersectionBuffer.h>
+#include <RenderContext.h>
+#include <Transform.h>
+#include <memory>
+#include <limits>
+#include <type_traits>
+#include <Shape.h>
+#include <Triangle.h>
+#include <TriangleMesh.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	TEST_CLASS(TriangleMeshTests)
+	{
+	public:
+
+		TEST_METHOD(IsShape) {
+			Assert::IsTrue(std::is_base_of<Shape, TriangleMesh>());
+		}
+
+		TEST_METHOD(Creation) {
+			auto mesh = Shape::MakeShared<TriangleMesh>();
+			uint32_t v0 = mesh->AddVertex(Point::CreatePoint(0.0, 1.0, 0.0));
+			uint32_t v1 = mesh->AddVertex(Point::CreatePoint(-1.0, 0.0, 0.0));
+			uint32_t v2 = mesh->AddVertex(Point::CreatePoint(1.0, 0.0, 0.0));
+			uint32_t v3 = mesh->AddVertex(Point::CreatePoint(0.0, -1.0, 0.0));
+
+			mesh->AddTriangle(v0, v1, v2);
+			mesh->AddTriangle(v1, v3, v2);
+
+			Assert::IsTrue(mesh->GetTriangleCount() == 2);
+			Assert::IsTrue(mesh->GetData().GetVertexCount() == 4);
+			//Flat meshes don't store normal indices
+			Assert::IsTrue(mesh->GetData().normalIndices.empty());
+
+			Assert::IsTrue(mesh->GetPoint(1, 0) == Point::CreatePoint(-1.0, 0.0, 0.0));
+			Assert::IsTrue(mesh->GetPoint(1, 1) == Point::CreatePoint(0.0, -1.0, 0.0));
+
+			auto bounds = mesh->GetObjectSpaceBounds();
+			Assert::IsTrue(bounds.GetMin() == Point::CreatePoint(-1.0, -1.0, 0.0));
+			Assert::IsTrue(bounds.GetMax() == Point::CreatePoint(1.0, 1.0, 0.0));
+		}
+
+		TEST_METHOD(MatchesTriangle) {
+			auto p0 = Point::CreatePoint(0.0, 1.0, 0.0);
+			auto p1 = Point::CreatePoint(-1.0, 0.0, 0.0);
+			auto p2 = Point::CreatePoint(1.0, 0.0, 0.0);
+
+			auto triangle = Shape::MakeShared<Triangle>(p0, p1, p2);
+			auto mesh = Shape::MakeShared<TriangleMesh>();
+			mesh->AddVertex(p0);
+			mesh->AddVertex(p1);
+			mesh->AddVertex(p2);
+			mesh->AddTriangle(0, 1, 2);
+
+			Ray rays[] = {
+				Ray(Point::CreatePoint(0.0, 0.5, -2.0), Vector::CreateVector(0.0, 0.0, 1.0)),
+				Ray(Point::CreatePoint(0.2, 0.3, -2.0), Vector::CreateVector(0.1, 0.0, 1.0)),
+				//Misses
+				Ray(Point::CreatePoint(1.0, 1.0, -2.0), Vector::CreateVector(0.0, 0.0, 1.0)),
+				Ray(Point::CreatePoint(0.0, -1.0, -2.0), Vector::CreateVector(0.0, 1.0, 0.0))
+			};
+
+			for (auto& ray : rays) {
+				IntersectionBuffer triangleHits, meshHits;
+				triangle->FindIntersections(ray, triangleHits);
+				mesh->FindIntersections(ray, meshHits);
+
+				Assert::IsTrue(triangleHits.GetCount() == meshHits.GetCount());
+
+				for (size_t i = 0; i < meshHits.GetCount(); i++) {
+					Assert::IsTrue(meshHits[i].shape == mesh.get());
+					Assert::IsTrue(meshHits[i].primitiveIndex == 0);
+					Assert::IsTrue(Constants::DoubleEqual(meshHits[i].t, triangleHits[i].t));
+					Assert::IsTrue(Constants::DoubleEqual(meshHits[i].u, triangleHits[i].u));
+					Assert::IsTrue(Constants::DoubleEqual(meshHits[i].v, triangleHits[i].v));
+
+					Point p = ray.PositionAt(meshHits[i].t);
+					Assert::IsTrue(mesh->SurfaceNormal(p, meshHits[i]) == triangle->SurfaceNormal(p, triangleHits[i]));
+				}
+			}
+		}
+
+		TEST_METHOD(SmoothNormals) {
+			auto mesh = Shape::MakeShared<TriangleMesh>();
+			uint32_t v0 = mesh->AddVertex(Point::CreatePoint(0.0, 1.0, 0.0));
+			uint32_t v1 = mesh->AddVertex(Point::CreatePoint(-1.0, 0.0, 0.0));
+			uint32_t v2 = mesh->AddVertex(Point::CreatePoint(1.0, 0.0, 0.0));
+			uint32_t v3 = mesh->AddVertex(Point::CreatePoint(0.0, -1.0, 0.0));
+			uint32_t n0 = mesh->AddNormal(Vector::CreateVector(0.0, 1.0, 0.0));
+			uint32_t n1 = mesh->AddNormal(Vector::CreateVector(-1.0, 0.0, 0.0));
+			uint32_t n2 = mesh->AddNormal(Vector::CreateVector(1.0, 0.0, 0.0));
+
+			//Flat triangle followed by a smooth one
+			mesh->AddTriangle(v1, v3, v2);
+			mesh->AddTriangle(v0, v1, v2, n0, n1, n2);
+
+			Assert::IsTrue(!mesh->IsSmoothTriangle(0));
+			Assert::IsTrue(mesh->IsSmoothTriangle(1));
+			Assert::IsTrue(mesh->GetData().normalIndices.size() == 6);
+
+			//Same as the smooth triangle test
+			Intersection i(1.0, mesh.get(), 0.45, 0.25, 1);
+			Assert::IsTrue(mesh->SurfaceNormal(Point::CreatePoint(0.0, 0.0, 0.0), i) == Vector::CreateVector(-0.5547, 0.83205, 0.0));
+
+			//Flat triangle uses its face normal
+			Intersection flat(1.0, mesh.get(), 0.45, 0.25, 0);
+			Assert::IsTrue(mesh->SurfaceNormal(Point::CreatePoint(0.0, 0.0, 0.0), flat) == Vector::CreateVector(0.0, 0.0, -1.0));
+
+			//Smooth first triangle
+			MeshData data;
+			data.AddTriangle(0, 1, 2, 0, 1, 2);
+			data.AddTriangle(1, 3, 2);
+			Assert::IsTrue(data.normalIndices == std::vector<uint32_t>({ 0, 1, 2, MeshData::NoNormal, MeshData::NoNormal, MeshData::NoNormal }));
+		}
+
+		TEST_METHOD(HierarchyMatchesBruteForce) {
+			//Grid of 20 x 20 quads
+			const int size = 20;
+			MeshData data;
+
+			for (int y = 0; y <= size; y++) {
+				for (int x = 0; x <= size; x++) {
+					data.positions.push_back(x);
+					data.positions.push_back(y);
+					//Slightly bumpy, so the triangles aren't coplanar
+					data.positions.push_back(0.1 * ((x * 7 + y * 3) % 5));
+				}
+			}
+
+			for (int y = 0; y < size; y++) {
+				for (int x = 0; x < size; x++) {
+					uint32_t i = y * (size + 1) + x;
+					data.vertexIndices.insert(data.vertexIndices.end(), { i, i + 1, i + size + 1 });
+					data.vertexIndices.insert(data.vertexIndices.end(), { i + 1, i + size + 2, i + size + 1 });
+				}
+			}
+
+			auto bruteForce = Shape::MakeShared<TriangleMesh>(data);
+			auto mesh = Shape::MakeShared<TriangleMesh>(data);
+			mesh->BuildAccelerationStructure();
+
+			Assert::IsTrue(mesh->HasAccelerationStructure());
+			Assert::IsTrue(!bruteForce->HasAccelerationStructure());
+			Assert::IsTrue(mesh->GetTriangleCount() == 2 * size * size);
+
+			RenderContext context;
+
+			for (int i = 0; i < 200; i++) {
+				Point origin = Point::CreatePoint(context.NextRandom() * size, context.NextRandom() * size, -5.0);
+				Vector direction = Vector::CreateVector(context.NextRandom() - 0.5, context.NextRandom() - 0.5, 1.0);
+				Ray ray(origin, direction);
+
+				IntersectionBuffer expected, actual;
+				bruteForce->FindIntersections(ray, expected);
+				mesh->FindIntersections(ray, actual);
+				Assert::IsTrue(expected.GetCount() == actual.GetCount());
+
+				Intersection expectedHit(std::numeric_limits<Real>::infinity(), nullptr);
+				Intersection actualHit(std::numeric_limits<Real>::infinity(), nullptr);
+				bool expectedFound = bruteForce->FindClosestHit(ray, expectedHit, context);
+				bool actualFound = mesh->FindClosestHit(ray, actualHit, context);
+
+				Assert::IsTrue(expectedFound == actualFound);
+				Assert::IsTrue(expectedFound == expected.GetFirstHit().IsValid());
+
+				if (actualFound) {
+					Assert::IsTrue(actualHit.shape == mesh.get());
+					Assert::IsTrue(Constants::DoubleEqual(expectedHit.t, actualHit.t));
+					Assert::IsTrue(expectedHit.primitiveIndex == actualHit.primitiveIndex);
+					Assert::IsTrue(Constants::DoubleEqual(expected.GetFirstHit().t, actualHit.t));
+
+					//Any hit in front of the closest hit doesn't exist
+					Assert::IsTrue(!mesh->FindAnyHit(ray, actualHit.t, context));
+					Assert::IsTrue(mesh->FindAnyHit(ray, actualHit.t + 0.01, context));
+				}
+			}
+		}
+
+		TEST_METHOD(AddingTrianglesInvalidatesHierarchy) {
+			auto mesh = Shape::MakeShared<TriangleMesh>();
+			mesh->AddVertex(Point::CreatePoint(0.0, 1.0, 0.0));
+			mesh->AddVertex(Point::CreatePoint(-1.0, 0.0, 0.0));
+			mesh->AddVertex(Point::CreatePoint(1.0, 0.0, 0.0));
+			mesh->AddTriangle(0, 1, 2);
+			mesh->BuildAccelerationStructure();
+			Assert::IsTrue(mesh->HasAccelerationStructure());
+
+			mesh->AddTriangle(0, 1, 2);
+			Assert::IsTrue(!mesh->HasAccelerationStructure());
+		}
+
+		TEST_METHOD(Copy) {
+			auto mesh = Shape::MakeShared<TriangleMesh>();
+			mesh->AddVertex(Point::CreatePoint(0.0, 1.0, 0.0));
+			mesh->AddVertex(Point::CreatePoint(-1.0, 0.0, 0.0));
+			mesh->AddVertex(Point::CreatePoint(1.0, 0.0, 0.0));
+			mesh->AddTriangle(0, 1, 2);
+			mesh->SetTransform(Transform::CreateTranslation(0.0, 0.0, 1.0));
+			mesh->BuildAccelerationStructure();
+
+			auto copy = mesh->Copy();
+			Ray ray(Point::CreatePoint(0.0, 0.5, -2.0), Vector::CreateVector(0.0, 0.0, 1.0));
+
+			IntersectionBuffer buffer;
+			copy->FindIntersections(ray, buffer);
+
+			Assert::IsTrue(buffer.GetCount() == 1);
+			//Intersections reference the copy
+			Assert::IsTrue(buffer[0].shape == copy.get());
+			Assert::IsTrue(Constants::DoubleEqual(buffer[0].t, 3.0));
+		}
+	};
+}
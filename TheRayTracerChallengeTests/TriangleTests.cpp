@@ -64,7 +64,7 @@ namespace TheRayTracesChallengeTests
 				Point::CreatePoint(1.0, 0.0, 0.0)
 			);
 
-			std::vector <std::pair<Ray, IntersectionBuffer>> tests = {
+			std::pair<Ray, IntersectionBuffer> tests[] = {
 				//Ray parallel to triangle
 				{Ray(Point::CreatePoint(0.0, 1.0, -2.0), Vector::CreateVector(0.0, 1.0, 0.0)), IntersectionBuffer()},
 				//Ray misses p0-p2 edge
@@ -79,7 +79,7 @@ namespace TheRayTracesChallengeTests
 
 			for (auto& test : tests) {
 				auto ray = test.first;
-				auto expected = test.second;
+				auto& expected = test.second;
 				IntersectionBuffer result;
 
 				triangle->FindObjectSpaceIntersections(ray, result);
@@ -145,7 +145,7 @@ namespace TheRayTracesChallengeTests
 			auto n2 = Vector::CreateVector(1.0, 0.0, 0.0);
 
 			auto triangle = Shape::MakeShared<Triangle>(p0, p1, p2, n0, n1, n2);
-			Intersection i(1.0, triangle, 0.45, 0.25);
+			Intersection i(1.0, triangle.get(), 0.45, 0.25);
 
 			auto normal = triangle->SurfaceNormal(Point::CreatePoint(0.0, 0.0, 0.0), i);
 
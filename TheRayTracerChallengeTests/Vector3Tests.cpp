@@ -0,0 +1,76 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include <Vector3.h>
+#include <Tuple.h>
+#include <Constants.h>
+#include <type_traits>
+#include <utility>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace RayTracer;
+
+namespace TheRayTracesChallengeTests
+{
+	//True if a + b compiles
+	template<typename A, typename B, typename = void>
+	struct CanAdd : std::false_type {};
+
+	template<typename A, typename B>
+	struct CanAdd<A, B, decltype(void(std::declval<A>() + std::declval<B>()))> : std::true_type {};
+
+	TEST_CLASS(Vector3Tests)
+	{
+	public:
+		TEST_METHOD(Layout) {
+			static_assert(sizeof(Point3) == 3 * sizeof(Real), "Point3 should only store x, y and z");
+			static_assert(sizeof(Vec3) == 3 * sizeof(Real), "Vec3 should only store x, y and z");
+
+			//Points can't be added to points, but vectors can be added to both
+			static_assert(!CanAdd<Point3, Point3>::value, "Point3 + Point3 should not compile");
+			static_assert(CanAdd<Point3, Vec3>::value, "Point3 + Vec3 should compile");
+			static_assert(CanAdd<Vec3, Vec3>::value, "Vec3 + Vec3 should compile");
+			static_assert(!CanAdd<Vec3, Point3>::value, "Vec3 + Point3 should not compile");
+		}
+
+		TEST_METHOD(PointOperations) {
+			Point3 p1(3.0, 2.0, 1.0);
+			Point3 p2(5.0, 6.0, 7.0);
+
+			Assert::IsTrue(p1 - p2 == Vec3(-2.0, -4.0, -6.0));
+			Assert::IsTrue(p1 + Vec3(1.0, 1.0, 1.0) == Point3(4.0, 3.0, 2.0));
+			Assert::IsTrue(p1 - Vec3(1.0, 1.0, 1.0) == Point3(2.0, 1.0, 0.0));
+
+			Assert::IsTrue(Point3::Min(p1, Point3(4.0, 1.0, 1.0)) == Point3(3.0, 1.0, 1.0));
+			Assert::IsTrue(Point3::Max(p1, Point3(4.0, 1.0, 1.0)) == Point3(4.0, 2.0, 1.0));
+			Assert::IsTrue(p2[0] == 5.0 && p2[1] == 6.0 && p2[2] == 7.0);
+		}
+
+		TEST_METHOD(VectorOperations) {
+			Vec3 v1(1.0, 2.0, 3.0);
+			Vec3 v2(2.0, 3.0, 4.0);
+
+			Assert::IsTrue(Constants::DoubleEqual(Vec3::DotProduct(v1, v2), 20.0));
+			Assert::IsTrue(Vec3::CrossProduct(v1, v2) == Vec3(-1.0, 2.0, -1.0));
+			Assert::IsTrue(Vec3::CrossProduct(v2, v1) == Vec3(1.0, -2.0, 1.0));
+
+			Assert::IsTrue(Constants::DoubleEqual(Vec3(1.0, 2.0, 3.0).Magnitude(), std::sqrt(14.0)));
+			Assert::IsTrue(Vec3(4.0, 0.0, 0.0).Normalize() == Vec3(1.0, 0.0, 0.0));
+
+			Assert::IsTrue(-v1 == Vec3(-1.0, -2.0, -3.0));
+			Assert::IsTrue(v1 * 2.0 == Vec3(2.0, 4.0, 6.0));
+			Assert::IsTrue(v1 / 2.0 == Vec3(0.5, 1.0, 1.5));
+		}
+
+		TEST_METHOD(TupleAdapters) {
+			//Same results as the tuple operations
+			Tuple a = Tuple::CreateVector(1.0, -2.0, 3.0);
+			Tuple b = Tuple::CreateVector(0.5, 4.0, -1.0);
+
+			Assert::IsTrue(Vec3::CrossProduct(Vec3(a), Vec3(b)).ToTuple() == Tuple::CrossProduct(a, b));
+			Assert::IsTrue(Constants::DoubleEqual(Vec3::DotProduct(Vec3(a), Vec3(b)), Tuple::DotProduct(a, b)));
+
+			Assert::IsTrue(Point3(Tuple::CreatePoint(1.0, 2.0, 3.0)).ToTuple() == Tuple::CreatePoint(1.0, 2.0, 3.0));
+			Assert::IsTrue(Vec3(a).ToTuple().IsVector());
+		}
+	};
+}
@@ -7,6 +7,7 @@
 #include <Intersection.h>
 #include <Transform.h>
 #include <memory>
+#include <limits>
 #include <Shape.h>
 #include <Sphere.h>
 #include <Plane.h>
@@ -25,7 +26,7 @@ namespace TheRayTracesChallengeTests
 			World world;
 
 			Assert::IsTrue(world.lightSources.size() == 0);
-			Assert::IsTrue(world.shapes.size() == 0);
+			Assert::IsTrue(world.GetShapes().size() == 0);
 		}
 		TEST_METHOD(DefaultWorld) {
 			World world;
@@ -37,15 +38,15 @@ namespace TheRayTracesChallengeTests
 			auto s1 = Shape::MakeShared<Sphere>();
 
 			Material m2;
-			m2.pattern = world.shapes[1]->GetMaterial().pattern;
+			m2.pattern = world.GetShapes()[1]->GetMaterial().pattern;
 			auto s2 = Shape::MakeShared<Sphere>();
 			s2->SetTransform(Transform::CreateScale(0.5f, 0.5f, 0.5f));
 
-			Assert::IsTrue(world.shapes.size() == 2);
+			Assert::IsTrue(world.GetShapes().size() == 2);
 			Assert::IsTrue(world.lightSources.size() == 1);
 
-			Assert::IsTrue(world.shapes[0]->SameTransform(s1));
-			Assert::IsTrue(world.shapes[1]->SameTransform(s2));
+			Assert::IsTrue(world.GetShapes()[0]->SameTransform(s1));
+			Assert::IsTrue(world.GetShapes()[1]->SameTransform(s2));
 			Assert::IsTrue(*world.lightSources[0] == l);
 		}
 		TEST_METHOD(Intersections) {
@@ -69,10 +70,10 @@ namespace TheRayTracesChallengeTests
 			world.LoadDefaultWorld();
 
 			Ray ray(Point::CreatePoint(0.0f, 0.0f, -5.0f), Vector::CreateVector(0.0f, 0.0f, 1.0f));
-			auto shape = world.shapes[0];
+			auto shape = world.GetShapes()[0];
 
 			IntersectionBuffer intersections(Intersection(4.0f, shape));
-			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, world.shapes);
+			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, world.GetShapes());
 
 			Assert::IsTrue(world.ShadeHit(hit) == Color(0.38066f, 0.47583f, 0.2855f));
 		}
@@ -87,10 +88,10 @@ namespace TheRayTracesChallengeTests
 
 			Ray ray(Point::CreatePoint(0.0f, 0.0f, 0.0f), Vector::CreateVector(0.0f, 0.0f, 1.0f));
 			
-			auto shape = world.shapes[1];
+			auto shape = world.GetShapes()[1];
 
 			IntersectionBuffer intersections(Intersection(0.5f, shape));
-			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, world.shapes);
+			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, world.GetShapes());
 
 			Assert::IsTrue(world.ShadeHit(hit) == Color(0.90498f, 0.90498f, 0.90498f));
 		}
@@ -120,8 +121,8 @@ namespace TheRayTracesChallengeTests
 			World world;
 			world.LoadDefaultWorld();
 
-			auto outer = world.shapes[0];
-			auto inner = world.shapes[1];
+			auto outer = world.GetShapes()[0];
+			auto inner = world.GetShapes()[1];
 
 			Material m;
 
@@ -206,17 +207,17 @@ namespace TheRayTracesChallengeTests
 
 			w.AddShape(Shape::MakeShared<Sphere>());
 			w.AddShape(Shape::MakeShared<Sphere>());
-			w.shapes[1]->SetTransform(Transform::CreateTranslation(0.0f, 0.0f, 10.0f));
+			w.GetShapes()[1]->SetTransform(Transform::CreateTranslation(0.0f, 0.0f, 10.0f));
 			
 			Ray ray(
 				Point::CreatePoint(0.0f, 0.0f, 5.0f),
 				Vector::CreateVector(0.0f, 0.0f, 1.0f)
 			);
 
-			Intersection intersection(4.0f, w.shapes[1]);
+			Intersection intersection(4.0f, w.GetShapes()[1]);
 			IntersectionBuffer intersections(intersection);
 
-			HitCalculations comps(intersections.GetFirstHit(), intersections, ray, w.shapes);
+			HitCalculations comps(intersections.GetFirstHit(), intersections, ray, w.GetShapes());
 
 			//Sphere in shadow is correctly shaded
 			Assert::IsTrue(
@@ -233,14 +234,14 @@ namespace TheRayTracesChallengeTests
 				Vector::CreateVector(0.0, 0.0, 1.0));
 
 
-			auto shape = w.shapes[1];
+			auto shape = w.GetShapes()[1];
 			auto material = shape->GetMaterial();
 			material.ambient = 1.0;
 			shape->SetMaterial(material);
 
 			IntersectionBuffer intersections(Intersection(1.0, shape));
 
-			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, w.shapes);
+			HitCalculations hit(intersections.GetFirstHit(), intersections, ray, w.GetShapes());
 
 			Assert::IsTrue(
 				w.FindReflectedColor(hit)
@@ -248,5 +249,81 @@ namespace TheRayTracesChallengeTests
 				Color(0.0, 0.0, 0.0)
 			);
 		}
+
+		TEST_METHOD(AccelerationStructure) {
+			World w;
+			w.LoadDefaultWorld();
+
+			for (int i = 0; i < 100; i++) {
+				auto sphere = Shape::MakeShared<Sphere>();
+				sphere->SetTransform(Transform::CreateScale(0.3, 0.3, 0.3).Translate(static_cast<double>(i % 10) - 4.5, static_cast<double>(i / 10) - 4.5, 5.0));
+				w.AddShape(sphere);
+			}
+			auto floor = Shape::MakeShared<Plane>();
+			floor->SetTransform(Transform::CreateTranslation(0.0, -6.0, 0.0));
+			w.AddShape(floor);
+
+			Assert::IsTrue(!w.HasAccelerationStructure());
+			w.PrepareFrame();
+			Assert::IsTrue(w.HasAccelerationStructure());
+			Assert::IsTrue(w.GetAccelerationStructure().GetPrimitiveCount() == 102);
+			Assert::IsTrue(w.GetAccelerationStructure().GetUnboundedPrimitiveCount() == 1);
+
+			//Same intersections as the linear search over all shapes
+			for (int i = 0; i < 30; i++) {
+				Ray ray(Point::CreatePoint(0.0, 0.0, -5.0), Vector::CreateVector(static_cast<double>(i % 6) * 0.1 - 0.25, static_cast<double>(i / 6) * 0.1 - 0.25, 1.0).Normalize());
+
+				IntersectionBuffer compiled, linear;
+				w.IntersectRay(ray, compiled);
+				for (auto& shape : w.GetShapes()) {
+					shape->FindIntersections(ray, linear);
+				}
+
+				Assert::IsTrue(compiled.GetCount() == linear.GetCount());
+				compiled.Sort();
+				linear.Sort();
+				for (size_t index = 0; index < compiled.GetCount(); index++) {
+					Assert::IsTrue(compiled[index].shape == linear[index].shape);
+				}
+			}
+
+			//Changes to the shape list and to transforms are detected
+			w.RemoveShape(w.GetShapes().back());
+			Assert::IsTrue(!w.HasAccelerationStructure());
+			w.PrepareFrame();
+			Assert::IsTrue(w.GetAccelerationStructure().GetUnboundedPrimitiveCount() == 0);
+
+			w.GetShapes()[0]->SetTransform(Transform::CreateTranslation(0.0, 50.0, 0.0));
+			Ray ray(Point::CreatePoint(0.0, 50.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+
+			//The outdated hierarchy isn't used before the next frame either
+			Assert::IsTrue(!w.HasAccelerationStructure());
+			IntersectionBuffer beforeFrame;
+			w.IntersectRay(ray, beforeFrame);
+			Assert::IsTrue(beforeFrame.GetCount() == 2);
+
+			w.PrepareFrame();
+			Assert::IsTrue(w.HasAccelerationStructure());
+			IntersectionBuffer xs;
+			w.IntersectRay(ray, xs);
+			Assert::IsTrue(xs.GetCount() == 2);
+		}
+
+		TEST_METHOD(ClosestHit) {
+			World w;
+			w.LoadDefaultWorld();
+			Ray ray(Point::CreatePoint(0.0, 0.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			RenderContext context;
+
+			Intersection closestHit(std::numeric_limits<Real>::infinity(), nullptr);
+			Assert::IsTrue(w.FindClosestHit(ray, closestHit, context));
+			Assert::IsTrue(Constants::DoubleEqual(closestHit.t, 4.0));
+			Assert::IsTrue(closestHit.shape == w.GetShapes()[0].get());
+
+			Ray miss(Point::CreatePoint(0.0, 5.0, -5.0), Vector::CreateVector(0.0, 0.0, 1.0));
+			closestHit = Intersection(std::numeric_limits<Real>::infinity(), nullptr);
+			Assert::IsTrue(!w.FindClosestHit(miss, closestHit, context));
+			Assert::IsTrue(context.GetStatistics().raysCast == 2);
+		}
     };
 }